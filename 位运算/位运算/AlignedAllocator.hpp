@@ -0,0 +1,73 @@
+//
+//  AlignedAllocator.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef AlignedAllocator_hpp
+#define AlignedAllocator_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+/// AlignedAllocator - A stateless std::allocator replacement that returns
+/// Alignment-byte aligned memory. It is the default storage allocator of the
+/// bit vectors, so that their words start on a cache line and the SIMD
+/// kernels never split a load across two lines at the start of a vector.
+///
+/// Memory comes from malloc with Alignment bytes of slack, the block start
+/// stored just before the aligned pointer: the aligned operator new goes
+/// through memalign, which can be twice as slow for the small blocks of
+/// short-lived vectors.
+///
+/// All instances are equal, so containers using it move in O(1) without
+/// allocating, even on move assignment.
+template <typename T, std::size_t Alignment = 64> class AlignedAllocator {
+  static_assert(Alignment >= alignof(T) && Alignment >= sizeof(void *) &&
+                    (Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of two that fits a pointer");
+
+public:
+  typedef T value_type;
+  typedef std::true_type is_always_equal;
+  typedef std::true_type propagate_on_container_move_assignment;
+
+  template <typename U> struct rebind {
+    typedef AlignedAllocator<U, Alignment> other;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+  T *allocate(std::size_t N) {
+    if (N > (SIZE_MAX - Alignment) / sizeof(T))
+      throw std::bad_array_new_length();
+    void *Block = std::malloc(N * sizeof(T) + Alignment);
+    if (!Block)
+      throw std::bad_alloc();
+    auto Aligned =
+        (reinterpret_cast<std::uintptr_t>(Block) + Alignment) & ~(Alignment - 1);
+    reinterpret_cast<void **>(Aligned)[-1] = Block;
+    return reinterpret_cast<T *>(Aligned);
+  }
+
+  void deallocate(T *P, std::size_t) noexcept {
+    std::free(reinterpret_cast<void **>(P)[-1]);
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const {
+    return false;
+  }
+};
+
+#endif /* AlignedAllocator_hpp */
@@ -0,0 +1,348 @@
+//
+//  AtomicBitVector.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef AtomicBitVector_hpp
+#define AtomicBitVector_hpp
+
+#include "NBitVector.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <climits>
+#include <memory>
+#include <thread>
+
+/// AtomicBitVector - A fixed-size NBitVector that any number of threads may
+/// read and modify concurrently, without locks.
+///
+/// Every word is a std::atomic<BitWord>, and every single-bit or single-word
+/// operation is one atomic instruction on it. The size is fixed at
+/// construction; there is no resize, since that would need to stop all
+/// users.
+///
+/// Memory ordering:
+///  - set, reset, test_and_set, test_and_reset, fetch_or_word, fetch_and_word
+///    and find_first_unset_and_claim are acq_rel read-modify-writes. A thread
+///    that sees a bit set by one of them, through test() or another of
+///    them, also sees everything the setting thread wrote before setting it.
+///    This makes a claimed bit a safe hand-off point for the work it guards.
+///  - test() is an acquire load. test_relaxed() is a relaxed load for hot
+///    polling loops that need no ordering with other data.
+///  - count(), any(), none() and the find functions read one word at a time
+///    with relaxed loads. Each word is read atomically, but the words are
+///    read at different times, so under concurrent writes the result is not
+///    a snapshot of one instant. If bits are only ever set while it runs,
+///    count() lies between the counts at the start and at the end of the
+///    call. With no concurrent writers it is exact.
+///  - count_snapshot() returns the count at one instant. It needs
+///    enable_snapshots(), after which every write also bumps a sequence
+///    counter (a seqlock, striped over the words) before and after it, and
+///    the reader retries until no write overlapped its pass. Writers stay
+///    lock-free; the reader waits for a quiet stripe set.
+class AtomicBitVector {
+public:
+  typedef NBitVector::BitWord BitWord;
+  typedef unsigned size_type;
+
+private:
+  enum { BITWORD_SIZE = (unsigned)sizeof(BitWord) * CHAR_BIT };
+
+  static_assert(std::atomic<BitWord>::is_always_lock_free,
+                "Words must be lock-free atomics");
+
+  /// Seqlock counters for count_snapshot(); word I is guarded by stripe
+  /// I % NumStripes. Odd while a write is in progress.
+  struct alignas(64) Stripe {
+    std::atomic<uint64_t> Seq{0};
+  };
+  enum { NumStripes = 64 };
+
+  std::unique_ptr<std::atomic<BitWord>[]> Bits;
+  std::unique_ptr<Stripe[]> Stripes;
+  unsigned Size = 0;
+
+  static unsigned NumBitWords(unsigned S) {
+    return (S + BITWORD_SIZE - 1) / BITWORD_SIZE;
+  }
+
+  static BitWord maskBit(unsigned Idx) {
+    return BitWord(1) << (Idx % BITWORD_SIZE);
+  }
+
+  /// Valid bits of word I: all of them but in the last, partial word.
+  BitWord validMask(unsigned I) const {
+    unsigned Rem = Size % BITWORD_SIZE;
+    if (I + 1 < NumBitWords(Size) || Rem == 0)
+      return ~BitWord(0);
+    return (BitWord(1) << Rem) - 1;
+  }
+
+  /// Returns F(Bits[I]), which must be the only write of word I, inside a
+  /// seqlock write section of I's stripe if snapshots are enabled.
+  template <typename Fn> BitWord writeWord(unsigned I, Fn &&F) {
+    if (!Stripes)
+      return F(Bits[I]);
+    std::atomic<uint64_t> &Seq = Stripes[I % NumStripes].Seq;
+    Seq.fetch_add(1, std::memory_order_relaxed);
+    // Orders the odd count before the word write for any reader that sees
+    // the write.
+    std::atomic_thread_fence(std::memory_order_release);
+    BitWord Old = F(Bits[I]);
+    Seq.fetch_add(1, std::memory_order_release);
+    return Old;
+  }
+
+  BitWord fetchOr(unsigned I, BitWord Mask) {
+    return writeWord(I, [&](std::atomic<BitWord> &W) {
+      return W.fetch_or(Mask, std::memory_order_acq_rel);
+    });
+  }
+
+  BitWord fetchAnd(unsigned I, BitWord Mask) {
+    return writeWord(I, [&](std::atomic<BitWord> &W) {
+      return W.fetch_and(Mask, std::memory_order_acq_rel);
+    });
+  }
+
+  /// Tries to claim an unset bit of word I, lowest first. Returns its index
+  /// or -1 once the word is full.
+  int claim_in_word(unsigned I) {
+    BitWord Valid = validMask(I);
+    BitWord W = Bits[I].load(std::memory_order_relaxed);
+    while (BitWord Free = ~W & Valid) {
+      BitWord Mask = Free & (~Free + 1);
+      W = fetchOr(I, Mask);
+      if (!(W & Mask))
+        return int(I * BITWORD_SIZE + std::countr_zero(Mask));
+      // Someone else took it; W now shows what they did.
+    }
+    return -1;
+  }
+
+public:
+  AtomicBitVector() = default;
+
+  /// Creates a vector of s bits, all set to t.
+  explicit AtomicBitVector(unsigned s, bool t = false)
+      : Bits(new std::atomic<BitWord>[NumBitWords(s)]), Size(s) {
+    for (unsigned i = 0; i < NumBitWords(s); ++i)
+      Bits[i].store(t ? validMask(i) : 0, std::memory_order_relaxed);
+  }
+
+  /// Creates a vector holding the bits of V. Not concurrent with writers of
+  /// V.
+  explicit AtomicBitVector(const NBitVector &V)
+      : Bits(new std::atomic<BitWord>[V.getNumWords()]), Size(V.size()) {
+    for (unsigned i = 0; i < V.getNumWords(); ++i)
+      Bits[i].store(V.getData()[i], std::memory_order_relaxed);
+  }
+
+  bool empty() const { return Size == 0; }
+  size_type size() const { return Size; }
+  unsigned getNumWords() const { return NumBitWords(Size); }
+
+  bool test(unsigned Idx) const {
+    assert(Idx < Size && "Out-of-bounds Bit access.");
+    return Bits[Idx / BITWORD_SIZE].load(std::memory_order_acquire) &
+           maskBit(Idx);
+  }
+
+  bool test_relaxed(unsigned Idx) const {
+    assert(Idx < Size && "Out-of-bounds Bit access.");
+    return Bits[Idx / BITWORD_SIZE].load(std::memory_order_relaxed) &
+           maskBit(Idx);
+  }
+
+  bool operator[](unsigned Idx) const { return test(Idx); }
+
+  AtomicBitVector &set(unsigned Idx) {
+    test_and_set(Idx);
+    return *this;
+  }
+
+  AtomicBitVector &reset(unsigned Idx) {
+    test_and_reset(Idx);
+    return *this;
+  }
+
+  /// test_and_set - Sets bit Idx. Returns true if this call changed it from
+  /// 0 to 1, i.e. if the caller claimed it.
+  bool test_and_set(unsigned Idx) {
+    assert(Idx < Size && "Out-of-bounds Bit access.");
+    BitWord Mask = maskBit(Idx);
+    return !(fetchOr(Idx / BITWORD_SIZE, Mask) & Mask);
+  }
+
+  /// test_and_reset - Resets bit Idx. Returns true if this call changed it
+  /// from 1 to 0.
+  bool test_and_reset(unsigned Idx) {
+    assert(Idx < Size && "Out-of-bounds Bit access.");
+    BitWord Mask = maskBit(Idx);
+    return fetchAnd(Idx / BITWORD_SIZE, ~Mask) & Mask;
+  }
+
+  /// fetch_or_word - Word WordIdx |= Mask, returning its previous value.
+  /// Sets up to BITWORD_SIZE bits in one atomic operation. Mask must not
+  /// have bits past size().
+  BitWord fetch_or_word(unsigned WordIdx, BitWord Mask) {
+    assert(WordIdx < getNumWords() && !(Mask & ~validMask(WordIdx)) &&
+           "Mask outside of the vector");
+    return fetchOr(WordIdx, Mask);
+  }
+
+  /// fetch_and_word - Word WordIdx &= Mask, returning its previous value.
+  BitWord fetch_and_word(unsigned WordIdx, BitWord Mask) {
+    assert(WordIdx < getNumWords() && "Word outside of the vector");
+    return fetchAnd(WordIdx, Mask);
+  }
+
+  /// Relaxed read of word WordIdx.
+  BitWord load_word(unsigned WordIdx) const {
+    assert(WordIdx < getNumWords() && "Word outside of the vector");
+    return Bits[WordIdx].load(std::memory_order_relaxed);
+  }
+
+  /// count - Returns the number of set bits, see the class comment for what
+  /// that means under concurrent writes.
+  size_type count() const {
+    unsigned NumBits = 0;
+    for (unsigned i = 0; i < getNumWords(); ++i)
+      NumBits += std::popcount(Bits[i].load(std::memory_order_relaxed));
+    return NumBits;
+  }
+
+  /// enable_snapshots - Makes count_snapshot() available, at the cost of two
+  /// more atomic increments per write. Must be called before the vector is
+  /// shared.
+  void enable_snapshots() {
+    if (!Stripes)
+      Stripes.reset(new Stripe[NumStripes]);
+  }
+
+  bool has_snapshots() const { return Stripes != nullptr; }
+
+  /// count_snapshot - Returns the number of bits that were set at one
+  /// instant during the call. Retries while writes overlap it, so a
+  /// continuous stream of writes can delay it indefinitely.
+  size_type count_snapshot() const {
+    assert(Stripes && "enable_snapshots() was not called");
+    uint64_t Before[NumStripes];
+    for (;;) {
+      bool Quiet = true;
+      for (unsigned S = 0; S < NumStripes && Quiet; ++S) {
+        Before[S] = Stripes[S].Seq.load(std::memory_order_acquire);
+        Quiet = !(Before[S] & 1);
+      }
+      if (Quiet) {
+        unsigned NumBits = 0;
+        for (unsigned i = 0; i < getNumWords(); ++i)
+          NumBits += std::popcount(Bits[i].load(std::memory_order_relaxed));
+        // Orders the word loads before the second pass over the counters.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        unsigned S = 0;
+        while (S < NumStripes &&
+               Stripes[S].Seq.load(std::memory_order_relaxed) == Before[S])
+          ++S;
+        if (S == NumStripes)
+          return NumBits;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  bool any() const {
+    for (unsigned i = 0; i < getNumWords(); ++i)
+      if (Bits[i].load(std::memory_order_relaxed))
+        return true;
+    return false;
+  }
+
+  bool none() const { return !any(); }
+
+  /// find_first_in - Returns the index of the first set bit in [Begin, End),
+  /// -1 if none was seen.
+  int find_first_in(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= Size);
+    for (unsigned i = Begin / BITWORD_SIZE; Begin < End;
+         ++i, Begin = i * BITWORD_SIZE) {
+      BitWord W = Bits[i].load(std::memory_order_relaxed) &
+                  maskTrailingZeros<BitWord>(Begin % BITWORD_SIZE);
+      if (W) {
+        unsigned Idx = i * BITWORD_SIZE + std::countr_zero(W);
+        return Idx < End ? int(Idx) : -1;
+      }
+    }
+    return -1;
+  }
+
+  /// find_first_unset_in - Returns the index of the first unset bit in
+  /// [Begin, End), -1 if none was seen.
+  int find_first_unset_in(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= Size);
+    for (unsigned i = Begin / BITWORD_SIZE; Begin < End;
+         ++i, Begin = i * BITWORD_SIZE) {
+      BitWord W = ~Bits[i].load(std::memory_order_relaxed) &
+                  maskTrailingZeros<BitWord>(Begin % BITWORD_SIZE);
+      if (W) {
+        unsigned Idx = i * BITWORD_SIZE + std::countr_zero(W);
+        return Idx < End ? int(Idx) : -1;
+      }
+    }
+    return -1;
+  }
+
+  int find_first() const { return find_first_in(0, Size); }
+  int find_next(unsigned Prev) const { return find_first_in(Prev + 1, Size); }
+  int find_first_unset() const { return find_first_unset_in(0, Size); }
+
+  /// find_first_unset_and_claim - Atomically finds an unset bit and sets it,
+  /// returning its index, or -1 if every bit is set. Each index is returned
+  /// to exactly one caller until it is reset.
+  ///
+  /// The search starts at word Hint / BITWORD_SIZE and wraps around, so
+  /// threads that start from different hints (e.g. their thread index times
+  /// size() / threads) mostly claim from different cache lines instead of
+  /// all fighting over the first free word.
+  int find_first_unset_and_claim(unsigned Hint = 0) {
+    unsigned NumWords = getNumWords();
+    if (NumWords == 0)
+      return -1;
+    unsigned Start = (Hint < Size ? Hint : 0) / BITWORD_SIZE;
+    for (unsigned n = 0; n < NumWords; ++n) {
+      unsigned I = Start + n < NumWords ? Start + n : Start + n - NumWords;
+      int Idx = claim_in_word(I);
+      if (Idx != -1)
+        return Idx;
+    }
+    return -1;
+  }
+
+  /// Copies the bits into an NBitVector, word by word as count() reads them.
+  NBitVector toBitVector() const {
+    NBitVector Result(Size);
+    for (unsigned i = 0; i < getNumWords(); ++i)
+      Result.getData()[i] = Bits[i].load(std::memory_order_acquire);
+    return Result;
+  }
+
+  /// Clears all bits. Not atomic as a whole: concurrent sets may survive.
+  void reset() {
+    for (unsigned i = 0; i < getNumWords(); ++i)
+      writeWord(i, [](std::atomic<BitWord> &W) {
+        W.store(0, std::memory_order_release);
+        return BitWord(0);
+      });
+  }
+
+  size_t getMemorySize() const {
+    return getNumWords() * sizeof(BitWord) +
+           (Stripes ? NumStripes * sizeof(Stripe) : 0);
+  }
+};
+
+#endif /* AtomicBitVector_hpp */
@@ -0,0 +1,942 @@
+//
+//  Benchmark.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "Benchmark.hpp"
+#include "AtomicBitVector.hpp"
+#include "BitMatrix.hpp"
+#include "BitSimilarity.hpp"
+#include "BitExpr.hpp"
+#include "ChunkedBitVector.hpp"
+#include "BlockedBloomFilter.hpp"
+#include "EWAHBitVector.hpp"
+#include "EliasFanoSequence.hpp"
+#include "BitVectorKernels.hpp"
+#include "GCParallelMarker.hpp"
+#include "ParallelBitOps.hpp"
+#include "SIMDDetect.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace tesseract;
+
+void RunBitOpsBenchmark() {
+  // 64 Mbit per operand, well past the last level cache on most machines.
+  const int Words = (64 << 20) / 32;
+  const unsigned Iterations = 20;
+
+  std::mt19937 Rng(42);
+  std::vector<uint32_t> A(Words), B(Words), Dst(Words), Ref(Words);
+  for (int i = 0; i < Words; ++i) {
+    A[i] = Rng();
+    B[i] = Rng();
+  }
+
+  std::vector<const BitOpKernels *> Sets = {&kBitOpsGeneric};
+#if defined(__x86_64__) || defined(__i386__)
+  if (SIMDDetect::IsSSE2Available())
+    Sets.push_back(&kBitOpsSSE2);
+  if (SIMDDetect::IsAVX2Available())
+    Sets.push_back(&kBitOpsAVX2);
+  if (SIMDDetect::IsAVX512FAvailable())
+    Sets.push_back(&kBitOpsAVX512);
+#endif
+
+  struct Op {
+    const char *Name;
+    BitOpFunction BitOpKernels::*Fn;
+  } Ops[] = {{"or", &BitOpKernels::Or},
+             {"and", &BitOpKernels::And},
+             {"xor", &BitOpKernels::Xor},
+             {"andnot", &BitOpKernels::AndNot}};
+
+  // Two loads and one store per word.
+  const size_t Bytes = size_t(Words) * sizeof(uint32_t) * 3;
+  printf("tesseract::BitVector bulk ops, %d Mbit, selected kernels: %s\n",
+         Words * 32 >> 20, BitOps.load(std::memory_order_acquire)->name);
+  for (const Op &O : Ops) {
+    double Baseline = 0;
+    for (const BitOpKernels *K : Sets) {
+      BitOpFunction Fn = K->*O.Fn;
+      double T = benchmarkBestOf(Iterations, [&] {
+        Fn(Dst.data(), A.data(), B.data(), Words);
+      });
+      if (K == &kBitOpsGeneric) {
+        Baseline = T;
+        Ref = Dst;
+      } else if (memcmp(Ref.data(), Dst.data(), Words * sizeof(uint32_t))) {
+        printf("%s/%s: result differs from generic kernel\n", O.Name, K->name);
+      }
+      char Name[64];
+      snprintf(Name, sizeof(Name), "%s/%s", O.Name, K->name);
+      reportThroughput(Name, Bytes, T, Baseline);
+    }
+  }
+
+  // NumSetBits: one load per word.
+  std::vector<std::pair<const char *, PopCountFunction>> Counts = {
+      {"popcount/generic", PopCountGeneric}};
+#if defined(__x86_64__) || defined(__i386__)
+  if (SIMDDetect::IsPOPCNTAvailable())
+    Counts.push_back({"popcount/popcnt", PopCountPOPCNT});
+  if (SIMDDetect::IsAVX2Available() && SIMDDetect::IsPOPCNTAvailable())
+    Counts.push_back({"popcount/avx2", PopCountAVX2});
+#endif
+  double Baseline = 0;
+  int64_t Expected = 0;
+  for (auto &C : Counts) {
+    int64_t Result = 0;
+    double T = benchmarkBestOf(Iterations, [&] {
+      Result = C.second(A.data(), Words);
+    });
+    if (C.second == PopCountGeneric) {
+      Baseline = T;
+      Expected = Result;
+    } else if (Result != Expected) {
+      printf("%s: result differs from generic kernel\n", C.first);
+    }
+    reportThroughput(C.first, size_t(Words) * sizeof(uint32_t), T, Baseline);
+  }
+}
+
+void RunBitExprBenchmark() {
+  const unsigned Bits = 64 << 20;
+  const unsigned Iterations = 10;
+
+  std::mt19937_64 Rng(42);
+  NBitVector A(Bits), B(Bits), C(Bits), D(Bits), Out(Bits), Tmp(Bits);
+  for (NBitVector *V : {&A, &B, &C, &D}) {
+    NBitVector::BitWord *Words = V->getData();
+    for (unsigned i = 0; i < V->getNumWords(); ++i)
+      Words[i] = Rng();
+  }
+
+  // Four operands and the destination streamed once.
+  const size_t Bytes = size_t(Bits / 8) * 5;
+  printf("NBitVector out = (a & b) | (c & ~d), %u Mbit\n", Bits >> 20);
+  size_t Expected = 0;
+  double Baseline = benchmarkBestOf(Iterations, [&] {
+    Out = A;
+    Out &= B;
+    Tmp = C;
+    Tmp.reset(D);
+    Out |= Tmp;
+  });
+  Expected = Out.count();
+  reportThroughput("in-place passes", Bytes, Baseline, Baseline);
+
+  auto Expr = (bitExpr(A) & bitExpr(B)) | (bitExpr(C) & ~bitExpr(D));
+  double T = benchmarkBestOf(Iterations, [&] { Expr.assignTo(Out); });
+  if (Out.count() != Expected)
+    printf("fused: result differs from in-place passes\n");
+  reportThroughput("fused", Bytes, T, Baseline);
+
+  double CountBaseline = benchmarkBestOf(Iterations, [&] {
+    Expr.assignTo(Out);
+    Expected = Out.count();
+  });
+  reportThroughput("fused + count()", Bytes, CountBaseline, Baseline);
+  size_t Ones = 0;
+  T = benchmarkBestOf(Iterations, [&] { Ones = Expr.assignAndCount(Out); });
+  if (Ones != Expected)
+    printf("assignAndCount: count differs\n");
+  reportThroughput("fused assignAndCount", Bytes, T, Baseline);
+}
+
+void RunParallelBitOpsBenchmark(unsigned MaxThreads) {
+  const unsigned Bits = 1u << 30;
+  const unsigned Iterations = 5;
+
+  std::mt19937_64 Rng(42);
+  NBitVector A(Bits), B(Bits);
+  for (NBitVector *V : {&A, &B}) {
+    NBitVector::BitWord *Words = V->getData();
+    for (unsigned i = 0; i < V->getNumWords(); ++i)
+      Words[i] = Rng();
+  }
+  const size_t VectorBytes = Bits / 8;
+  size_t Expected = A.count();
+
+  if (!MaxThreads)
+    MaxThreads = std::max(1u, std::thread::hardware_concurrency());
+  printf("ParallelBitOps on NBitVector, %u Mbit, up to %u threads\n",
+         Bits >> 20, MaxThreads);
+  double Baseline[4] = {};
+  for (unsigned Threads = 1; Threads <= MaxThreads;
+       Threads = Threads == MaxThreads ? MaxThreads + 1
+                                       : std::min(Threads * 2, MaxThreads)) {
+    ThreadPool Pool(Threads);
+    double T[4];
+    T[0] = benchmarkBestOf(Iterations, [&] {
+      if (parallelCount(A, Pool) != Expected)
+        printf("parallelCount: result differs\n");
+    });
+    T[1] = benchmarkBestOf(Iterations, [&] { parallelXor(B, A, Pool); });
+    T[2] = benchmarkBestOf(Iterations, [&] { parallelOr(B, A, Pool); });
+    T[3] = benchmarkBestOf(Iterations, [&] { parallelReset(B, Pool); });
+    if (Threads == 1)
+      std::copy(T, T + 4, Baseline);
+    printf("threads %2u  count %6.2f GB/s x%.2f  xor %6.2f GB/s x%.2f  "
+           "or %6.2f GB/s x%.2f  reset %6.2f GB/s x%.2f\n",
+           Threads, VectorBytes / T[0] / 1e9, Baseline[0] / T[0],
+           3 * VectorBytes / T[1] / 1e9, Baseline[1] / T[1],
+           3 * VectorBytes / T[2] / 1e9, Baseline[2] / T[2],
+           VectorBytes / T[3] / 1e9, Baseline[3] / T[3]);
+  }
+}
+
+// The pre-fetch_or GCBitset::SetBit<AccessType::ATOMIC>, kept as the baseline.
+static bool SetBitCAS(GCBitset *Bitset, uintptr_t Offset) {
+  auto Word = reinterpret_cast<std::atomic<uint32_t> *>(&Bitset->Words()[Offset >> 5]);
+  uint32_t Mask = uint32_t(1) << (Offset & 31);
+  uint32_t OldValue = Word->load(std::memory_order_relaxed);
+  do {
+    if (OldValue & Mask)
+      return false;
+  } while (!Word->compare_exchange_weak(OldValue, OldValue | Mask,
+                                        std::memory_order_seq_cst));
+  return true;
+}
+
+void RunGCBitsetMarkBenchmark() {
+  // 4 KiB of mark bits, so that the threads collide on words constantly.
+  const size_t Bits = 4096 * 8;
+  const size_t OpsPerThread = 1 << 20;
+  std::vector<uint32_t> Storage(Bits / 32);
+  auto *Bitset = reinterpret_cast<GCBitset *>(Storage.data());
+
+  std::vector<uintptr_t> Offsets(OpsPerThread);
+  std::mt19937 Rng(7);
+  for (uintptr_t &O : Offsets)
+    O = Rng() % Bits;
+
+  printf("GCBitset contended SetBit<ATOMIC>, %zu ops per thread\n",
+         OpsPerThread);
+  auto RunThreads = [&](unsigned Threads, auto &&SetBit) {
+    Bitset->Clear(Bits / 8);
+    BenchmarkTimer Timer;
+    std::vector<std::thread> Workers;
+    for (unsigned T = 0; T < Threads; ++T) {
+      Workers.emplace_back([&, T] {
+        // Every thread walks the same offsets from a different start, and
+        // clears a bit now and then so that words keep changing.
+        for (size_t i = 0; i < OpsPerThread; ++i) {
+          uintptr_t O = Offsets[(i + T * 4099) % OpsPerThread];
+          if (!SetBit(O) && (i & 15) == 0)
+            Bitset->ClearBit<AccessType::ATOMIC>(O);
+        }
+      });
+    }
+    for (std::thread &W : Workers)
+      W.join();
+    return Timer.seconds();
+  };
+  for (unsigned Threads = 1; Threads <= 64; Threads *= 2) {
+    double CAS = RunThreads(Threads, [&](uintptr_t O) { return SetBitCAS(Bitset, O); });
+    double FetchOr = RunThreads(Threads, [&](uintptr_t O) {
+      return Bitset->SetBit<AccessType::ATOMIC>(O);
+    });
+    double Ops = double(OpsPerThread) * Threads;
+    printf("threads %2u  cas %8.1f Mops/s  fetch_or %8.1f Mops/s  x%.2f\n",
+           Threads, Ops / CAS / 1e6, Ops / FetchOr / 1e6, CAS / FetchOr);
+  }
+
+  // Random graph with 4 references per object, 1M objects.
+  const size_t Objects = 1 << 20;
+  const unsigned Fanout = 4;
+  std::vector<uint32_t> Edges(Objects * Fanout);
+  for (uint32_t &E : Edges)
+    E = Rng() % Objects;
+  std::vector<uint32_t> MarkStorage(Objects / 32);
+  auto *Marks = reinterpret_cast<GCBitset *>(MarkStorage.data());
+  std::vector<uintptr_t> Roots(64);
+  for (uintptr_t &R : Roots)
+    R = Rng() % Objects;
+
+  printf("GCParallelMarker, %zu objects, %u refs each\n", Objects, Fanout);
+  for (unsigned Threads = 1; Threads <= 64; Threads *= 2) {
+    Marks->Clear(Objects / 8);
+    GCParallelMarker Marker(Marks, Threads);
+    BenchmarkTimer Timer;
+    Marker.Mark(Roots, [&](uintptr_t Obj, auto &&Push) {
+      for (unsigned i = 0; i < Fanout; ++i)
+        Push(Edges[Obj * Fanout + i]);
+    });
+    double T = Timer.seconds();
+    size_t Marked = 0;
+    Marks->IterateSetBits(Objects / 8, [&](size_t) { ++Marked; });
+    printf("threads %2u  %8.2f ms  %zu marked\n", Threads, T * 1e3, Marked);
+  }
+}
+
+void RunGCBitsetSweepBenchmark() {
+  // 8 MiB of mark bits over 512 MiB of heap at 8 bytes per bit, swept in
+  // 256 KiB regions. Live objects come in clusters with gaps between them.
+  const size_t Bits = size_t(1) << 26;
+  const size_t BytesPerBit = 8;
+  const size_t RegionBits = (256 << 10) / BytesPerBit;
+  const size_t MinFreeBits = 4;
+  const size_t Regions = Bits / RegionBits;
+  std::vector<uint32_t> Storage(Bits / 32);
+  auto *Marks = reinterpret_cast<GCBitset *>(Storage.data());
+  std::mt19937 Rng(21);
+  for (size_t Pos = 0; Pos < Bits;) {
+    size_t Live = Rng() % 256, Gap = Rng() % 512;
+    for (size_t End = std::min(Bits, Pos + Live); Pos < End; Pos += 1 + Rng() % 6)
+      Marks->SetBit(Pos);
+    Pos += Gap;
+  }
+
+  // Live bytes and reusable free bytes of one region, as a sweeper needs.
+  struct RegionSummary {
+    size_t Live = 0, Free = 0;
+  };
+  auto SweepBitwise = [&](size_t Region) {
+    RegionSummary S;
+    size_t Run = 0;
+    for (size_t O = Region * RegionBits, E = O + RegionBits; O <= E; ++O) {
+      if (O < E && !Marks->TestBit(O)) {
+        ++Run;
+        continue;
+      }
+      if (Run >= MinFreeBits)
+        S.Free += Run * BytesPerBit;
+      Run = 0;
+      S.Live += O < E ? BytesPerBit : 0;
+    }
+    return S;
+  };
+  auto SweepWordwise = [&](size_t Region) {
+    RegionSummary S;
+    uintptr_t O = Region * RegionBits, E = O + RegionBits, RunBegin, RunEnd;
+    S.Live = Marks->CountMarkedBits(O, E) * BytesPerBit;
+    while (Marks->FindNextFreeRun(O, E, MinFreeBits, &RunBegin, &RunEnd)) {
+      S.Free += (RunEnd - RunBegin) * BytesPerBit;
+      O = RunEnd;
+    }
+    return S;
+  };
+
+  printf("GCBitset sweep, %zu regions of %zu bits\n", Regions, RegionBits);
+  RegionSummary Base, Fast;
+  double TBase = benchmarkBestOf(3, [&] {
+    Base = RegionSummary();
+    for (size_t R = 0; R < Regions; ++R) {
+      RegionSummary S = SweepBitwise(R);
+      Base.Live += S.Live;
+      Base.Free += S.Free;
+    }
+  });
+  double T = benchmarkBestOf(3, [&] {
+    Fast = RegionSummary();
+    for (size_t R = 0; R < Regions; ++R) {
+      RegionSummary S = SweepWordwise(R);
+      Fast.Live += S.Live;
+      Fast.Free += S.Free;
+    }
+  });
+  printf("%-24s %8.2f ms  bitwise %7.2f ms  x%.2f  live %zu MiB  free %zu MiB%s\n",
+         "sweep", T * 1e3, TBase * 1e3, TBase / T, Fast.Live >> 20,
+         Fast.Free >> 20,
+         Base.Live == Fast.Live && Base.Free == Fast.Free ? "" : "  MISMATCH");
+
+  std::vector<size_t> LiveBytes(GCBitset::RegionCount(Bits / 8, RegionBits));
+  T = benchmarkBestOf(3, [&] {
+    Marks->CollectLiveBytesPerRegion(Bits / 8, RegionBits, BytesPerBit,
+                                     LiveBytes.data());
+  });
+  size_t Objects = 0;
+  double TIter = benchmarkBestOf(3, [&] {
+    Objects = 0;
+    Marks->IterateMarkedBits(0, Bits, [&](uintptr_t) { ++Objects; });
+  });
+  printf("%-24s %8.2f ms  iterate %7.2f ms  %zu objects\n", "live bytes",
+         T * 1e3, TIter * 1e3, Objects);
+
+  // Regions are independent: threads take the next unswept one.
+  for (unsigned Threads = 1; Threads <= 8; Threads *= 2) {
+    std::atomic<size_t> Next{0}, Free{0};
+    BenchmarkTimer Timer;
+    std::vector<std::thread> Workers;
+    for (unsigned i = 0; i < Threads; ++i) {
+      Workers.emplace_back([&] {
+        size_t MyFree = 0;
+        for (size_t R; (R = Next.fetch_add(1, std::memory_order_relaxed)) < Regions;)
+          MyFree += SweepWordwise(R).Free;
+        Free.fetch_add(MyFree, std::memory_order_relaxed);
+      });
+    }
+    for (std::thread &W : Workers)
+      W.join();
+    T = Timer.seconds();
+    printf("threads %2u  %8.2f ms%s\n", Threads, T * 1e3,
+           Free.load() == Fast.Free ? "" : "  MISMATCH");
+  }
+}
+
+void RunBloomFilterBenchmark() {
+  // 16M keys at 10 bits per key, a 20 MB filter, well past the caches.
+  const size_t Keys = 16 << 20;
+  const size_t Probes = 4 << 20;
+  const double BitsPerKey = 10;
+  const unsigned K = 7;
+
+  std::mt19937_64 Rng(11);
+  std::vector<uint64_t> Inserted(Keys), Queries(Probes);
+  for (uint64_t &H : Inserted)
+    H = Rng();
+  // Half of the probes are inserted keys, half are random.
+  for (size_t i = 0; i < Probes; ++i)
+    Queries[i] = i % 2 ? Inserted[Rng() % Keys] : Rng();
+
+  // The classic filter: K bits anywhere in the vector by double hashing, one
+  // cache miss per probe.
+  const size_t ClassicBits = size_t(Keys * BitsPerKey);
+  NBitVector Classic{unsigned(ClassicBits)};
+  auto ClassicBit = [&](uint64_t H, unsigned i) {
+    uint64_t Mixed = (H >> 32) + i * ((H & 0xffffffff) | 1);
+    return unsigned((Mixed & 0xffffffff) * ClassicBits >> 32);
+  };
+  for (uint64_t H : Inserted)
+    for (unsigned i = 0; i < K; ++i)
+      Classic.set(ClassicBit(H, i));
+
+  BlockedBloomFilter Blocked(Keys, BitsPerKey);
+  Blocked.insertBatch(Inserted.data(), Keys);
+  std::unique_ptr<bool[]> Results(new bool[Probes]);
+
+  printf("Bloom filter, %zu keys, %.0f bits per key, %zu probes\n", Keys,
+         BitsPerKey, Probes);
+  size_t Hits = 0;
+  double Base = benchmarkBestOf(3, [&] {
+    Hits = 0;
+    for (uint64_t H : Queries) {
+      bool Hit = true;
+      for (unsigned i = 0; i < K && Hit; ++i)
+        Hit = Classic.test(ClassicBit(H, i));
+      Hits += Hit;
+    }
+  });
+  printf("%-24s %8.1f Mprobes/s  hits %zu\n", "classic", Probes / Base / 1e6,
+         Hits);
+  double T = benchmarkBestOf(3, [&] {
+    Hits = 0;
+    for (uint64_t H : Queries)
+      Hits += Blocked.mayContain(H);
+  });
+  printf("%-24s %8.1f Mprobes/s  hits %zu  x%.2f\n", "blocked", Probes / T / 1e6,
+         Hits, Base / T);
+  T = benchmarkBestOf(3, [&] {
+    Hits = Blocked.mayContainBatch(Queries.data(), Probes, Results.get());
+  });
+  printf("%-24s %8.1f Mprobes/s  hits %zu  x%.2f\n", "blocked batch",
+         Probes / T / 1e6, Hits, Base / T);
+}
+
+void RunAtomicBitVectorBenchmark() {
+  // A shared visited set: every thread marks the same random nodes.
+  const unsigned Bits = 1 << 20;
+  const size_t OpsPerThread = 1 << 20;
+  std::vector<unsigned> Nodes(OpsPerThread);
+  std::mt19937 Rng(13);
+  for (unsigned &N : Nodes)
+    N = Rng() % Bits;
+
+  auto RunThreads = [](unsigned Threads, auto &&Body) {
+    BenchmarkTimer Timer;
+    std::vector<std::thread> Workers;
+    for (unsigned T = 0; T < Threads; ++T)
+      Workers.emplace_back([&, T] { Body(T); });
+    for (std::thread &W : Workers)
+      W.join();
+    return Timer.seconds();
+  };
+
+  printf("AtomicBitVector visited set, %zu test_and_set per thread\n",
+         OpsPerThread);
+  for (unsigned Threads = 1; Threads <= 64; Threads *= 2) {
+    NBitVector Guarded(Bits);
+    std::mutex Lock;
+    double Mutex = RunThreads(Threads, [&](unsigned T) {
+      for (size_t i = 0; i < OpsPerThread; ++i) {
+        unsigned N = Nodes[(i + T * 4099) % OpsPerThread];
+        std::lock_guard<std::mutex> Guard(Lock);
+        if (!Guarded.test(N))
+          Guarded.set(N);
+      }
+    });
+    AtomicBitVector Visited(Bits);
+    double Atomic = RunThreads(Threads, [&](unsigned T) {
+      for (size_t i = 0; i < OpsPerThread; ++i)
+        Visited.test_and_set(Nodes[(i + T * 4099) % OpsPerThread]);
+    });
+    // The same with the seqlock writes that count_snapshot() needs.
+    AtomicBitVector Snapshotted(Bits);
+    Snapshotted.enable_snapshots();
+    double Snapshot = RunThreads(Threads, [&](unsigned T) {
+      for (size_t i = 0; i < OpsPerThread; ++i)
+        Snapshotted.test_and_set(Nodes[(i + T * 4099) % OpsPerThread]);
+    });
+    double Ops = double(OpsPerThread) * Threads;
+    printf("threads %2u  mutex %8.1f Mops/s  atomic %8.1f Mops/s  x%.2f  "
+           "snapshots %8.1f Mops/s\n",
+           Threads, Ops / Mutex / 1e6, Ops / Atomic / 1e6, Mutex / Atomic,
+           Ops / Snapshot / 1e6);
+  }
+
+  // Work distribution: the threads claim every bit exactly once.
+  printf("AtomicBitVector claim all of %u bits\n", Bits);
+  for (unsigned Threads = 1; Threads <= 64; Threads *= 2) {
+    NBitVector Guarded(Bits);
+    std::mutex Lock;
+    // A shared cursor under the lock, so the baseline does not rescan.
+    unsigned Cursor = 0;
+    double Mutex = RunThreads(Threads, [&](unsigned) {
+      for (;;) {
+        std::lock_guard<std::mutex> Guard(Lock);
+        int I = Guarded.find_first_unset_in(Cursor, Bits);
+        if (I == -1)
+          return;
+        Guarded.set(unsigned(I));
+        Cursor = unsigned(I);
+      }
+    });
+    AtomicBitVector Claimed(Bits);
+    double Atomic = RunThreads(Threads, [&](unsigned T) {
+      unsigned Hint = unsigned(uint64_t(Bits) * T / Threads);
+      for (int I; (I = Claimed.find_first_unset_and_claim(Hint)) != -1;)
+        Hint = unsigned(I);
+    });
+    printf("threads %2u  mutex %8.1f Mclaims/s  atomic %8.1f Mclaims/s  x%.2f\n",
+           Threads, Bits / Mutex / 1e6, Bits / Atomic / 1e6, Mutex / Atomic);
+  }
+}
+
+void RunBitMatrixBenchmark() {
+  // A random dependency graph whose closure is about half full.
+  const unsigned Nodes = 4096;
+  const unsigned Edges = Nodes * 2;
+  std::mt19937 Rng(17);
+  BitMatrix Graph(Nodes, Nodes);
+  std::vector<NBitVector> Rows(Nodes, NBitVector(Nodes));
+  for (unsigned e = 0; e < Edges; ++e) {
+    unsigned From = Rng() % Nodes, To = Rng() % Nodes;
+    Graph.set(From, To);
+    Rows[From].set(To);
+  }
+
+  printf("BitMatrix, %u nodes, %u edges\n", Nodes, Edges);
+  // Baseline: Warshall over one heap-allocated NBitVector per node.
+  BenchmarkTimer Timer;
+  for (unsigned K = 0; K < Nodes; ++K)
+    for (unsigned I = 0; I < Nodes; ++I)
+      if (Rows[I].test(K))
+        Rows[I] |= Rows[K];
+  double Base = Timer.seconds();
+  BitMatrix Closure = Graph;
+  Timer.reset();
+  Closure.transitive_closure();
+  double T = Timer.seconds();
+  bool Same = true;
+  for (unsigned I = 0; I < Nodes && Same; ++I)
+    Same = Closure.getRow(I) == Rows[I];
+  printf("%-24s %8.1f ms  rows %8.1f ms  x%.2f  %zu pairs%s\n", "closure",
+         T * 1e3, Base * 1e3, Base / T, Closure.count(),
+         Same ? "" : "  MISMATCH");
+
+  // Product of the graph with its closure: per set bit row ORs against
+  // Four Russians.
+  Timer.reset();
+  BitMatrix Naive(Nodes, Nodes);
+  for (unsigned I = 0; I < Nodes; ++I)
+    for (unsigned K = 0; K < Nodes; ++K)
+      if (Graph.test(I, K))
+        Naive.row_or(I, Closure.getRow(K));
+  Base = Timer.seconds();
+  Timer.reset();
+  BitMatrix Product = Graph.multiply(Closure);
+  T = Timer.seconds();
+  printf("%-24s %8.1f ms  naive %7.1f ms  x%.2f%s\n", "multiply", T * 1e3,
+         Base * 1e3, Base / T, Product == Naive ? "" : "  MISMATCH");
+
+  Base = benchmarkBestOf(3, [&] {
+    BitMatrix Result(Nodes, Nodes);
+    for (unsigned I = 0; I < Nodes; ++I)
+      for (unsigned J = 0; J < Nodes; ++J)
+        if (Closure.test(I, J))
+          Result.set(J, I);
+  });
+  T = benchmarkBestOf(3, [&] { BitMatrix Result = Closure.transpose(); });
+  printf("%-24s %8.2f ms  naive %7.2f ms  x%.2f\n", "transpose", T * 1e3,
+         Base * 1e3, Base / T);
+}
+
+namespace {
+
+/// Alternating runs of zeros and ones of up to MaxRun bits, with every
+/// DirtyEvery-th run random instead.
+NBitVector makeRunHeavy(unsigned Size, unsigned MaxRun, unsigned DirtyEvery,
+                        std::mt19937 &Rng) {
+  NBitVector V(Size);
+  bool Bit = false;
+  for (unsigned Pos = 0, n = 0; Pos < Size; ++n, Bit = !Bit) {
+    unsigned End = std::min(Size, Pos + 1 + unsigned(Rng() % MaxRun));
+    if (n % DirtyEvery == 0) {
+      for (; Pos < End; ++Pos)
+        if (Rng() & 1)
+          V.set(Pos);
+    } else {
+      if (Bit)
+        V.set(Pos, End);
+      Pos = End;
+    }
+  }
+  return V;
+}
+
+} // end anonymous namespace
+
+void RunEWAHBenchmark() {
+  const unsigned Size = 1u << 26;
+  std::mt19937 Rng(20);
+  NBitVector A = makeRunHeavy(Size, 1 << 16, 8, Rng);
+  NBitVector B = makeRunHeavy(Size, 1 << 16, 8, Rng);
+  EWAHBitVector EA(A), EB(B);
+
+  printf("EWAHBitVector, %u bits, %.1f%% and %.1f%% of the raw size\n", Size,
+         100.0 * EA.getMemorySize() / A.getMemorySize(),
+         100.0 * EB.getMemorySize() / B.getMemorySize());
+
+  size_t Raw = 0, Compressed = 0;
+  double Base = benchmarkBestOf(5, [&] {
+    NBitVector R = A;
+    R &= B;
+    Raw = R.count();
+  });
+  double T = benchmarkBestOf(5, [&] { Compressed = (EA & EB).count(); });
+  printf("%-24s %8.3f ms  raw %9.3f ms  x%.2f%s\n", "and + count", T * 1e3,
+         Base * 1e3, Base / T, Raw == Compressed ? "" : "  MISMATCH");
+
+  Base = benchmarkBestOf(5, [&] {
+    NBitVector R = A;
+    R |= B;
+    Raw = R.count();
+  });
+  T = benchmarkBestOf(5, [&] { Compressed = orCount(EA, EB); });
+  printf("%-24s %8.3f ms  raw %9.3f ms  x%.2f%s\n", "orCount", T * 1e3,
+         Base * 1e3, Base / T, Raw == Compressed ? "" : "  MISMATCH");
+
+  Base = benchmarkBestOf(5, [&] {
+    NBitVector R = A;
+    R ^= B;
+    Raw = R.count();
+  });
+  T = benchmarkBestOf(5, [&] { Compressed = xorCount(EA, EB); });
+  printf("%-24s %8.3f ms  raw %9.3f ms  x%.2f%s\n", "xorCount", T * 1e3,
+         Base * 1e3, Base / T, Raw == Compressed ? "" : "  MISMATCH");
+
+  Base = benchmarkBestOf(5, [&] { Raw = A.count(); });
+  T = benchmarkBestOf(5, [&] {
+    Compressed = 0;
+    for (unsigned Idx : EA)
+      Compressed += Idx & 1;
+  });
+  printf("%-24s %8.3f ms  (%zu odd of %zu set bits)\n", "iterate", T * 1e3,
+         Compressed, Raw);
+
+  T = benchmarkBestOf(5, [&] { EWAHBitVector E(A); });
+  Base = benchmarkBestOf(5, [&] { NBitVector V = EA.decompress(); });
+  printf("%-24s %8.3f ms  decompress %5.3f ms\n", "compress", T * 1e3,
+         Base * 1e3);
+}
+
+void RunChunkedBitVectorBenchmark() {
+  // A 32 MiB bitmap with every chunk allocated, checkpointed while a mutator
+  // keeps setting bits in a hot eighth of it.
+  const unsigned Size = 1u << 28;
+  const unsigned Checkpoints = 16;
+  const unsigned WritesPerCheckpoint = 4096;
+  std::mt19937 Rng(22);
+  NBitVector Flat(Size);
+  for (unsigned i = 0; i < Size / 16; ++i)
+    Flat.set(Rng() % Size);
+  ChunkedBitVector Chunked(Flat);
+  std::vector<unsigned> Writes(Checkpoints * WritesPerCheckpoint);
+  for (unsigned &W : Writes)
+    W = Rng() % (Size / 8);
+
+  printf("ChunkedBitVector, %u MiB, %u checkpoints of %u writes\n", Size >> 23,
+         Checkpoints, WritesPerCheckpoint);
+  BenchmarkTimer Timer;
+  for (unsigned c = 0; c < Checkpoints; ++c) {
+    NBitVector Checkpoint = Flat;
+    for (unsigned i = 0; i < WritesPerCheckpoint; ++i)
+      Flat.set(Writes[c * WritesPerCheckpoint + i]);
+  }
+  double Base = Timer.seconds();
+
+  size_t Dirty = 0;
+  double Snapshot = 0;
+  Timer.reset();
+  for (unsigned c = 0; c < Checkpoints; ++c) {
+    BenchmarkTimer SnapshotTimer;
+    ChunkedBitVector Checkpoint = Chunked.snapshot();
+    Snapshot += SnapshotTimer.seconds();
+    for (unsigned i = 0; i < WritesPerCheckpoint; ++i)
+      Chunked.set(Writes[c * WritesPerCheckpoint + i]);
+    Dirty += Chunked.changed_chunks(Checkpoint).size();
+  }
+  double T = Timer.seconds();
+  printf("%-24s %8.2f ms  copy %8.2f ms  x%.2f%s\n", "checkpoint + writes",
+         T * 1e3, Base * 1e3, Base / T,
+         Chunked.toBitVector() == Flat ? "" : "  MISMATCH");
+  printf("%-24s %8.3f ms  %zu of %u chunks dirty per checkpoint (%.1f%%)\n",
+         "snapshot", Snapshot / Checkpoints * 1e3, Dirty / Checkpoints,
+         Chunked.getNumChunks(), 100.0 * Dirty / Checkpoints / Chunked.getNumChunks());
+}
+
+namespace {
+
+/// A bump arena for the short-lived vectors of one request, released all at
+/// once by reset().
+class RequestArena {
+  std::vector<char> Buffer;
+  size_t Used = 0;
+
+public:
+  explicit RequestArena(size_t Bytes) : Buffer(Bytes) {}
+
+  void *allocate(size_t Bytes) {
+    Used = (Used + 63) & ~size_t(63);
+    if (Used + Bytes > Buffer.size())
+      return ::operator new(Bytes);
+    void *P = Buffer.data() + Used;
+    Used += Bytes;
+    return P;
+  }
+  void deallocate(void *P) {
+    if (P < Buffer.data() || P >= Buffer.data() + Buffer.size())
+      ::operator delete(P);
+  }
+  void reset() { Used = 0; }
+};
+
+template <typename T> struct RequestArenaAllocator {
+  typedef T value_type;
+  RequestArena *Arena = nullptr;
+
+  RequestArenaAllocator() = default;
+  explicit RequestArenaAllocator(RequestArena *A) : Arena(A) {}
+  template <typename U>
+  RequestArenaAllocator(const RequestArenaAllocator<U> &O) : Arena(O.Arena) {}
+
+  T *allocate(size_t N) { return static_cast<T *>(Arena->allocate(N * sizeof(T))); }
+  void deallocate(T *P, size_t) { Arena->deallocate(P); }
+
+  template <typename U>
+  bool operator==(const RequestArenaAllocator<U> &O) const { return Arena == O.Arena; }
+  template <typename U>
+  bool operator!=(const RequestArenaAllocator<U> &O) const { return Arena != O.Arena; }
+};
+
+/// tesseract::BitVector as it was before it had move operations.
+struct CopyOnlyBitVector : tesseract::BitVector {
+  using tesseract::BitVector::BitVector;
+  CopyOnlyBitVector(const CopyOnlyBitVector &) = default;
+  CopyOnlyBitVector &operator=(const CopyOnlyBitVector &) = default;
+};
+
+} // end anonymous namespace
+
+void RunBitVectorStorageBenchmark() {
+  const unsigned Requests = 2000;
+  const unsigned VectorsPerRequest = 256;
+  const unsigned Bits = 2048;
+
+  printf("Bit vector storage, %u requests of %u vectors of %u bits\n", Requests,
+         VectorsPerRequest, Bits);
+  // Collecting vectors into a growing std::vector: each reallocation copied
+  // every tesseract::BitVector before they could be moved.
+  auto Collect = [&](auto Tag) {
+    typedef decltype(Tag) VectorT;
+    size_t Sum = 0;
+    for (unsigned R = 0; R < Requests / 8; ++R) {
+      std::vector<VectorT> Vectors;
+      for (unsigned i = 0; i < VectorsPerRequest; ++i) {
+        VectorT V{int(Bits)};
+        V.SetBit(int((R + i) % Bits));
+        Vectors.push_back(std::move(V));
+      }
+      Sum += Vectors.size();
+    }
+    return Sum;
+  };
+  double Base = benchmarkBestOf(3, [&] { Collect(CopyOnlyBitVector()); });
+  double T = benchmarkBestOf(3, [&] { Collect(tesseract::BitVector()); });
+  printf("%-24s %8.2f ms  copying %7.2f ms  x%.2f\n", "collect (move)", T * 1e3,
+         Base * 1e3, Base / T);
+
+  // Short-lived scratch vectors: one heap allocation each against a bump
+  // arena reset once per request.
+  size_t Count = 0;
+  Base = benchmarkBestOf(3, [&] {
+    for (unsigned R = 0; R < Requests; ++R) {
+      NBitVector Acc(Bits);
+      for (unsigned i = 0; i < VectorsPerRequest; ++i) {
+        NBitVector V(Bits);
+        V.set((R * 31 + i * 7) % Bits);
+        Acc |= V;
+      }
+      Count += Acc.count();
+    }
+  });
+  RequestArena Arena(size_t(VectorsPerRequest + 1) * (Bits / 8 + 64));
+  typedef BasicNBitVector<RequestArenaAllocator<NBitVector::BitWord>> ArenaBitVector;
+  size_t ArenaCount = 0;
+  T = benchmarkBestOf(3, [&] {
+    for (unsigned R = 0; R < Requests; ++R) {
+      Arena.reset();
+      RequestArenaAllocator<NBitVector::BitWord> Alloc(&Arena);
+      ArenaBitVector Acc(Bits, false, Alloc);
+      for (unsigned i = 0; i < VectorsPerRequest; ++i) {
+        ArenaBitVector V(Bits, false, Alloc);
+        V.set((R * 31 + i * 7) % Bits);
+        Acc |= V;
+      }
+      ArenaCount += Acc.count();
+    }
+  });
+  printf("%-24s %8.2f ms  heap %10.2f ms  x%.2f%s\n", "scratch (arena)",
+         T * 1e3, Base * 1e3, Base / T, Count == ArenaCount ? "" : "  MISMATCH");
+}
+
+void RunBitSimilarityBenchmark() {
+  // A 1M-entry database of 1024-bit fingerprints, ~1/8 of the bits set,
+  // scanned for the Jaccard similarity to a query.
+  const unsigned Bits = 1024;
+  const unsigned Candidates = 1u << 20;
+  std::mt19937 Rng(24);
+  auto Fingerprint = [&] {
+    NBitVector V(Bits);
+    for (unsigned i = 0; i < Bits / 8; ++i)
+      V.set(Rng() % Bits);
+    return V;
+  };
+  NBitVector Query = Fingerprint();
+  std::vector<NBitVector> Database;
+  Database.reserve(Candidates);
+  for (unsigned i = 0; i < Candidates; ++i)
+    Database.push_back(Fingerprint());
+
+  SIMDDetect::Initialize();
+  printf("Bit similarity, %u fingerprints of %u bits, %s kernels\n",
+         Candidates, Bits, BitCounts.load(std::memory_order_acquire)->name);
+  std::vector<double> Expected(Candidates), Scores(Candidates);
+  double Base = benchmarkBestOf(3, [&] {
+    for (unsigned i = 0; i < Candidates; ++i) {
+      NBitVector And = Query, Or = Query;
+      And &= Database[i];
+      Or |= Database[i];
+      size_t Union = Or.count();
+      Expected[i] = Union ? double(And.count()) / double(Union) : 1.0;
+    }
+  });
+  double T = benchmarkBestOf(3, [&] {
+    for (unsigned i = 0; i < Candidates; ++i)
+      Scores[i] = jaccard(Query, Database[i]);
+  });
+  printf("%-24s %8.2f ms  materialized %8.2f ms  x%.2f%s\n", "jaccard", T * 1e3,
+         Base * 1e3, Base / T, Scores == Expected ? "" : "  MISMATCH");
+  std::fill(Scores.begin(), Scores.end(), 0.0);
+  T = benchmarkBestOf(3, [&] {
+    jaccard_many(Query, Database.data(), Candidates, Scores.data());
+  });
+  printf("%-24s %8.2f ms  materialized %8.2f ms  x%.2f%s\n", "jaccard_many",
+         T * 1e3, Base * 1e3, Base / T, Scores == Expected ? "" : "  MISMATCH");
+}
+
+void RunEliasFanoBenchmark() {
+  // A 16M-entry posting list with an average gap of 32.
+  const unsigned N = 1u << 24;
+  const unsigned Queries = 1u << 20;
+  std::mt19937_64 Rng(25);
+  std::vector<uint64_t> Postings(N);
+  uint64_t Doc = 0;
+  for (uint64_t &P : Postings)
+    P = Doc += 1 + Rng() % 63;
+  std::vector<uint64_t> Indices(Queries), Targets(Queries);
+  for (unsigned i = 0; i < Queries; ++i) {
+    Indices[i] = Rng() % N;
+    Targets[i] = Rng() % (Doc + 1);
+  }
+
+  BenchmarkTimer Timer;
+  EliasFanoSequence::Builder Builder(N, Doc + 1);
+  for (uint64_t P : Postings)
+    Builder.push_back(P);
+  EliasFanoSequence Seq = Builder.build();
+  double Build = Timer.seconds();
+  printf("Elias-Fano, %u values, %u queries, built in %.2f ms\n", N, Queries,
+         Build * 1e3);
+  printf("%-24s %8.2f MiB  uint64_t %6.2f MiB  x%.2f smaller (%.2f bits/value)\n",
+         "memory", Seq.getMemorySize() / 1048576.0,
+         N * sizeof(uint64_t) / 1048576.0,
+         double(N * sizeof(uint64_t)) / Seq.getMemorySize(),
+         Seq.getMemorySize() * 8.0 / N);
+
+  uint64_t Expected = 0, Sum = 0;
+  double Base = benchmarkBestOf(3, [&] {
+    Expected = 0;
+    for (uint64_t I : Indices)
+      Expected += Postings[I];
+  });
+  double T = benchmarkBestOf(3, [&] {
+    Sum = 0;
+    for (uint64_t I : Indices)
+      Sum += Seq.access(I);
+  });
+  printf("%-24s %8.1f ns  array %8.1f ns%s\n", "access", T * 1e9 / Queries,
+         Base * 1e9 / Queries, Sum == Expected ? "" : "  MISMATCH");
+
+  Base = benchmarkBestOf(3, [&] {
+    Expected = 0;
+    for (uint64_t X : Targets) {
+      auto It = std::lower_bound(Postings.begin(), Postings.end(), X);
+      Expected += It == Postings.end() ? 0 : *It;
+    }
+  });
+  T = benchmarkBestOf(3, [&] {
+    Sum = 0;
+    for (uint64_t X : Targets) {
+      auto It = Seq.next_geq(X);
+      Sum += It == Seq.end() ? 0 : *It;
+    }
+  });
+  printf("%-24s %8.1f ns  lower_bound %2.1f ns%s\n", "next_geq",
+         T * 1e9 / Queries, Base * 1e9 / Queries,
+         Sum == Expected ? "" : "  MISMATCH");
+
+  Base = benchmarkBestOf(3, [&] {
+    Expected = 0;
+    for (uint64_t P : Postings)
+      Expected += P;
+  });
+  T = benchmarkBestOf(3, [&] {
+    Sum = 0;
+    for (uint64_t V : Seq)
+      Sum += V;
+  });
+  printf("%-24s %8.2f ns  array %8.2f ns%s\n", "iterate", T * 1e9 / N,
+         Base * 1e9 / N, Sum == Expected ? "" : "  MISMATCH");
+}
@@ -0,0 +1,111 @@
+//
+//  Benchmark.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef Benchmark_hpp
+#define Benchmark_hpp
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+/// Minimal wall-clock timer for the micro benchmarks.
+class BenchmarkTimer {
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point Start = Clock::now();
+
+public:
+  void reset() { Start = Clock::now(); }
+
+  /// Seconds elapsed since construction or the last reset().
+  double seconds() const {
+    return std::chrono::duration<double>(Clock::now() - Start).count();
+  }
+};
+
+/// Runs \p Body \p Iterations times and returns the best (lowest) time of a
+/// single iteration, which is the least noisy figure for throughput numbers.
+template <typename Fn>
+double benchmarkBestOf(unsigned Iterations, Fn &&Body) {
+  double Best = 1e300;
+  for (unsigned i = 0; i < Iterations; ++i) {
+    BenchmarkTimer Timer;
+    Body();
+    double T = Timer.seconds();
+    if (T < Best)
+      Best = T;
+  }
+  return Best;
+}
+
+/// Prints one result line: name, GB/s and speedup over \p Baseline seconds.
+inline void reportThroughput(const char *Name, size_t Bytes, double Seconds,
+                             double Baseline) {
+  printf("%-24s %8.2f GB/s  x%.2f\n", Name, Bytes / Seconds / 1e9,
+         Baseline / Seconds);
+}
+
+/// tesseract::BitVector bulk logical operations, one line per kernel set.
+void RunBitOpsBenchmark();
+
+/// NBitVector: out = (a & b) | (c & ~d) as in-place passes against one
+/// fused BitExpr pass, with and without the popcount of the result.
+void RunBitExprBenchmark();
+
+/// ParallelBitOps on 1 Gbit vectors at 1 to MaxThreads threads, by default
+/// hardware_concurrency.
+void RunParallelBitOpsBenchmark(unsigned MaxThreads = 0);
+
+/// GCBitset atomic marking at 1-64 threads: the fetch_or SetBit against the
+/// former CAS loop, then the work-stealing GCParallelMarker on a random graph.
+void RunGCBitsetMarkBenchmark();
+
+/// A region-by-region GCBitset sweep, live bytes and reusable free runs, with
+/// the word-at-a-time range queries against TestBit loops, then in parallel
+/// across regions.
+void RunGCBitsetSweepBenchmark();
+
+/// Probe throughput of a classic Bloom filter, one cache line per probe,
+/// against BlockedBloomFilter one key at a time and in batches.
+void RunBloomFilterBenchmark();
+
+/// AtomicBitVector against a mutex-guarded NBitVector at 1-64 threads: a
+/// shared visited set, also with snapshots enabled, then claiming every bit
+/// once for work distribution.
+void RunAtomicBitVectorBenchmark();
+
+/// BitMatrix closure, product and transpose on a 4096-node random graph,
+/// against Warshall over per-row NBitVectors and bit-at-a-time loops.
+void RunBitMatrixBenchmark();
+
+/// EWAHBitVector binary operations and counts on run-heavy 64M-bit vectors,
+/// against the same operations on the uncompressed NBitVectors.
+void RunEWAHBenchmark();
+
+/// ChunkedBitVector snapshots against copying an NBitVector at every
+/// checkpoint, with the copy-on-write cost and dirty chunks per checkpoint.
+void RunChunkedBitVectorBenchmark();
+
+/// Moving tesseract::BitVectors into a growing std::vector against copying
+/// them, and short-lived NBitVectors on a per-request arena allocator against
+/// the default heap allocator.
+void RunBitVectorStorageBenchmark();
+
+/// Jaccard similarity of a query against a fingerprint database, fused
+/// (jaccard, jaccard_many) against building A & B and A | B and counting them.
+void RunBitSimilarityBenchmark();
+
+/// EliasFanoSequence memory, access, next_geq and iteration on a posting
+/// list, against the same list as a plain uint64_t array.
+void RunEliasFanoBenchmark();
+
+/// Every bitset flavour (BitVector, NBitVector, tesseract::BitVector,
+/// BitArray, BitSet, WordBitSet, GCBitset) on the same workloads, as CSV rows
+/// of type, workload, bits, ops, ns/op, GB/s and bytes/bit on stdout.
+/// Arguments: [--iterations N] [substring of "type/workload" to run].
+int RunBenchmarkSuite(int argc, const char *argv[]);
+
+#endif /* Benchmark_hpp */
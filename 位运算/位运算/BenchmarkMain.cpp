@@ -0,0 +1,14 @@
+//
+//  BenchmarkMain.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "Benchmark.hpp"
+
+// Entry point of the standalone bitset_bench tool of the CMake build. The
+// Xcode target runs the same suite as `位运算 suite`.
+int main(int argc, const char *argv[]) {
+  return RunBenchmarkSuite(argc - 1, argv + 1);
+}
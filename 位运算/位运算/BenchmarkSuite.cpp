@@ -0,0 +1,364 @@
+//
+//  BenchmarkSuite.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "Benchmark.hpp"
+#include "BitSet.hpp"
+#include "BitVector.hpp"
+#include "GCBitset.hpp"
+#include "HierarchicalBitVector.hpp"
+#include "MBitArray.hpp"
+#include "NBitVector.hpp"
+#include "TBitVector.hpp"
+#include "WordBitSet.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Every bitset flavour of the repository runs the same workloads through a
+// small adapter. An adapter only exposes the verbs its flavour really has, so
+// a workload the flavour cannot do is skipped instead of being emulated on
+// top of the single-bit accessors, which would only measure the emulation.
+
+namespace {
+
+/// Bits per vector: 128 KiB, so the workloads measure the bitset code out of
+/// L2 rather than DRAM.
+constexpr size_t SuiteBits = size_t(1) << 20;
+
+/// Random indices for the random set/test workloads.
+constexpr size_t SuiteRandomOps = size_t(1) << 20;
+
+/// Traffic of one timed run of the bandwidth workloads.
+constexpr size_t SuiteMinRunBytes = size_t(16) << 20;
+
+volatile size_t SuiteSink;
+
+struct SuiteOptions {
+  unsigned Iterations = 5;
+  const char *Filter = nullptr;
+};
+
+/// SuiteReporter - Prints the CSV rows of one flavour.
+class SuiteReporter {
+  const SuiteOptions &Opts;
+  const char *Type;
+  size_t NumBits;
+  size_t Footprint;
+
+public:
+  SuiteReporter(const SuiteOptions &Opts, const char *Type, size_t NumBits,
+                size_t Footprint)
+      : Opts(Opts), Type(Type), NumBits(NumBits), Footprint(Footprint) {}
+
+  /// Whether "type/workload" matches the filter.
+  bool selected(const char *Workload) const {
+    if (!Opts.Filter)
+      return true;
+    char Name[128];
+    snprintf(Name, sizeof(Name), "%s/%s", Type, Workload);
+    return strstr(Name, Opts.Filter) != nullptr;
+  }
+
+  /// Runs Body best-of Iterations and prints the row. Ops is the number of
+  /// operations of one call of Body, Bytes its memory traffic, 0 for
+  /// latency-bound workloads that have no meaningful bandwidth. Short bodies
+  /// are called repeatedly per timed run to stay well above timer resolution.
+  template <typename Fn>
+  void run(const char *Workload, size_t Ops, size_t Bytes, Fn &&Body) {
+    if (!selected(Workload))
+      return;
+    size_t Repeat = std::max<size_t>(1, SuiteMinRunBytes / std::max<size_t>(Bytes, 1));
+    if (!Bytes)
+      Repeat = 1;
+    double T = benchmarkBestOf(Opts.Iterations, [&] {
+      for (size_t i = 0; i < Repeat; ++i)
+        Body();
+    }) / Repeat;
+    printf("%s,%s,%zu,%zu,%.3f,", Type, Workload, NumBits, Ops, T * 1e9 / Ops);
+    if (Bytes)
+      printf("%.3f", Bytes / T / 1e9);
+    printf(",%.4f\n", double(Footprint) / NumBits);
+  }
+};
+
+struct HermesBitVectorFlavour {
+  static constexpr const char *Name = "BitVector";
+  static constexpr size_t NumBits = SuiteBits;
+  BitVector V{unsigned(NumBits)};
+
+  void set(size_t I) { V.set(unsigned(I)); }
+  bool test(size_t I) const { return V.test(unsigned(I)); }
+  void clear() { V.reset(); }
+  size_t count() const { return V.count(); }
+  void resize(size_t N) { V.resize(unsigned(N)); }
+  void copyFrom(const HermesBitVectorFlavour &O) { V = O.V; }
+  size_t footprint() const { return sizeof(V) + V.getMemorySize(); }
+};
+
+struct NBitVectorFlavour {
+  static constexpr const char *Name = "NBitVector";
+  static constexpr size_t NumBits = SuiteBits;
+  NBitVector V{unsigned(NumBits)};
+
+  void set(size_t I) { V.set(unsigned(I)); }
+  bool test(size_t I) const { return V.test(unsigned(I)); }
+  void clear() { V.reset(); }
+  size_t count() const { return V.count(); }
+  template <typename F> void findEach(F &&Fn) const {
+    for (int I = V.find_first(); I != -1; I = V.find_next(unsigned(I)))
+      Fn(size_t(I));
+  }
+  void andWith(const NBitVectorFlavour &O) { V &= O.V; }
+  void orWith(const NBitVectorFlavour &O) { V |= O.V; }
+  void xorWith(const NBitVectorFlavour &O) { V ^= O.V; }
+  void resize(size_t N) { V.resize(unsigned(N)); }
+  void copyFrom(const NBitVectorFlavour &O) { V = O.V; }
+  size_t footprint() const { return sizeof(V) + V.getMemorySize(); }
+};
+
+struct HierarchicalBitVectorFlavour {
+  static constexpr const char *Name = "HierarchicalBitVector";
+  static constexpr size_t NumBits = SuiteBits;
+  HierarchicalBitVector V{unsigned(NumBits)};
+
+  void set(size_t I) { V.set(unsigned(I)); }
+  bool test(size_t I) const { return V.test(unsigned(I)); }
+  void clear() { V.reset(); }
+  size_t count() const { return V.count(); }
+  /// find_first/find_next like NBitVector, rather than for_each_set_bit, so
+  /// the two searches compare directly.
+  template <typename F> void findEach(F &&Fn) const {
+    for (int I = V.find_first(); I != -1; I = V.find_next(unsigned(I)))
+      Fn(size_t(I));
+  }
+  void copyFrom(const HierarchicalBitVectorFlavour &O) { V = O.V; }
+  size_t footprint() const { return sizeof(V) + V.getMemorySize(); }
+};
+
+struct TesseractFlavour {
+  static constexpr const char *Name = "tesseract::BitVector";
+  static constexpr size_t NumBits = SuiteBits;
+  tesseract::BitVector V{int(NumBits)};
+
+  void set(size_t I) { V.SetBit(int(I)); }
+  bool test(size_t I) const { return V.At(int(I)); }
+  void clear() { V.SetAllFalse(); }
+  size_t count() const { return size_t(V.NumSetBits()); }
+  template <typename F> void findEach(F &&Fn) const {
+    for (int I = V.NextSetBit(-1); I >= 0; I = V.NextSetBit(I))
+      Fn(size_t(I));
+  }
+  void andWith(const TesseractFlavour &O) { V &= O.V; }
+  void orWith(const TesseractFlavour &O) { V |= O.V; }
+  void xorWith(const TesseractFlavour &O) { V ^= O.V; }
+  void copyFrom(const TesseractFlavour &O) { V = O.V; }
+  size_t footprint() const {
+    return sizeof(V) + (size_t(V.size()) + 31) / 32 * sizeof(uint32_t);
+  }
+};
+
+struct BitArrayFlavour {
+  static constexpr const char *Name = "BitArray";
+  static constexpr size_t NumBits = SuiteBits;
+  BitArray<NumBits> V;
+
+  void set(size_t I) { V.set(I); }
+  bool test(size_t I) const { return V.get(I); }
+  void clear() { V.clear(false); }
+  /// No find-next: forEachSetBit is how a BitArray is scanned.
+  template <typename F> void findEach(F &&Fn) const { V.forEachSetBit(Fn); }
+  void copyFrom(const BitArrayFlavour &O) { V = O.V; }
+  size_t footprint() const { return sizeof(V); }
+};
+
+struct BitSetFlavour {
+  static constexpr const char *Name = "BitSet";
+  static constexpr size_t NumBits = SuiteBits;
+  BitSet<NumBits> V;
+
+  void set(size_t I) { V.set(I); }
+  bool test(size_t I) const { return V.get(I); }
+  void clear() { V.clearAll(); }
+  size_t count() const { return V.count(); }
+  template <typename F> void findEach(F &&Fn) const {
+    for (size_t I = V.findBit(0, true); I < NumBits; I = V.findBit(I + 1, true))
+      Fn(I);
+  }
+  void andWith(const BitSetFlavour &O) { V &= O.V; }
+  void orWith(const BitSetFlavour &O) { V |= O.V; }
+  void xorWith(const BitSetFlavour &O) { V ^= O.V; }
+  void copyFrom(const BitSetFlavour &O) { V = O.V; }
+  size_t footprint() const { return sizeof(V); }
+};
+
+struct WordBitSetFlavour {
+  static constexpr const char *Name = "WordBitSet";
+  static constexpr size_t NumBits = 64;
+  WordBitSet<uint64_t> V;
+
+  void set(size_t I) { V.set(unsigned(I)); }
+  bool test(size_t I) const { return V.at(unsigned(I)); }
+  void clear() { V = WordBitSet<uint64_t>(); }
+  void copyFrom(const WordBitSetFlavour &O) { V = O.V; }
+  size_t footprint() const { return sizeof(V); }
+};
+
+struct GCBitsetFlavour {
+  static constexpr const char *Name = "GCBitset";
+  static constexpr size_t NumBits = SuiteBits;
+  /// GCBitset sizes are in bytes; the bitset is laid over caller memory.
+  static constexpr size_t NumBytes = NumBits / CHAR_BIT;
+  std::vector<GCBitset::GCBitsetWord> Storage = std::vector<GCBitset::GCBitsetWord>(
+      NumBits / GCBitset::BIT_PER_WORD);
+
+  GCBitset *get() { return reinterpret_cast<GCBitset *>(Storage.data()); }
+  const GCBitset *get() const {
+    return reinterpret_cast<const GCBitset *>(Storage.data());
+  }
+
+  void set(size_t I) { get()->SetBit(I); }
+  bool test(size_t I) const { return get()->TestBit(I); }
+  void clear() { get()->Clear(NumBytes); }
+  template <typename F> void findEach(F &&Fn) const {
+    get()->IterateSetBits(NumBytes, Fn);
+  }
+  /// A GCBitset is plain memory; bitmaps are copied with memcpy.
+  void copyFrom(const GCBitsetFlavour &O) {
+    memcpy(Storage.data(), O.Storage.data(), NumBytes);
+  }
+  size_t footprint() const { return NumBytes; }
+};
+
+/// Clears V and sets each bit with probability 1/OneIn, the same bits for
+/// every flavour.
+template <typename A> void fillRandom(A &V, unsigned OneIn, uint32_t Seed) {
+  std::mt19937 Rng(Seed);
+  V.clear();
+  for (size_t I = 0; I < A::NumBits; ++I)
+    if (Rng() % OneIn == 0)
+      V.set(I);
+}
+
+template <typename A>
+void runFlavour(const SuiteOptions &Opts, const std::vector<uint32_t> &Random) {
+  // The flavours with inline storage are too large for the stack.
+  std::unique_ptr<A> V = std::make_unique<A>();
+  std::unique_ptr<A> W = std::make_unique<A>();
+  SuiteReporter R(Opts, A::Name, A::NumBits, V->footprint());
+  // Bytes of bit data, the traffic of one pass over a vector.
+  const size_t DataBytes = (A::NumBits + CHAR_BIT - 1) / CHAR_BIT;
+  static_assert((A::NumBits & (A::NumBits - 1)) == 0, "Indices are masked");
+  const size_t Mask = A::NumBits - 1;
+
+  R.run("random_set", Random.size(), 0, [&] {
+    for (uint32_t I : Random)
+      V->set(I & Mask);
+  });
+  R.run("random_test", Random.size(), 0, [&] {
+    size_t Hits = 0;
+    for (uint32_t I : Random)
+      Hits += V->test(I & Mask);
+    SuiteSink = Hits;
+  });
+
+  // Small flavours loop over their bits until SuiteBits sets are done.
+  const size_t Rounds = SuiteBits / A::NumBits;
+  R.run("sequential_set", Rounds * A::NumBits, Rounds * DataBytes, [&] {
+    V->clear();
+    for (size_t Round = 0; Round < Rounds; ++Round)
+      for (size_t I = 0; I < A::NumBits; ++I)
+        V->set(I);
+    SuiteSink = V->test(0);
+  });
+
+  if constexpr (requires(const A &X) { X.findEach([](size_t) {}); }) {
+    const struct {
+      const char *Workload;
+      unsigned OneIn;
+    } Densities[] = {{"find_next_very_sparse", 65536},
+                     {"find_next_sparse", 1024},
+                     {"find_next_dense", 2}};
+    for (const auto &D : Densities) {
+      if (!R.selected(D.Workload))
+        continue;
+      fillRandom(*V, D.OneIn, 1);
+      size_t Found = 0;
+      V->findEach([&](size_t) { ++Found; });
+      R.run(D.Workload, Found ? Found : 1, DataBytes, [&] {
+        size_t Sum = 0;
+        V->findEach([&](size_t I) { Sum += I; });
+        SuiteSink = Sum;
+      });
+    }
+  }
+
+  if constexpr (requires(const A &X) { X.count(); }) {
+    fillRandom(*V, 2, 1);
+    R.run("popcount", 1, DataBytes, [&] { SuiteSink = V->count(); });
+  }
+
+  if constexpr (requires(A &X, const A &Y) { X.andWith(Y); }) {
+    fillRandom(*V, 2, 1);
+    fillRandom(*W, 2, 2);
+    // Two loads and one store per word.
+    R.run("and", 1, 3 * DataBytes, [&] { V->andWith(*W); });
+    R.run("or", 1, 3 * DataBytes, [&] { V->orWith(*W); });
+    R.run("xor", 1, 3 * DataBytes, [&] { V->xorWith(*W); });
+  }
+
+  if constexpr (requires(A &X) { X.resize(size_t()); }) {
+    // Shrink to half and grow back, which clears the regained half.
+    R.run("resize", 2, DataBytes / 2, [&] {
+      V->resize(A::NumBits / 2);
+      V->resize(A::NumBits);
+    });
+  }
+
+  fillRandom(*W, 2, 2);
+  R.run("copy", 1, 2 * DataBytes, [&] {
+    V->copyFrom(*W);
+    SuiteSink = V->test(0);
+  });
+}
+
+} // end anonymous namespace
+
+int RunBenchmarkSuite(int argc, const char *argv[]) {
+  SuiteOptions Opts;
+  for (int i = 0; i < argc; ++i) {
+    if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      Opts.Iterations = unsigned(std::max(1, atoi(argv[++i])));
+    } else if (argv[i][0] == '-') {
+      fprintf(stderr, "usage: [--iterations N] [type/workload filter]\n");
+      return 1;
+    } else {
+      Opts.Filter = argv[i];
+    }
+  }
+
+  std::mt19937 Rng(42);
+  std::vector<uint32_t> Random(SuiteRandomOps);
+  for (uint32_t &I : Random)
+    I = Rng();
+
+  printf("type,workload,bits,ops,ns_per_op,gb_per_s,bytes_per_bit\n");
+  runFlavour<HermesBitVectorFlavour>(Opts, Random);
+  runFlavour<NBitVectorFlavour>(Opts, Random);
+  runFlavour<HierarchicalBitVectorFlavour>(Opts, Random);
+  runFlavour<TesseractFlavour>(Opts, Random);
+  runFlavour<BitArrayFlavour>(Opts, Random);
+  runFlavour<BitSetFlavour>(Opts, Random);
+  runFlavour<WordBitSetFlavour>(Opts, Random);
+  runFlavour<GCBitsetFlavour>(Opts, Random);
+  return 0;
+}
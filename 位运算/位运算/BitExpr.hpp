@@ -0,0 +1,226 @@
+//
+//  BitExpr.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef BitExpr_hpp
+#define BitExpr_hpp
+
+#include "NBitVector.hpp"
+#include "TBitVector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <type_traits>
+
+// Fused boolean expressions over same-length bit vectors.
+//
+//   ((bitExpr(A) & bitExpr(B)) | (bitExpr(C) & ~bitExpr(D))).assignTo(Out);
+//
+// builds a small expression tree of word readers and evaluates it in a
+// single pass: each word of every operand is loaded once, combined in
+// registers and stored once to Out, with no temporaries. A chain of in-place
+// operations would stream the destination through memory once per operator.
+//
+// Evaluation runs in blocks of BitExprBlockWords words, so that the popcount
+// of assignAndCount() reads each block back from L1 while the fused loop
+// itself stays free of the popcount and vectorizes.
+//
+// The destination may be one of the operands: word i is only written after
+// all operands' word i have been read.
+
+/// Words per evaluation block, 4 KiB with 64-bit words.
+enum { BitExprBlockWords = 512 };
+
+template <typename Derived> class BitExpr;
+
+/// Stores Expr into Dst, block by block. Returns the popcount of the result
+/// if CountOnes is set, 0 otherwise.
+template <typename Derived>
+size_t evaluateBitExpr(typename Derived::word_type *Dst,
+                       const BitExpr<Derived> &Expr, bool CountOnes);
+
+/// BitExpr - CRTP base of all expression nodes, so that the operators below
+/// only apply to expressions.
+template <typename Derived> class BitExpr {
+public:
+  const Derived &derived() const { return static_cast<const Derived &>(*this); }
+
+  /// Number of bits of the expression.
+  size_t size() const { return derived().size(); }
+
+  /// assignTo - Dst = *this. Dst is resized to size() if needed.
+  void assignTo(NBitVector &Dst) const {
+    prepare(Dst);
+    evaluateBitExpr(Dst.getData(), *this, false);
+  }
+  void assignTo(tesseract::BitVector &Dst) const {
+    prepare(Dst);
+    evaluateBitExpr(Dst.data(), *this, false);
+  }
+
+  /// assignAndCount - Dst = *this, returning the number of set bits of the
+  /// result, computed in the same pass.
+  size_t assignAndCount(NBitVector &Dst) const {
+    prepare(Dst);
+    return evaluateBitExpr(Dst.getData(), *this, true);
+  }
+  size_t assignAndCount(tesseract::BitVector &Dst) const {
+    prepare(Dst);
+    return evaluateBitExpr(Dst.data(), *this, true);
+  }
+
+  /// count - Number of set bits of the expression, without storing it.
+  size_t count() const {
+    typedef typename Derived::word_type WordT;
+    constexpr size_t WordBits = sizeof(WordT) * CHAR_BIT;
+    const Derived &E = derived();
+    size_t NumBits = E.size();
+    size_t FullWords = NumBits / WordBits;
+    size_t Ones = 0;
+    for (size_t i = 0; i < FullWords; ++i)
+      Ones += std::popcount(E.word(i));
+    if (size_t Rem = NumBits % WordBits)
+      Ones += std::popcount(WordT(E.word(FullWords) & (WordT(-1) >> (WordBits - Rem))));
+    return Ones;
+  }
+
+private:
+  void prepare(NBitVector &Dst) const {
+    static_assert(std::is_same<typename Derived::word_type,
+                               NBitVector::BitWord>::value,
+                  "Operands and destination must share the word type");
+    if (Dst.size() != size())
+      Dst.resize(unsigned(size()));
+  }
+  void prepare(tesseract::BitVector &Dst) const {
+    static_assert(std::is_same<typename Derived::word_type, uint32_t>::value,
+                  "Operands and destination must share the word type");
+    if (size_t(Dst.size()) != size())
+      Dst.Init(int(size()));
+  }
+};
+
+/// BitExprOperand - A leaf: the words of one bit vector.
+template <typename WordT>
+class BitExprOperand : public BitExpr<BitExprOperand<WordT>> {
+  const WordT *Words;
+  size_t NumBits;
+
+public:
+  typedef WordT word_type;
+
+  BitExprOperand(const WordT *Words, size_t NumBits)
+      : Words(Words), NumBits(NumBits) {}
+
+  size_t size() const { return NumBits; }
+  WordT word(size_t I) const { return Words[I]; }
+};
+
+/// BitExprBinary - Op applied word by word to two sub-expressions. Nodes are
+/// held by value; leaves are a pointer and a size, so the tree is cheap to
+/// copy and is fully inlined into the evaluation loop.
+template <typename OpT, typename LHST, typename RHST>
+class BitExprBinary : public BitExpr<BitExprBinary<OpT, LHST, RHST>> {
+  LHST LHS;
+  RHST RHS;
+
+public:
+  typedef typename LHST::word_type word_type;
+  static_assert(std::is_same<word_type, typename RHST::word_type>::value,
+                "Operands must share the word type");
+
+  BitExprBinary(const LHST &LHS, const RHST &RHS) : LHS(LHS), RHS(RHS) {
+    assert(LHS.size() == RHS.size() && "Operands must have the same size");
+  }
+
+  size_t size() const { return LHS.size(); }
+  word_type word(size_t I) const { return OpT::apply(LHS.word(I), RHS.word(I)); }
+};
+
+/// BitExprNot - The complement of a sub-expression. Bits past size() come
+/// out set and are masked off when the result is stored or counted.
+template <typename ExprT> class BitExprNot : public BitExpr<BitExprNot<ExprT>> {
+  ExprT Expr;
+
+public:
+  typedef typename ExprT::word_type word_type;
+
+  explicit BitExprNot(const ExprT &Expr) : Expr(Expr) {}
+
+  size_t size() const { return Expr.size(); }
+  word_type word(size_t I) const { return word_type(~Expr.word(I)); }
+};
+
+struct BitExprAndOp {
+  template <typename W> static W apply(W L, W R) { return L & R; }
+};
+struct BitExprOrOp {
+  template <typename W> static W apply(W L, W R) { return L | R; }
+};
+struct BitExprXorOp {
+  template <typename W> static W apply(W L, W R) { return L ^ R; }
+};
+
+template <typename L, typename R>
+BitExprBinary<BitExprAndOp, L, R> operator&(const BitExpr<L> &LHS,
+                                            const BitExpr<R> &RHS) {
+  return BitExprBinary<BitExprAndOp, L, R>(LHS.derived(), RHS.derived());
+}
+
+template <typename L, typename R>
+BitExprBinary<BitExprOrOp, L, R> operator|(const BitExpr<L> &LHS,
+                                           const BitExpr<R> &RHS) {
+  return BitExprBinary<BitExprOrOp, L, R>(LHS.derived(), RHS.derived());
+}
+
+template <typename L, typename R>
+BitExprBinary<BitExprXorOp, L, R> operator^(const BitExpr<L> &LHS,
+                                            const BitExpr<R> &RHS) {
+  return BitExprBinary<BitExprXorOp, L, R>(LHS.derived(), RHS.derived());
+}
+
+template <typename E> BitExprNot<E> operator~(const BitExpr<E> &Expr) {
+  return BitExprNot<E>(Expr.derived());
+}
+
+/// bitExpr - Wrap a bit vector as an expression operand. The vector must
+/// outlive the expression and keep its size until it is evaluated.
+inline BitExprOperand<NBitVector::BitWord> bitExpr(const NBitVector &V) {
+  return BitExprOperand<NBitVector::BitWord>(V.getData(), V.size());
+}
+
+inline BitExprOperand<uint32_t> bitExpr(const tesseract::BitVector &V) {
+  return BitExprOperand<uint32_t>(V.data(), size_t(V.size()));
+}
+
+template <typename Derived>
+size_t evaluateBitExpr(typename Derived::word_type *Dst,
+                       const BitExpr<Derived> &Expr, bool CountOnes) {
+  typedef typename Derived::word_type WordT;
+  constexpr size_t WordBits = sizeof(WordT) * CHAR_BIT;
+  const Derived &E = Expr.derived();
+  size_t NumBits = E.size();
+  size_t NumWords = (NumBits + WordBits - 1) / WordBits;
+  size_t Ones = 0;
+  for (size_t Begin = 0; Begin < NumWords; Begin += BitExprBlockWords) {
+    size_t End = std::min<size_t>(NumWords, Begin + BitExprBlockWords);
+    for (size_t i = Begin; i < End; ++i)
+      Dst[i] = E.word(i);
+    // Keep the bits past the end clear, as the vectors expect.
+    if (End == NumWords && NumBits % WordBits)
+      Dst[End - 1] &= WordT(-1) >> (WordBits - NumBits % WordBits);
+    if (CountOnes) {
+      for (size_t i = Begin; i < End; ++i)
+        Ones += std::popcount(Dst[i]);
+    }
+  }
+  return Ones;
+}
+
+#endif /* BitExpr_hpp */
@@ -0,0 +1,196 @@
+//
+//  BitMatrix.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "BitMatrix.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+static_assert(sizeof(BitMatrix::BitWord) == sizeof(uint64_t),
+              "The 64x64 tiles assume 64-bit words");
+
+namespace {
+
+/// Dst |= Src over N words. The loop is left to the vectorizer.
+inline void orWords(BitMatrix::BitWord *__restrict Dst,
+                    const BitMatrix::BitWord *__restrict Src, unsigned N) {
+  for (unsigned i = 0; i < N; ++i)
+    Dst[i] |= Src[i];
+}
+
+} // end anonymous namespace
+
+BitMatrix::BitMatrix(unsigned Rows, unsigned Cols)
+    : NumRows(Rows), NumCols(Cols),
+      WordsPerRow((NumBitWords(Cols) + RowAlignWords - 1) / RowAlignWords *
+                  RowAlignWords) {
+  size_t Words = size_t(NumRows) * WordsPerRow;
+  if (Words) {
+    Bits.reset(static_cast<BitWord *>(
+        ::operator new[](Words * sizeof(BitWord), std::align_val_t(64))));
+    memset(Bits.get(), 0, Words * sizeof(BitWord));
+  }
+}
+
+BitMatrix::BitMatrix(const BitMatrix &RHS) : BitMatrix(RHS.NumRows, RHS.NumCols) {
+  if (Bits)
+    memcpy(Bits.get(), RHS.Bits.get(),
+           size_t(NumRows) * WordsPerRow * sizeof(BitWord));
+}
+
+BitMatrix &BitMatrix::operator=(const BitMatrix &RHS) {
+  if (this != &RHS)
+    *this = BitMatrix(RHS);
+  return *this;
+}
+
+void BitMatrix::row_or(unsigned Dst, unsigned Src) {
+  if (Dst != Src)
+    orWords(getRowData(Dst), getRowData(Src), NumBitWords(NumCols));
+}
+
+void BitMatrix::row_or(unsigned Dst, const NBitVector &V) {
+  assert(V.size() == NumCols && "Row length mismatch");
+  orWords(getRowData(Dst), V.getData(), NumBitWords(NumCols));
+}
+
+NBitVector BitMatrix::getRow(unsigned R) const {
+  NBitVector Result(NumCols);
+  memcpy(Result.getData(), getRowData(R), NumBitWords(NumCols) * sizeof(BitWord));
+  return Result;
+}
+
+void BitMatrix::setRow(unsigned R, const NBitVector &V) {
+  assert(V.size() == NumCols && "Row length mismatch");
+  memcpy(getRowData(R), V.getData(), NumBitWords(NumCols) * sizeof(BitWord));
+}
+
+NBitVector BitMatrix::get_column(unsigned C) const {
+  assert(C < NumCols && "Column out of range");
+  NBitVector Result(NumRows);
+  BitWord *Out = Result.getData();
+  const BitWord *In = Bits.get() + C / BITWORD_SIZE;
+  unsigned Shift = C % BITWORD_SIZE;
+  for (unsigned R = 0; R < NumRows; ++R, In += WordsPerRow)
+    Out[R / BITWORD_SIZE] |= ((*In >> Shift) & 1) << (R % BITWORD_SIZE);
+  return Result;
+}
+
+size_t BitMatrix::count() const {
+  size_t Ones = 0;
+  for (size_t i = 0, e = size_t(NumRows) * WordsPerRow; i < e; ++i)
+    Ones += std::popcount(Bits[i]);
+  return Ones;
+}
+
+bool BitMatrix::operator==(const BitMatrix &RHS) const {
+  return NumRows == RHS.NumRows && NumCols == RHS.NumCols &&
+         (!Bits || memcmp(Bits.get(), RHS.Bits.get(),
+                          size_t(NumRows) * WordsPerRow * sizeof(BitWord)) == 0);
+}
+
+void BitMatrix::transpose64(uint64_t Block[64]) {
+  // Swap the off-diagonal 32x32 quadrants, then the 16x16 quadrants of each
+  // quadrant, and so on. Each round is a masked swap between words k and
+  // k + J on all 32 word pairs at once, which the compiler turns into SIMD
+  // shifts and blends.
+  uint64_t Mask = 0x00000000FFFFFFFFULL;
+  for (unsigned J = 32; J; J >>= 1, Mask ^= Mask << J) {
+    for (unsigned k = 0; k < 64; k = ((k | J) + 1) & ~J) {
+      uint64_t T = ((Block[k] >> J) ^ Block[k | J]) & Mask;
+      Block[k | J] ^= T;
+      Block[k] ^= T << J;
+    }
+  }
+}
+
+BitMatrix BitMatrix::transpose() const {
+  BitMatrix Result(NumCols, NumRows);
+  alignas(64) uint64_t Block[64];
+  for (unsigned RB = 0; RB < NumRows; RB += 64) {
+    unsigned TileRows = std::min(64u, NumRows - RB);
+    for (unsigned CW = 0; CW < NumBitWords(NumCols); ++CW) {
+      for (unsigned i = 0; i < 64; ++i)
+        Block[i] = i < TileRows ? getRowData(RB + i)[CW] : 0;
+      transpose64(Block);
+      unsigned TileCols = std::min(64u, NumCols - CW * 64);
+      for (unsigned j = 0; j < TileCols; ++j)
+        Result.getRowData(CW * 64 + j)[RB / 64] = Block[j];
+    }
+  }
+  return Result;
+}
+
+void BitMatrix::fourRussiansStep(const BitMatrix &Src, const BitMatrix &RHS,
+                                 unsigned Begin, BitMatrix &Dst,
+                                 BitWord *Table) {
+  const unsigned W = NumBitWords(RHS.NumCols);
+  const unsigned Rows = std::min<unsigned>(StepRows, RHS.NumRows - Begin);
+  BitWord *Tables[StepTables];
+
+  // Tables[g][s] = OR of the rows Begin + 8g + i of RHS for the bits i of s,
+  // each entry one row OR away from an entry built before it.
+  for (unsigned G = 0; G < StepTables; ++G) {
+    Tables[G] = Table + size_t(G) * 256 * W;
+    memset(Tables[G], 0, W * sizeof(BitWord));
+    unsigned First = G * 8;
+    unsigned Group = First < Rows ? std::min(8u, Rows - First) : 0;
+    for (unsigned S = 1; S < (1u << Group); ++S) {
+      BitWord *Entry = Tables[G] + size_t(S) * W;
+      memcpy(Entry, Tables[G] + size_t(S & (S - 1)) * W, W * sizeof(BitWord));
+      orWords(Entry, RHS.getRowData(Begin + First + std::countr_zero(S)), W);
+    }
+  }
+
+  // Begin is a multiple of StepRows, so the selecting bits of a row lie in
+  // one word. Columns past Rows are zero and select the empty entries.
+  const unsigned Word = Begin / BITWORD_SIZE, Shift = Begin % BITWORD_SIZE;
+  for (unsigned R = 0; R < Src.NumRows; ++R) {
+    uint32_t Sel = uint32_t(Src.getRowData(R)[Word] >> Shift);
+    if (!Sel)
+      continue;
+    const BitWord *T0 = Tables[0] + size_t(Sel & 0xFF) * W;
+    const BitWord *T1 = Tables[1] + size_t((Sel >> 8) & 0xFF) * W;
+    const BitWord *T2 = Tables[2] + size_t((Sel >> 16) & 0xFF) * W;
+    const BitWord *T3 = Tables[3] + size_t(Sel >> 24) * W;
+    BitWord *Out = Dst.getRowData(R);
+    for (unsigned i = 0; i < W; ++i)
+      Out[i] |= T0[i] | T1[i] | T2[i] | T3[i];
+  }
+}
+
+BitMatrix BitMatrix::multiply(const BitMatrix &RHS) const {
+  assert(NumCols == RHS.NumRows && "Inner dimensions differ");
+  BitMatrix Result(NumRows, RHS.NumCols);
+  if (!NumRows || !RHS.NumCols)
+    return Result;
+  std::vector<BitWord> Table(size_t(StepTables) * 256 * NumBitWords(RHS.NumCols));
+  for (unsigned Begin = 0; Begin < NumCols; Begin += StepRows)
+    fourRussiansStep(*this, RHS, Begin, Result, Table.data());
+  return Result;
+}
+
+void BitMatrix::transitive_closure() {
+  assert(NumRows == NumCols && "Closure needs a square matrix");
+  if (!NumRows)
+    return;
+  std::vector<BitWord> Table(size_t(StepTables) * 256 * NumBitWords(NumCols));
+  // Warshall's algorithm, StepRows intermediate nodes at a time. Running it
+  // on the rows of the step first makes each of them final for those
+  // intermediates; every row then only needs the OR of the final step rows
+  // its own bits in the step select, which is one lookup per table.
+  for (unsigned Begin = 0; Begin < NumRows; Begin += StepRows) {
+    unsigned End = std::min<unsigned>(Begin + StepRows, NumRows);
+    for (unsigned K = Begin; K < End; ++K)
+      for (unsigned I = Begin; I < End; ++I)
+        if (I != K && test(I, K))
+          row_or(I, K);
+    fourRussiansStep(*this, *this, Begin, *this, Table.data());
+  }
+}
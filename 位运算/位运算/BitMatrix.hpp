@@ -0,0 +1,144 @@
+//
+//  BitMatrix.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef BitMatrix_hpp
+#define BitMatrix_hpp
+
+#include "NBitVector.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+/// BitMatrix - A dense boolean matrix, e.g. the adjacency or reachability
+/// relation of a graph, with one bit row per node.
+///
+/// All rows live in one 64-byte-aligned allocation, and each row is padded
+/// to a whole number of cache lines, so that row operations run on aligned,
+/// contiguous words and no two rows share a line. Bits past cols() in a row
+/// are kept zero.
+///
+/// transpose() works on 64x64 tiles, each transposed in registers with six
+/// rounds of masked swaps. multiply() and transitive_closure() use the
+/// "Method of Four Russians": the rows are taken 32 at a time, as four
+/// 256-entry tables of the ORs of each eight of them, so that every row of
+/// the result costs one pass ORing four table entries per 32 columns instead
+/// of one row OR per set bit.
+class BitMatrix {
+public:
+  typedef NBitVector::BitWord BitWord;
+
+  enum {
+    BITWORD_SIZE = (unsigned)sizeof(BitWord) * CHAR_BIT,
+    /// Row alignment, in words.
+    RowAlignWords = 64 / sizeof(BitWord)
+  };
+
+private:
+  struct AlignedDelete {
+    void operator()(BitWord *P) const {
+      ::operator delete[](P, std::align_val_t(64));
+    }
+  };
+
+  std::unique_ptr<BitWord[], AlignedDelete> Bits;
+  unsigned NumRows = 0;
+  unsigned NumCols = 0;
+  unsigned WordsPerRow = 0;
+
+  static unsigned NumBitWords(unsigned S) {
+    return (S + BITWORD_SIZE - 1) / BITWORD_SIZE;
+  }
+
+  /// Rows of RHS combined per step of multiply() and transitive_closure(),
+  /// as StepTables tables of 256 entries.
+  enum { StepRows = 32, StepTables = StepRows / 8 };
+
+  /// OR-accumulates rows Begin..Begin+StepRows-1 of RHS, as selected by the
+  /// bits of each row of Src at columns Begin.., into the same row of Dst.
+  /// Table has room for StepTables * 256 rows of RHS.
+  static void fourRussiansStep(const BitMatrix &Src, const BitMatrix &RHS,
+                               unsigned Begin, BitMatrix &Dst, BitWord *Table);
+
+public:
+  BitMatrix() = default;
+
+  /// Creates a Rows x Cols matrix of zeros.
+  BitMatrix(unsigned Rows, unsigned Cols);
+
+  BitMatrix(const BitMatrix &RHS);
+  BitMatrix(BitMatrix &&RHS) = default;
+  BitMatrix &operator=(const BitMatrix &RHS);
+  BitMatrix &operator=(BitMatrix &&RHS) = default;
+
+  unsigned rows() const { return NumRows; }
+  unsigned cols() const { return NumCols; }
+  /// Words between the starts of two consecutive rows.
+  unsigned getWordsPerRow() const { return WordsPerRow; }
+
+  BitWord *getRowData(unsigned R) {
+    assert(R < NumRows && "Row out of range");
+    return Bits.get() + size_t(R) * WordsPerRow;
+  }
+  const BitWord *getRowData(unsigned R) const {
+    assert(R < NumRows && "Row out of range");
+    return Bits.get() + size_t(R) * WordsPerRow;
+  }
+
+  bool test(unsigned R, unsigned C) const {
+    assert(C < NumCols && "Column out of range");
+    return (getRowData(R)[C / BITWORD_SIZE] >> (C % BITWORD_SIZE)) & 1;
+  }
+  void set(unsigned R, unsigned C) {
+    assert(C < NumCols && "Column out of range");
+    getRowData(R)[C / BITWORD_SIZE] |= BitWord(1) << (C % BITWORD_SIZE);
+  }
+  void reset(unsigned R, unsigned C) {
+    assert(C < NumCols && "Column out of range");
+    getRowData(R)[C / BITWORD_SIZE] &= ~(BitWord(1) << (C % BITWORD_SIZE));
+  }
+
+  /// row_or - Row Dst |= row Src.
+  void row_or(unsigned Dst, unsigned Src);
+  /// row_or - Row Dst |= V, V having cols() bits.
+  void row_or(unsigned Dst, const NBitVector &V);
+
+  /// Returns row R as a bit vector of cols() bits.
+  NBitVector getRow(unsigned R) const;
+  /// Replaces row R by V, which must have cols() bits.
+  void setRow(unsigned R, const NBitVector &V);
+
+  /// get_column - Returns column C as a bit vector of rows() bits. Reads one
+  /// word of every row; to extract many columns, transpose() once instead.
+  NBitVector get_column(unsigned C) const;
+
+  /// Number of set bits.
+  size_t count() const;
+
+  bool operator==(const BitMatrix &RHS) const;
+  bool operator!=(const BitMatrix &RHS) const { return !(*this == RHS); }
+
+  /// transpose - Returns the cols() x rows() transpose.
+  BitMatrix transpose() const;
+
+  /// multiply - Returns the boolean product *this x RHS: bit (i, j) is set
+  /// iff some k has (i, k) set here and (k, j) set in RHS. Requires
+  /// cols() == RHS.rows().
+  BitMatrix multiply(const BitMatrix &RHS) const;
+
+  /// transitive_closure - Replaces a square matrix by its transitive closure:
+  /// afterwards (i, j) is set iff there is a path of one or more edges from i
+  /// to j. Set the diagonal first for the reflexive closure.
+  void transitive_closure();
+
+  /// transpose64 - Transposes the 64x64 bit block Block in place: bit j of
+  /// word i moves to bit i of word j.
+  static void transpose64(uint64_t Block[64]);
+};
+
+#endif /* BitMatrix_hpp */
@@ -11,10 +11,14 @@
 // JSC
 
 #include <array>
+#include <bit>
 #include <stdio.h>
 #include <string.h>
 #include <type_traits>
 #include <cstdint>
+#include <utility>
+
+#include "SetBitIterator.hpp"
 
 #if !defined(ALWAYS_INLINE)
 #define ALWAYS_INLINE inline
@@ -22,6 +26,12 @@
 
 #define CPU(WTF_FEATURE) (defined WTF_CPU_##WTF_FEATURE  && WTF_CPU_##WTF_FEATURE)
 
+// Normally set by WTF's Platform.h. Without it every set would use 32-bit
+// words on 64-bit targets.
+#if !defined(WTF_CPU_REGISTER64) && (defined(__LP64__) || defined(_WIN64))
+#define WTF_CPU_REGISTER64 1
+#endif
+
 #if CPU(REGISTER64)
 using CPURegister = int64_t;
 using UCPURegister = uint64_t;
@@ -34,6 +44,28 @@ using UCPURegister = uint32_t;
 template<size_t size>
 using BitSetWordType = std::conditional_t<(size <= 32 && sizeof(UCPURegister) > sizeof(uint32_t)), uint32_t, UCPURegister>;
 
+// Searches word for the first bit equal to value, starting at
+// startOrResultIndex. On success stores the bit's index in
+// startOrResultIndex and returns true; otherwise stores endIndex.
+template<typename T>
+constexpr bool findBitInWord(T word, size_t& startOrResultIndex, size_t endIndex, bool value)
+{
+  static_assert(std::is_unsigned<T>::value, "Type used in findBitInWord must be unsigned");
+  size_t index = startOrResultIndex;
+  if (index < sizeof(T) * 8) {
+    // Turn the wanted value into ones, then count the zeros below it.
+    word = static_cast<T>(word >> index);
+    word ^= static_cast<T>(static_cast<T>(value) - 1);
+    index += std::countr_zero(word);
+    if (index < endIndex) {
+      startOrResultIndex = index;
+      return true;
+    }
+  }
+  startOrResultIndex = endIndex;
+  return false;
+}
+
 template<size_t bitSetSize, typename PassedWordType = BitSetWordType<bitSetSize>>
 class BitSet final {
 
@@ -47,21 +79,73 @@ public:
     return bitSetSize;
   }
 
+  constexpr bool get(size_t) const;
+  constexpr bool test(size_t n) const { return get(n); }
+
   constexpr void set(size_t);
   constexpr void set(size_t, bool);
   constexpr void clear(size_t);
   constexpr void clearAll();
   constexpr void setAll();
-  
+
+  // Returns the previous value of the bit.
+  constexpr bool testAndSet(size_t);
+  constexpr bool testAndClear(size_t);
+
+  constexpr void invert();
+  constexpr void merge(const BitSet&);    // this |= other
+  constexpr void filter(const BitSet&);   // this &= other
+  constexpr void exclude(const BitSet&);  // this &= ~other
+
+  // Returns true if every bit set in other is also set in this.
+  constexpr bool subsumes(const BitSet&) const;
+
+  constexpr bool isEmpty() const;
+  constexpr size_t count() const;
+
+  // Returns the index of the first bit at or after startIndex equal to
+  // value, or size() if there is none.
   constexpr size_t findBit(size_t startIndex, bool value) const;
-  
-  
+
+  template<typename Func>
+  ALWAYS_INLINE constexpr void forEachSetBit(const Func&) const;
+
+  // Iterates over the indices of the set bits.
+  using iterator = SetBitIterator<WordType>;
+  iterator begin() const { return iterator(bits.data(), bitSetSize); }
+  iterator end() const { return iterator(); }
+
+  constexpr unsigned hash() const;
+
+  constexpr bool operator==(const BitSet&) const;
+  constexpr bool operator!=(const BitSet& other) const { return !(*this == other); }
+
+  constexpr BitSet& operator|=(const BitSet& other) { merge(other); return *this; }
+  constexpr BitSet& operator&=(const BitSet& other) { filter(other); return *this; }
+  constexpr BitSet& operator^=(const BitSet&);
+  constexpr BitSet& operator<<=(size_t);
+  constexpr BitSet& operator>>=(size_t);
+
+  constexpr BitSet operator|(const BitSet& other) const { BitSet result = *this; return result |= other; }
+  constexpr BitSet operator&(const BitSet& other) const { BitSet result = *this; return result &= other; }
+  constexpr BitSet operator^(const BitSet& other) const { BitSet result = *this; return result ^= other; }
+  constexpr BitSet operator<<(size_t n) const { BitSet result = *this; return result <<= n; }
+  constexpr BitSet operator>>(size_t n) const { BitSet result = *this; return result >>= n; }
+  constexpr BitSet operator~() const { BitSet result = *this; result.invert(); return result; }
+
 private:
-  
-  void cleanseLastWord();
-  
+
+  constexpr void cleanseLastWord();
+
+  // Calls func(i) for every word index. Small sets are unrolled completely,
+  // so they stay in registers; larger ones get a plain loop with a constant
+  // trip count, which the compiler vectorizes.
+  template<typename Func>
+  ALWAYS_INLINE static constexpr void forEachWord(const Func&);
+
   static constexpr unsigned wordSize = sizeof(WordType) * 8;
   static constexpr unsigned words = (bitSetSize + wordSize - 1) / wordSize;
+  static constexpr size_t maxUnrolledBits = 256;
 
   // the literal '1' is of type signed int.  We want to use an unsigned
   // version of the correct size when doing the calculations because if
@@ -71,9 +155,27 @@ private:
   static constexpr WordType one = 1;
 
   std::array<WordType, words> bits { };
-  
+
 };
 
+template<size_t bitSetSize, typename WordType>
+template<typename Func>
+ALWAYS_INLINE constexpr void BitSet<bitSetSize, WordType>::forEachWord(const Func& func) {
+  if constexpr (words * wordSize <= maxUnrolledBits) {
+    [&]<size_t... i>(std::index_sequence<i...>) {
+      (func(i), ...);
+    }(std::make_index_sequence<words>());
+  } else {
+    for (size_t i = 0; i < words; ++i)
+      func(i);
+  }
+}
+
+template<size_t bitSetSize, typename WordType>
+ALWAYS_INLINE constexpr bool BitSet<bitSetSize, WordType>::get(size_t n) const {
+  return !!(bits[n / wordSize] & (one << (n % wordSize)));
+}
+
 template<size_t bitSetSize, typename WordType>
 ALWAYS_INLINE constexpr void BitSet<bitSetSize, WordType>::set(size_t n) {
     bits[n / wordSize] |= (one << (n % wordSize));
@@ -92,13 +194,27 @@ inline constexpr void BitSet<bitSetSize, WordType>::clear(size_t n) {
   bits[n / wordSize] &= ~(one << (n % wordSize));
 }
 
+template<size_t bitSetSize, typename WordType>
+inline constexpr bool BitSet<bitSetSize, WordType>::testAndSet(size_t n) {
+  bool previousValue = get(n);
+  set(n);
+  return previousValue;
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr bool BitSet<bitSetSize, WordType>::testAndClear(size_t n) {
+  bool previousValue = get(n);
+  clear(n);
+  return previousValue;
+}
+
 template<size_t bitSetSize, typename WordType>
 inline constexpr void BitSet<bitSetSize, WordType>::clearAll() {
-  memset(bits.data(), 0, sizeof(bits));
+  forEachWord([&](size_t i) { bits[i] = 0; });
 }
 
 template<size_t bitSetSize, typename WordType>
-inline void BitSet<bitSetSize, WordType>::cleanseLastWord() {
+inline constexpr void BitSet<bitSetSize, WordType>::cleanseLastWord() {
   if constexpr (!!(bitSetSize % wordSize)) {
     constexpr size_t remainingBits = bitSetSize % wordSize;
     constexpr WordType mask = (static_cast<WordType>(1) << remainingBits) - 1;
@@ -108,29 +224,151 @@ inline void BitSet<bitSetSize, WordType>::cleanseLastWord() {
 
 template<size_t bitSetSize, typename WordType>
 inline constexpr void BitSet<bitSetSize, WordType>::setAll() {
-  memset(bits.data(), 0xFF, sizeof(bits));
+  forEachWord([&](size_t i) { bits[i] = ~static_cast<WordType>(0); });
   cleanseLastWord();
 }
 
+template<size_t bitSetSize, typename WordType>
+inline constexpr void BitSet<bitSetSize, WordType>::invert() {
+  forEachWord([&](size_t i) { bits[i] = ~bits[i]; });
+  cleanseLastWord();
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr void BitSet<bitSetSize, WordType>::merge(const BitSet& other) {
+  forEachWord([&](size_t i) { bits[i] |= other.bits[i]; });
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr void BitSet<bitSetSize, WordType>::filter(const BitSet& other) {
+  forEachWord([&](size_t i) { bits[i] &= other.bits[i]; });
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr void BitSet<bitSetSize, WordType>::exclude(const BitSet& other) {
+  forEachWord([&](size_t i) { bits[i] &= ~other.bits[i]; });
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr auto BitSet<bitSetSize, WordType>::operator^=(const BitSet& other) -> BitSet& {
+  forEachWord([&](size_t i) { bits[i] ^= other.bits[i]; });
+  return *this;
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr bool BitSet<bitSetSize, WordType>::subsumes(const BitSet& other) const {
+  // No early exit: the combined word is tested once, so small sets compile
+  // to straight-line code.
+  WordType missing = 0;
+  forEachWord([&](size_t i) { missing |= other.bits[i] & ~bits[i]; });
+  return !missing;
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr bool BitSet<bitSetSize, WordType>::isEmpty() const {
+  WordType any = 0;
+  forEachWord([&](size_t i) { any |= bits[i]; });
+  return !any;
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr size_t BitSet<bitSetSize, WordType>::count() const {
+  size_t result = 0;
+  forEachWord([&](size_t i) { result += std::popcount(bits[i]); });
+  return result;
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr bool BitSet<bitSetSize, WordType>::operator==(const BitSet& other) const {
+  WordType difference = 0;
+  forEachWord([&](size_t i) { difference |= bits[i] ^ other.bits[i]; });
+  return !difference;
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr unsigned BitSet<bitSetSize, WordType>::hash() const {
+  uint64_t result = 0;
+  forEachWord([&](size_t i) {
+    result = (result ^ static_cast<uint64_t>(bits[i])) * 0x9e3779b97f4a7c15ULL;
+    result ^= result >> 29;
+  });
+  return static_cast<unsigned>(result ^ (result >> 32));
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr auto BitSet<bitSetSize, WordType>::operator<<=(size_t n) -> BitSet& {
+  if (n >= bitSetSize) {
+    clearAll();
+    return *this;
+  }
+  size_t wordShift = n / wordSize;
+  size_t bitShift = n % wordSize;
+  // Walk downwards so every source word is read before it is overwritten.
+  for (size_t i = words; i-- > 0;) {
+    WordType word = 0;
+    if (i >= wordShift) {
+      word = bits[i - wordShift] << bitShift;
+      if (bitShift && i > wordShift)
+        word |= bits[i - wordShift - 1] >> (wordSize - bitShift);
+    }
+    bits[i] = word;
+  }
+  cleanseLastWord();
+  return *this;
+}
+
+template<size_t bitSetSize, typename WordType>
+inline constexpr auto BitSet<bitSetSize, WordType>::operator>>=(size_t n) -> BitSet& {
+  if (n >= bitSetSize) {
+    clearAll();
+    return *this;
+  }
+  size_t wordShift = n / wordSize;
+  size_t bitShift = n % wordSize;
+  for (size_t i = 0; i < words; ++i) {
+    WordType word = 0;
+    if (i + wordShift < words) {
+      word = bits[i + wordShift] >> bitShift;
+      if (bitShift && i + wordShift + 1 < words)
+        word |= bits[i + wordShift + 1] << (wordSize - bitShift);
+    }
+    bits[i] = word;
+  }
+  return *this;
+}
+
 template<size_t bitSetSize, typename WordType>
 inline constexpr size_t BitSet<bitSetSize, WordType>::findBit(size_t startIndex, bool value) const {
   WordType skipValue = -(static_cast<WordType>(value) ^ 1);
   size_t wordIndex = startIndex / wordSize;
   size_t startIndexInWord = startIndex - wordIndex * wordSize;
-  
+
   while (wordIndex < words) {
     WordType word = bits[wordIndex];
     if (word != skipValue) {
       size_t index = startIndexInWord;
-      if (findBitInWord(word, index, wordSize, value))
-          return wordIndex * wordSize + index;
+      if (findBitInWord(word, index, wordSize, value)) {
+        // The unused bits of the last word are zero, so a search for an
+        // unset bit may land past the end.
+        size_t result = wordIndex * wordSize + index;
+        return result < bitSetSize ? result : bitSetSize;
+      }
     }
-    
+
     wordIndex++;
     startIndexInWord = 0;
   }
-  
+
   return bitSetSize;
 }
 
+template<size_t bitSetSize, typename WordType>
+template<typename Func>
+ALWAYS_INLINE constexpr void BitSet<bitSetSize, WordType>::forEachSetBit(const Func& func) const {
+  forEachWord([&](size_t i) {
+    for (WordType word = bits[i]; word; word &= word - 1)
+      func(i * wordSize + std::countr_zero(word));
+  });
+}
+
 #endif /* BitSet_hpp */
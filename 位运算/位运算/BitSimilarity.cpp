@@ -0,0 +1,158 @@
+//
+//  BitSimilarity.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "BitSimilarity.hpp"
+#include "BitVectorKernels.hpp"
+
+#include <algorithm>
+
+using namespace tesseract;
+
+namespace {
+
+/// The words of a vector as the uint32_t array the kernels take. Popcounts
+/// do not depend on the word size, so NBitVector's 64-bit words are simply
+/// read as twice as many halves.
+struct WordSpan {
+  const uint32_t *P;
+  int N;
+};
+
+WordSpan words(const NBitVector &V) {
+  return {reinterpret_cast<const uint32_t *>(V.getData()),
+          int(V.getNumWords() * (sizeof(NBitVector::BitWord) / sizeof(uint32_t)))};
+}
+
+WordSpan words(const tesseract::BitVector &V) {
+  return {V.data(), (V.size() + 31) / 32};
+}
+
+/// The fused count kernels selected by SIMDDetect.
+const BitCountKernels &counts() {
+  return *BitCounts.load(std::memory_order_acquire);
+}
+
+/// Set bits of the words of A past the end of B, if A is the longer one.
+int64_t countPast(WordSpan A, WordSpan B) {
+  return A.N > B.N
+             ? PopCount.load(std::memory_order_acquire)(A.P + B.N, A.N - B.N)
+             : 0;
+}
+
+size_t andCount(WordSpan A, WordSpan B) {
+  return size_t(counts().And(A.P, B.P, std::min(A.N, B.N)));
+}
+
+size_t orCount(WordSpan A, WordSpan B) {
+  return size_t(counts().Or(A.P, B.P, std::min(A.N, B.N)) + countPast(A, B) +
+                countPast(B, A));
+}
+
+size_t xorCount(WordSpan A, WordSpan B) {
+  return size_t(counts().Xor(A.P, B.P, std::min(A.N, B.N)) +
+                countPast(A, B) + countPast(B, A));
+}
+
+size_t andNotCount(WordSpan A, WordSpan B) {
+  return size_t(counts().AndNot(A.P, B.P, std::min(A.N, B.N)) +
+                countPast(A, B));
+}
+
+double jaccard(WordSpan A, WordSpan B) {
+  int64_t And, Or;
+  counts().AndOr(A.P, B.P, std::min(A.N, B.N), &And, &Or);
+  Or += countPast(A, B) + countPast(B, A);
+  return Or ? double(And) / double(Or) : 1.0;
+}
+
+/// Prefetches the first few cache lines of the next candidate, enough for a
+/// typical 1-2 Kbit fingerprint to be in flight while the current one is
+/// counted.
+void prefetchWords(WordSpan V) {
+  const char *P = reinterpret_cast<const char *>(V.P);
+  size_t Bytes = std::min<size_t>(size_t(V.N) * sizeof(uint32_t), 256);
+  for (size_t Offset = 0; Offset < Bytes; Offset += 64)
+    __builtin_prefetch(P + Offset);
+}
+
+template <typename VectorT, typename ResultT, typename CountFn>
+void countMany(const VectorT &Query, const VectorT *Candidates, size_t N,
+               ResultT *Out, CountFn Count) {
+  WordSpan Q = words(Query);
+  for (size_t i = 0; i < N; ++i) {
+    if (i + 1 < N)
+      prefetchWords(words(Candidates[i + 1]));
+    Out[i] = Count(Q, words(Candidates[i]));
+  }
+}
+
+} // end anonymous namespace
+
+size_t and_count(const NBitVector &A, const NBitVector &B) {
+  return andCount(words(A), words(B));
+}
+
+size_t or_count(const NBitVector &A, const NBitVector &B) {
+  return orCount(words(A), words(B));
+}
+
+size_t xor_count(const NBitVector &A, const NBitVector &B) {
+  return xorCount(words(A), words(B));
+}
+
+size_t andnot_count(const NBitVector &A, const NBitVector &B) {
+  return andNotCount(words(A), words(B));
+}
+
+double jaccard(const NBitVector &A, const NBitVector &B) {
+  return jaccard(words(A), words(B));
+}
+
+size_t and_count(const tesseract::BitVector &A, const tesseract::BitVector &B) {
+  return andCount(words(A), words(B));
+}
+
+size_t or_count(const tesseract::BitVector &A, const tesseract::BitVector &B) {
+  return orCount(words(A), words(B));
+}
+
+size_t xor_count(const tesseract::BitVector &A, const tesseract::BitVector &B) {
+  return xorCount(words(A), words(B));
+}
+
+size_t andnot_count(const tesseract::BitVector &A,
+                    const tesseract::BitVector &B) {
+  return andNotCount(words(A), words(B));
+}
+
+double jaccard(const tesseract::BitVector &A, const tesseract::BitVector &B) {
+  return jaccard(words(A), words(B));
+}
+
+void and_count_many(const NBitVector &Query, const NBitVector *Candidates,
+                    size_t N, size_t *Out) {
+  countMany(Query, Candidates, N, Out, andCount);
+}
+
+void jaccard_many(const NBitVector &Query, const NBitVector *Candidates,
+                  size_t N, double *Out) {
+  countMany(Query, Candidates, N, Out,
+            static_cast<double (*)(WordSpan, WordSpan)>(jaccard));
+}
+
+void and_count_many(const tesseract::BitVector &Query,
+                    const tesseract::BitVector *Candidates, size_t N,
+                    size_t *Out) {
+  countMany(Query, Candidates, N, Out, andCount);
+}
+
+void jaccard_many(const tesseract::BitVector &Query,
+                  const tesseract::BitVector *Candidates, size_t N,
+                  double *Out) {
+  countMany(Query, Candidates, N, Out,
+            static_cast<double (*)(WordSpan, WordSpan)>(jaccard));
+}
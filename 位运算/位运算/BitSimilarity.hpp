@@ -0,0 +1,59 @@
+//
+//  BitSimilarity.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef BitSimilarity_hpp
+#define BitSimilarity_hpp
+
+#include "NBitVector.hpp"
+#include "TBitVector.hpp"
+
+#include <cstddef>
+
+// Intersection and union sizes and Jaccard (Tanimoto) similarity of two bit
+// vectors, e.g. molecular or document fingerprints, without building A op B.
+//
+// Each call streams both vectors once through the fused tesseract::BitCounts
+// kernels selected by SIMDDetect, instead of copying one vector, combining
+// it in place and counting the result. Vectors of different sizes compare as
+// if the shorter one were padded with zeros.
+
+/// and_count - Returns the number of set bits of A & B.
+size_t and_count(const NBitVector &A, const NBitVector &B);
+/// or_count - Returns the number of set bits of A | B.
+size_t or_count(const NBitVector &A, const NBitVector &B);
+/// xor_count - Returns the number of set bits of A ^ B, i.e. the Hamming
+/// distance.
+size_t xor_count(const NBitVector &A, const NBitVector &B);
+/// andnot_count - Returns the number of set bits of A & ~B.
+size_t andnot_count(const NBitVector &A, const NBitVector &B);
+/// jaccard - Returns |A & B| / |A | B|, or 1 if both are empty. Both counts
+/// come from the same pass.
+double jaccard(const NBitVector &A, const NBitVector &B);
+
+size_t and_count(const tesseract::BitVector &A, const tesseract::BitVector &B);
+size_t or_count(const tesseract::BitVector &A, const tesseract::BitVector &B);
+size_t xor_count(const tesseract::BitVector &A, const tesseract::BitVector &B);
+size_t andnot_count(const tesseract::BitVector &A,
+                    const tesseract::BitVector &B);
+double jaccard(const tesseract::BitVector &A, const tesseract::BitVector &B);
+
+/// One-vs-many scans, e.g. a nearest-neighbour search of a fingerprint
+/// database: Out[i] = and_count(Query, Candidates[i]) or jaccard(Query,
+/// Candidates[i]) for N candidates. The next candidate is prefetched while
+/// the current one is counted.
+void and_count_many(const NBitVector &Query, const NBitVector *Candidates,
+                    size_t N, size_t *Out);
+void jaccard_many(const NBitVector &Query, const NBitVector *Candidates,
+                  size_t N, double *Out);
+void and_count_many(const tesseract::BitVector &Query,
+                    const tesseract::BitVector *Candidates, size_t N,
+                    size_t *Out);
+void jaccard_many(const tesseract::BitVector &Query,
+                  const tesseract::BitVector *Candidates, size_t N,
+                  double *Out);
+
+#endif /* BitSimilarity_hpp */
@@ -8,40 +8,98 @@
 #ifndef BitVector_hpp
 #define BitVector_hpp
 
+#include "AlignedAllocator.hpp"
+
 #include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <utility>
+#include <vector>
 
 // Hermes 0.5
 
-class BitVector {
+/// BasicBitVector - The bit vector, with its words allocated by AllocatorT
+/// (rebound to BitWord); cache-line aligned by default.
+template <typename AllocatorT = AlignedAllocator<unsigned long>>
+class BasicBitVector {
   typedef unsigned long BitWord;
   
   enum { BITWORD_SIZE = (unsigned)sizeof(BitWord) * CHAR_BIT };
   
   static_assert(BITWORD_SIZE == 64 || BITWORD_SIZE == 32,
                 "Unsupported word size");
-  
-  std::vector<BitWord> Bits; // Actual bits.
+
+public:
+  typedef typename std::allocator_traits<AllocatorT>::template rebind_alloc<
+      BitWord>
+      allocator_type;
+
+private:
+  typedef std::vector<BitWord, allocator_type> WordVector;
+
+  WordVector Bits; // Actual bits.
   unsigned Size;                 // Size of bitvector in bits.
   
 public:
   typedef unsigned size_type;
   
-  BitVector() : Size(0) {}
-  
-  ~BitVector() { std::free(Bits.data()); }
+  BasicBitVector() : Size(0) {}
+
+  /// BitVector ctor - Creates a bitvector of specified number of bits. All
+  /// bits are initialized to the specified value.
+  explicit BasicBitVector(unsigned s, bool t = false,
+                          const allocator_type &A = allocator_type())
+      : Bits(NumBitWords(s), 0 - (BitWord)t, A), Size(s) {
+    if (t)
+      clear_unused_bits();
+  }
+
+  // The words are owned by Bits; the implicit destructor releases them.
+  BasicBitVector(const BasicBitVector &RHS) = default;
+  BasicBitVector &operator=(const BasicBitVector &RHS) = default;
+
+  /// Moves take the words of RHS without allocating and leave it empty.
+  BasicBitVector(BasicBitVector &&RHS) noexcept
+      : Bits(std::move(RHS.Bits)), Size(RHS.Size) {
+    RHS.Size = 0;
+  }
+
+  BasicBitVector &operator=(BasicBitVector &&RHS) noexcept(
+      std::allocator_traits<allocator_type>::
+          propagate_on_container_move_assignment::value ||
+      std::allocator_traits<allocator_type>::is_always_equal::value) {
+    if (this != &RHS) {
+      Bits = std::move(RHS.Bits);
+      Size = RHS.Size;
+      RHS.Bits.clear();
+      RHS.Size = 0;
+    }
+    return *this;
+  }
+
+  allocator_type get_allocator() const { return Bits.get_allocator(); }
   
   bool empty() const { return Size == 0; }
   
   /// size - Returns the number of bits in this bitvector.
   size_type size() const { return Size; }
+
+  /// count - Returns the number of bits which are set.
+  size_type count() const {
+    unsigned NumBits = 0;
+    for (BitWord W : Bits)
+      NumBits += __builtin_popcountl(W);
+    return NumBits;
+  }
+
+  /// getMemorySize - Bytes of heap storage held by the vector.
+  size_t getMemorySize() const { return Bits.size() * sizeof(BitWord); }
   
-  void init_words(std::vector<BitWord> B, bool t) {
+  void init_words(WordVector &B, bool t) {
     if (B.size() > 0)
       memset(B.data(), 0 - (int)t, B.size() * sizeof(BitWord));
   }
@@ -74,31 +132,47 @@ public:
     set_unused_bits(false);
   }
   
-  BitVector &reset() {
+  BasicBitVector &reset() {
     init_words(Bits, false);
     return *this;
   }
 
-  BitVector &reset(unsigned Idx) {
+  BasicBitVector &reset(unsigned Idx) {
     Bits[Idx / BITWORD_SIZE] &= ~(BitWord(1) << (Idx % BITWORD_SIZE));
     return *this;
   }
   
   // Set, reset, flip
-  BitVector &set() {
+  BasicBitVector &set() {
     init_words(Bits, true);
     clear_unused_bits();
     return *this;
   }
 
-  BitVector &set(unsigned Idx) {
+  BasicBitVector &set(unsigned Idx) {
     assert(Bits.data() && "Bits never allocated");
     Bits[Idx / BITWORD_SIZE] |= BitWord(1) << (Idx % BITWORD_SIZE);
     return *this;
   }
-  
-  
-  
+
+  bool test(unsigned Idx) const {
+    assert(Idx < Size && "Out-of-bounds Bit access.");
+    return (Bits[Idx / BITWORD_SIZE] & (BitWord(1) << (Idx % BITWORD_SIZE))) != 0;
+  }
+
+  bool operator[](unsigned Idx) const { return test(Idx); }
+
+  /// resize - Grow or shrink the bitvector.
+  void resize(unsigned N, bool t = false) {
+    unsigned OldSize = Size;
+    Size = N;
+    if (t && OldSize % BITWORD_SIZE)
+      Bits[OldSize / BITWORD_SIZE] |= ~BitWord(0) << (OldSize % BITWORD_SIZE);
+    Bits.resize(NumBitWords(N), 0 - (BitWord)t);
+    clear_unused_bits();
+  }
 };
 
+typedef BasicBitVector<> BitVector;
+
 #endif /* BitVector_hpp */
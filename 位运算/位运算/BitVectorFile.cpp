@@ -0,0 +1,495 @@
+//
+//  BitVectorFile.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "BitVectorFile.hpp"
+#include "TBitVector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const uint64_t PayloadAlign = 64;
+/// Size of the staging buffer used by the writer. A multiple of
+/// PayloadAlign.
+const size_t ChunkBytes = 64 * 1024;
+
+uint64_t alignTo(uint64_t Value, uint64_t Align) {
+  return (Value + Align - 1) / Align * Align;
+}
+
+uint64_t payloadBytesFor(uint64_t NumBits) {
+  return alignTo((NumBits + 7) / 8, PayloadAlign);
+}
+
+/// Four independent multiply-xorshift lanes, so the checksum runs at memory
+/// speed instead of being bound by one multiply chain. The lane of a word is
+/// its index modulo 4, so the payload can be fed in any chunks of whole
+/// words.
+class PayloadChecksum {
+  uint64_t Lanes[4] = {0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL,
+                       0x165667b19e3779f9ULL, 0x27d4eb2f165667c5ULL};
+  uint64_t NumWords = 0;
+
+  static uint64_t mix(uint64_t H, uint64_t W) {
+    H ^= W;
+    H *= 0xff51afd7ed558ccdULL;
+    return H ^ (H >> 32);
+  }
+
+public:
+  void update(const void *Data, size_t Bytes) {
+    assert(Bytes % 8 == 0 && "Checksum input must be whole words");
+    const uint8_t *P = static_cast<const uint8_t *>(Data);
+    size_t N = Bytes / 8, i = 0;
+    uint64_t W;
+    for (; i < N && NumWords % 4; ++i, ++NumWords) {
+      std::memcpy(&W, P + 8 * i, 8);
+      Lanes[NumWords % 4] = mix(Lanes[NumWords % 4], W);
+    }
+    for (; i + 4 <= N; i += 4, NumWords += 4) {
+      for (unsigned L = 0; L < 4; ++L) {
+        std::memcpy(&W, P + 8 * (i + L), 8);
+        Lanes[L] = mix(Lanes[L], W);
+      }
+    }
+    for (; i < N; ++i, ++NumWords) {
+      std::memcpy(&W, P + 8 * i, 8);
+      Lanes[NumWords % 4] = mix(Lanes[NumWords % 4], W);
+    }
+  }
+
+  uint64_t finish() const {
+    uint64_t H = NumWords;
+    for (uint64_t L : Lanes)
+      H = mix(H, L);
+    return H;
+  }
+};
+
+/// Calls Fn(Buffer, Bytes) for consecutive chunks of the padded payload of
+/// NumBits bits at Data, with the bits past NumBits cleared.
+template <typename Fn>
+bool forEachPayloadChunk(const void *Data, uint64_t NumBits, Fn &&F) {
+  static_assert(ChunkBytes % PayloadAlign == 0, "Chunks must keep alignment");
+  const uint8_t *Src = static_cast<const uint8_t *>(Data);
+  uint64_t DataBytes = (NumBits + 7) / 8;
+  uint64_t Total = payloadBytesFor(NumBits);
+  std::vector<uint8_t> Buffer(std::min<uint64_t>(ChunkBytes, Total));
+  for (uint64_t Pos = 0; Pos < Total; Pos += ChunkBytes) {
+    size_t Bytes = size_t(std::min<uint64_t>(ChunkBytes, Total - Pos));
+    size_t Copy = size_t(std::min<uint64_t>(Bytes, DataBytes - std::min(Pos, DataBytes)));
+    std::memcpy(Buffer.data(), Src + Pos, Copy);
+    std::memset(Buffer.data() + Copy, 0, Bytes - Copy);
+    if (Pos + Copy == DataBytes && Copy && NumBits % 8)
+      Buffer[Copy - 1] &= uint8_t((1u << (NumBits % 8)) - 1);
+    if (!F(Buffer.data(), Bytes))
+      return false;
+  }
+  return true;
+}
+
+/// Bytes of the index section of a record with an index: the block entries,
+/// then the samples padded to whole words.
+uint64_t indexSectionBytes(const BitVectorFileHeader &Header) {
+  return uint64_t(Header.RankBlocks) * sizeof(uint64_t) +
+         alignTo(uint64_t(Header.RankSamples) * sizeof(uint32_t), 8);
+}
+
+/// Adds the index section of Index, as writeBitVectorFile lays it out, to
+/// Sum.
+void updateIndexChecksum(PayloadChecksum &Sum, const RankSelectIndex &Index) {
+  Sum.update(Index.getBlockData(), Index.getNumBlocks() * sizeof(uint64_t));
+  const uint32_t *Samples = Index.getSampleData();
+  size_t NumSamples = Index.getNumSamples();
+  Sum.update(Samples, NumSamples / 2 * sizeof(uint64_t));
+  if (NumSamples % 2) {
+    uint64_t Last = Samples[NumSamples - 1];
+    Sum.update(&Last, sizeof(Last));
+  }
+}
+
+/// Returns true if the bits past NumBits are clear in the N payload bytes at
+/// Bytes, which start at byte Offset of the payload.
+bool payloadTailIsClear(const uint8_t *Bytes, uint64_t Offset, size_t N,
+                        uint64_t NumBits) {
+  uint64_t FirstByte = NumBits / 8;
+  for (size_t i = FirstByte > Offset ? size_t(FirstByte - Offset) : 0; i < N;
+       ++i) {
+    uint8_t Mask = Offset + i == FirstByte ? uint8_t(0xff << (NumBits % 8))
+                                           : uint8_t(0xff);
+    if (Bytes[i] & Mask)
+      return false;
+  }
+  return true;
+}
+
+/// Returns true if the bits of the last word past NumBits are clear, the same
+/// invariant an NBitVector keeps.
+bool tailIsClear(const NBitVector::BitWord *Words, uint64_t NumBits) {
+  if (NumBits % 64 == 0)
+    return true;
+  return (Words[NumBits / 64] >> (NumBits % 64)) == 0;
+}
+
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// BitVectorFileHeader
+//===----------------------------------------------------------------------===//
+
+uint64_t BitVectorFileHeader::getRecordSize() const {
+  if (!RankOffset)
+    return PayloadOffset + PayloadBytes;
+  return RankOffset + indexSectionBytes(*this);
+}
+
+bool BitVectorFileHeader::isValid(uint64_t FileSize) const {
+  if (Magic != MAGIC || Version != VERSION)
+    return false;
+  if (WordBits != 8 && WordBits != 16 && WordBits != 32 && WordBits != 64)
+    return false;
+  // Checked first, so none of the sums below can overflow.
+  if (NumBits / 8 > FileSize || NumOnes > NumBits)
+    return false;
+  if (PayloadOffset < sizeof(BitVectorFileHeader) ||
+      PayloadOffset % PayloadAlign || PayloadOffset > FileSize ||
+      PayloadBytes != payloadBytesFor(NumBits) ||
+      PayloadBytes > FileSize - PayloadOffset)
+    return false;
+  if (!RankOffset)
+    return true;
+  // The index stores 32-bit ranks.
+  if (NumBits > UINT_MAX || RankOffset % 8 ||
+      RankOffset < PayloadOffset + PayloadBytes || RankOffset > FileSize ||
+      RankBlocks != RankSelectIndex::getNumBlocksFor(NumBits) ||
+      RankSamples != RankSelectIndex::getNumSamplesFor(NumOnes))
+    return false;
+  return getRecordSize() <= FileSize;
+}
+
+uint64_t bitVectorChecksum(const void *Data, size_t Bytes) {
+  PayloadChecksum Sum;
+  Sum.update(Data, Bytes);
+  return Sum.finish();
+}
+
+//===----------------------------------------------------------------------===//
+// Reading and writing
+//===----------------------------------------------------------------------===//
+
+bool writeBitVectorFile(FILE *F, const void *Data, uint64_t NumBits,
+                        unsigned WordBits, const RankSelectIndex *Index) {
+  assert((WordBits == 8 || WordBits == 16 || WordBits == 32 ||
+          WordBits == 64) && "Unsupported word size");
+
+  // First pass: count and checksum, so the header can be written up front
+  // and F need not be seekable.
+  uint64_t NumOnes = 0;
+  PayloadChecksum Sum;
+  forEachPayloadChunk(Data, NumBits, [&](const uint8_t *Chunk, size_t Bytes) {
+    for (size_t i = 0; i < Bytes; i += 8) {
+      uint64_t W;
+      std::memcpy(&W, Chunk + i, 8);
+      NumOnes += std::popcount(W);
+    }
+    Sum.update(Chunk, Bytes);
+    return true;
+  });
+  if (Index)
+    updateIndexChecksum(Sum, *Index);
+
+  BitVectorFileHeader Header;
+  std::memset(&Header, 0, sizeof(Header));
+  Header.Magic = BitVectorFileHeader::MAGIC;
+  Header.Version = BitVectorFileHeader::VERSION;
+  Header.WordBits = uint16_t(WordBits);
+  Header.NumBits = NumBits;
+  Header.NumOnes = NumOnes;
+  Header.PayloadOffset = alignTo(sizeof(Header), PayloadAlign);
+  Header.PayloadBytes = payloadBytesFor(NumBits);
+  Header.Checksum = Sum.finish();
+  if (Index) {
+    assert(Index->count() == NumOnes &&
+           Index->getNumBlocks() == RankSelectIndex::getNumBlocksFor(NumBits) &&
+           "Index was not built over these bits");
+    Header.RankOffset = Header.PayloadOffset + Header.PayloadBytes;
+    Header.RankBlocks = uint32_t(Index->getNumBlocks());
+    Header.RankSamples = uint32_t(Index->getNumSamples());
+  }
+
+  static const uint8_t Zeros[PayloadAlign] = {};
+  if (fwrite(&Header, sizeof(Header), 1, F) != 1 ||
+      fwrite(Zeros, 1, Header.PayloadOffset - sizeof(Header), F) !=
+          Header.PayloadOffset - sizeof(Header))
+    return false;
+  bool OK = forEachPayloadChunk(Data, NumBits,
+                                [&](const uint8_t *Chunk, size_t Bytes) {
+    return fwrite(Chunk, 1, Bytes, F) == Bytes;
+  });
+  if (!OK)
+    return false;
+  if (Index) {
+    // An empty vector has no index arrays to write.
+    if ((Header.RankBlocks &&
+         fwrite(Index->getBlockData(), sizeof(uint64_t), Header.RankBlocks,
+                F) != Header.RankBlocks) ||
+        (Header.RankSamples &&
+         fwrite(Index->getSampleData(), sizeof(uint32_t), Header.RankSamples,
+                F) != Header.RankSamples) ||
+        (Header.RankSamples % 2 && fwrite(Zeros, sizeof(uint32_t), 1, F) != 1))
+      return false;
+  }
+  return true;
+}
+
+bool writeBitVectorFile(const char *Path, const NBitVector &V,
+                        const RankSelectIndex *Index) {
+  FILE *F = fopen(Path, "wb");
+  if (!F)
+    return false;
+  bool OK = writeBitVectorFile(F, V.getData(), V.size(),
+                               NBitVector::BITWORD_SIZE, Index);
+  return fclose(F) == 0 && OK;
+}
+
+bool readBitVectorHeader(FILE *F, BitVectorFileHeader &Header) {
+  if (fread(&Header, sizeof(Header), 1, F) != 1)
+    return false;
+  // A stream has no size to check against; only the header's own
+  // consistency is validated here, short reads catch the rest.
+  if (!Header.isValid(UINT64_MAX))
+    return false;
+  for (uint64_t Skip = Header.PayloadOffset - sizeof(Header); Skip; --Skip)
+    if (fgetc(F) == EOF)
+      return false;
+  return true;
+}
+
+bool readBitVectorPayload(FILE *F, const BitVectorFileHeader &Header,
+                          void *Data, size_t DataBytes) {
+  assert(DataBytes <= Header.PayloadBytes && "Data is past the payload");
+  uint8_t *Dst = static_cast<uint8_t *>(Data);
+  if ((DataBytes && fread(Dst, 1, DataBytes, F) != DataBytes) ||
+      !payloadTailIsClear(Dst, 0, DataBytes, Header.NumBits))
+    return false;
+  PayloadChecksum Sum;
+  size_t Whole = DataBytes / 8 * 8;
+  Sum.update(Dst, Whole);
+
+  // The rest of the payload goes through Buffer, after the partial word at
+  // the end of Data. Every chunk ends on a word, since the payload does.
+  std::vector<uint8_t> Buffer(ChunkBytes);
+  size_t Carry = DataBytes - Whole;
+  if (Carry)
+    std::memcpy(Buffer.data(), Dst + Whole, Carry);
+  uint64_t Pos = Whole;
+  for (uint64_t Left = Header.PayloadBytes - DataBytes; Carry || Left;) {
+    size_t N = size_t(std::min<uint64_t>(ChunkBytes - Carry, Left));
+    if (fread(Buffer.data() + Carry, 1, N, F) != N ||
+        !payloadTailIsClear(Buffer.data(), Pos, Carry + N, Header.NumBits))
+      return false;
+    Sum.update(Buffer.data(), Carry + N);
+    Pos += Carry + N;
+    Left -= N;
+    Carry = 0;
+  }
+
+  if (Header.RankOffset) {
+    for (uint64_t Gap = Header.RankOffset - Header.PayloadOffset -
+                        Header.PayloadBytes;
+         Gap;) {
+      size_t N = size_t(std::min<uint64_t>(ChunkBytes, Gap));
+      if (fread(Buffer.data(), 1, N, F) != N)
+        return false;
+      Gap -= N;
+    }
+    for (uint64_t Left = indexSectionBytes(Header); Left;) {
+      size_t N = size_t(std::min<uint64_t>(ChunkBytes, Left));
+      if (fread(Buffer.data(), 1, N, F) != N)
+        return false;
+      Sum.update(Buffer.data(), N);
+      Left -= N;
+    }
+  }
+  return Sum.finish() == Header.Checksum;
+}
+
+bool readBitVectorFile(const char *Path, NBitVector &V) {
+  FILE *F = fopen(Path, "rb");
+  if (!F)
+    return false;
+  BitVectorFileHeader Header;
+  bool OK = readBitVectorHeader(F, Header) && Header.NumBits <= UINT_MAX;
+  if (OK) {
+    NBitVector Result(unsigned(Header.NumBits));
+    OK = readBitVectorPayload(F, Header, Result.getData(),
+                              size_t(Result.getNumWords()) *
+                                  sizeof(NBitVector::BitWord));
+    if (OK)
+      V = std::move(Result);
+  }
+  fclose(F);
+  return OK;
+}
+
+bool tesseract::SerializeBitVector(FILE *fp, const uint32_t *words,
+                                   int bit_size) {
+  return writeBitVectorFile(fp, words, uint64_t(bit_size), 32);
+}
+
+bool tesseract::DeSerializeBitVector(FILE *fp,
+                                     uint32_t *(*alloc)(void *ctx,
+                                                        int bit_size),
+                                     void *ctx) {
+  BitVectorFileHeader Header;
+  if (!readBitVectorHeader(fp, Header) || Header.NumBits > INT32_MAX)
+    return false;
+  int BitSize = int(Header.NumBits);
+  uint32_t *Words = alloc(ctx, BitSize);
+  return readBitVectorPayload(fp, Header, Words,
+                              size_t((BitSize + 31) / 32) * sizeof(uint32_t));
+}
+
+//===----------------------------------------------------------------------===//
+// MappedBitVector
+//===----------------------------------------------------------------------===//
+
+bool MappedBitVector::open(const char *Path, bool VerifyChecksum) {
+  close();
+  int FD = ::open(Path, O_RDONLY);
+  if (FD < 0)
+    return false;
+  struct stat St;
+  if (fstat(FD, &St) != 0 || uint64_t(St.st_size) < sizeof(BitVectorFileHeader)) {
+    ::close(FD);
+    return false;
+  }
+  MapSize = size_t(St.st_size);
+  Map = mmap(nullptr, MapSize, PROT_READ, MAP_PRIVATE, FD, 0);
+  // The mapping keeps its own reference to the file.
+  ::close(FD);
+  if (Map == MAP_FAILED) {
+    Map = nullptr;
+    return false;
+  }
+
+  const uint8_t *Base = static_cast<const uint8_t *>(Map);
+  BitVectorFileHeader Header;
+  std::memcpy(&Header, Base, sizeof(Header));
+  Words = reinterpret_cast<const BitWord *>(Base + Header.PayloadOffset);
+  if (!Header.isValid(MapSize) || !tailIsClear(Words, Header.NumBits)) {
+    close();
+    return false;
+  }
+  Size = Header.NumBits;
+  NumOnes = Header.NumOnes;
+  NumWords = (Size + BITWORD_SIZE - 1) / BITWORD_SIZE;
+  Checksum = Header.Checksum;
+  if (Header.RankOffset) {
+    const uint64_t *BlockData =
+        reinterpret_cast<const uint64_t *>(Base + Header.RankOffset);
+    const uint32_t *SampleData =
+        reinterpret_cast<const uint32_t *>(BlockData + Header.RankBlocks);
+    if (!RankSelectIndex::isConsistent(unsigned(Size), unsigned(NumOnes),
+                                       BlockData, Header.RankBlocks,
+                                       SampleData, Header.RankSamples)) {
+      close();
+      return false;
+    }
+    IndexBytes = size_t(indexSectionBytes(Header));
+    Index.attach(Words, unsigned(Size), unsigned(NumOnes), BlockData,
+                 Header.RankBlocks, SampleData, Header.RankSamples);
+    HasIndex = true;
+  }
+  if (VerifyChecksum && !verify()) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void MappedBitVector::close() {
+  if (Map)
+    munmap(Map, MapSize);
+  Map = nullptr;
+  MapSize = 0;
+  Words = nullptr;
+  Size = NumOnes = NumWords = Checksum = 0;
+  IndexBytes = 0;
+  Index = RankSelectIndex();
+  HasIndex = false;
+}
+
+bool MappedBitVector::verify() const {
+  PayloadChecksum Sum;
+  Sum.update(Words, size_t(payloadBytesFor(Size)));
+  if (HasIndex)
+    Sum.update(Index.getBlockData(), IndexBytes);
+  return Sum.finish() == Checksum;
+}
+
+int64_t MappedBitVector::find_first_in(uint64_t Begin, uint64_t End) const {
+  assert(Begin <= End && End <= Size);
+  if (Begin == End)
+    return -1;
+
+  uint64_t FirstWord = Begin / BITWORD_SIZE;
+  uint64_t LastWord = (End - 1) / BITWORD_SIZE;
+  for (uint64_t i = FirstWord; i <= LastWord; ++i) {
+    BitWord Copy = Words[i];
+    if (i == FirstWord)
+      Copy &= maskTrailingZeros<BitWord>(Begin % BITWORD_SIZE);
+    if (i == LastWord)
+      Copy &= maskTrailingOnes<BitWord>((End - 1) % BITWORD_SIZE + 1);
+    if (Copy != 0)
+      return int64_t(i * BITWORD_SIZE + std::countr_zero(Copy));
+  }
+  return -1;
+}
+
+void MappedBitVector::andInto(NBitVector &Dst) const {
+  BitWord *D = Dst.getData();
+  uint64_t DstWords = Dst.getNumWords();
+  uint64_t Common = std::min(DstWords, NumWords);
+  for (uint64_t i = 0; i < Common; ++i)
+    D[i] &= Words[i];
+  for (uint64_t i = Common; i < DstWords; ++i)
+    D[i] = 0;
+}
+
+void MappedBitVector::orInto(NBitVector &Dst) const {
+  assert(Size <= UINT_MAX && "Mapped vector too large for an NBitVector");
+  if (Dst.size() < Size)
+    Dst.resize(unsigned(Size));
+  BitWord *D = Dst.getData();
+  for (uint64_t i = 0; i < NumWords; ++i)
+    D[i] |= Words[i];
+}
+
+void MappedBitVector::xorInto(NBitVector &Dst) const {
+  assert(Size <= UINT_MAX && "Mapped vector too large for an NBitVector");
+  if (Dst.size() < Size)
+    Dst.resize(unsigned(Size));
+  BitWord *D = Dst.getData();
+  for (uint64_t i = 0; i < NumWords; ++i)
+    D[i] ^= Words[i];
+}
+
+void MappedBitVector::resetIn(NBitVector &Dst) const {
+  BitWord *D = Dst.getData();
+  uint64_t Common = std::min<uint64_t>(Dst.getNumWords(), NumWords);
+  for (uint64_t i = 0; i < Common; ++i)
+    D[i] &= ~Words[i];
+}
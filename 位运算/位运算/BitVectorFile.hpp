@@ -0,0 +1,176 @@
+//
+//  BitVectorFile.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef BitVectorFile_hpp
+#define BitVectorFile_hpp
+
+#include "NBitVector.hpp"
+#include "RankSelect.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// On-disk bit vector format, version 1. All fields are little-endian.
+//
+//   [0, 64)                      BitVectorFileHeader
+//   [PayloadOffset, +PayloadBytes) the bits, little-endian by word, zero
+//                                padded to a multiple of 64 bytes
+//   [RankOffset, ...)            optional RankSelectIndex: RankBlocks uint64
+//                                block entries, then RankSamples uint32
+//                                select samples, zero padded to 8 bytes
+//
+// Because every word is stored little-endian, the byte layout of the payload
+// does not depend on the writer's word width: bit i is bit (i % 8) of byte
+// i / 8. WordBits only records what the writer used. Offsets are relative
+// to the start of the header and 64-byte aligned, so a mapped file can be
+// read in place as an array of 64-bit words.
+struct BitVectorFileHeader {
+  uint32_t Magic;
+  uint16_t Version;
+  uint16_t WordBits;
+  uint64_t NumBits;
+  /// Number of set bits, so that count() needs no pass over the payload.
+  uint64_t NumOnes;
+  uint64_t PayloadOffset;
+  uint64_t PayloadBytes;
+  /// Checksum of the payload followed by the index section, if any, as one
+  /// run of words; bitVectorChecksum() of the payload if there is no index.
+  uint64_t Checksum;
+  /// 0 if the file has no rank/select index.
+  uint64_t RankOffset;
+  uint32_t RankBlocks;
+  uint32_t RankSamples;
+
+  enum : uint32_t { MAGIC = 0x31465642 }; // "BVF1"
+  enum : uint16_t { VERSION = 1 };
+
+  /// Returns the size of the whole record, header included.
+  uint64_t getRecordSize() const;
+  /// Returns true if the header is self-consistent and fits in FileSize
+  /// bytes. The index section itself is checked by
+  /// RankSelectIndex::isConsistent() once it is read.
+  bool isValid(uint64_t FileSize) const;
+};
+
+static_assert(sizeof(BitVectorFileHeader) == 64, "Header must stay 64 bytes");
+static_assert(std::endian::native == std::endian::little,
+              "Files are read in place and must be little-endian");
+
+/// Returns a checksum of Bytes bytes at Data. Bytes must be a multiple of 8.
+uint64_t bitVectorChecksum(const void *Data, size_t Bytes);
+
+/// writeBitVectorFile - Write NumBits bits stored little-endian in words of
+/// WordBits bits at Data to F, in the format above. Bits past NumBits in the
+/// last word are written as zero. If Index is given, it must have been built
+/// over the same bits and is stored after the payload.
+bool writeBitVectorFile(FILE *F, const void *Data, uint64_t NumBits,
+                        unsigned WordBits,
+                        const RankSelectIndex *Index = nullptr);
+
+bool writeBitVectorFile(const char *Path, const NBitVector &V,
+                        const RankSelectIndex *Index = nullptr);
+
+/// readBitVectorHeader - Read and validate a header from F, leaving F at the
+/// start of the payload.
+bool readBitVectorHeader(FILE *F, BitVectorFileHeader &Header);
+
+/// readBitVectorPayload - Read the rest of the record whose header was just
+/// read from F, storing the first DataBytes bytes of the payload at Data
+/// (DataBytes <= PayloadBytes). Fails unless the checksum matches and the
+/// bits past NumBits are clear. The index section, if any, is read for the
+/// checksum and dropped.
+bool readBitVectorPayload(FILE *F, const BitVectorFileHeader &Header,
+                          void *Data, size_t DataBytes);
+
+/// readBitVectorFile - Load a file written by writeBitVectorFile into V.
+bool readBitVectorFile(const char *Path, NBitVector &V);
+
+/// MappedBitVector - A read-only bit vector served straight from a memory
+/// mapped file. Opening costs one mmap and a header check, independent of
+/// the size of the file; pages are faulted in as they are touched.
+class MappedBitVector {
+public:
+  typedef NBitVector::BitWord BitWord;
+
+private:
+  enum { BITWORD_SIZE = NBitVector::BITWORD_SIZE };
+  static_assert(BITWORD_SIZE == 64, "Mapped words are 64-bit");
+
+  void *Map = nullptr;
+  size_t MapSize = 0;
+  const BitWord *Words = nullptr;
+  uint64_t Size = 0;
+  uint64_t NumOnes = 0;
+  uint64_t NumWords = 0;
+  uint64_t Checksum = 0;
+  /// Bytes of the index section, 0 without an index.
+  size_t IndexBytes = 0;
+  RankSelectIndex Index;
+  bool HasIndex = false;
+
+public:
+  MappedBitVector() = default;
+  MappedBitVector(const MappedBitVector &) = delete;
+  MappedBitVector &operator=(const MappedBitVector &) = delete;
+  ~MappedBitVector() { close(); }
+
+  /// open - Map the file at Path. A stored rank/select index is checked
+  /// with RankSelectIndex::isConsistent(), one pass over the index. If
+  /// VerifyChecksum is set, the whole payload is read once to check it,
+  /// which defeats the fast startup.
+  bool open(const char *Path, bool VerifyChecksum = false);
+  void close();
+
+  bool isOpen() const { return Map != nullptr; }
+  uint64_t size() const { return Size; }
+  bool empty() const { return Size == 0; }
+
+  /// Verify the checksum of the payload and index now.
+  bool verify() const;
+
+  bool test(uint64_t Idx) const {
+    assert(Idx < Size && "Out-of-bounds Bit access.");
+    return (Words[Idx / BITWORD_SIZE] >> (Idx % BITWORD_SIZE)) & 1;
+  }
+  bool operator[](uint64_t Idx) const { return test(Idx); }
+
+  /// count - Returns the number of set bits, from the header.
+  uint64_t count() const { return NumOnes; }
+  bool any() const { return NumOnes != 0; }
+
+  /// find_first_in - Returns the index of the first set bit in [Begin, End),
+  /// or -1 if there is none.
+  int64_t find_first_in(uint64_t Begin, uint64_t End) const;
+  int64_t find_first() const { return find_first_in(0, Size); }
+  int64_t find_next(uint64_t Prev) const {
+    return find_first_in(Prev + 1, Size);
+  }
+
+  /// The rank/select index, if the file was written with one.
+  bool hasRankIndex() const { return HasIndex; }
+  const RankSelectIndex &getRankIndex() const {
+    assert(HasIndex && "File has no rank/select index");
+    return Index;
+  }
+
+  /// Bulk operations into a writable vector, Dst op= *this. Words of Dst
+  /// past the end of this vector are treated like NBitVector's operators
+  /// treat a shorter RHS.
+  void andInto(NBitVector &Dst) const;
+  void orInto(NBitVector &Dst) const;
+  void xorInto(NBitVector &Dst) const;
+  /// Dst &= ~*this.
+  void resetIn(NBitVector &Dst) const;
+
+  /// Words of the mapping, for other word kernels.
+  const BitWord *getData() const { return Words; }
+  uint64_t getNumWords() const { return NumWords; }
+};
+
+#endif /* BitVectorFile_hpp */
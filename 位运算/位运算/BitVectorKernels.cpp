@@ -0,0 +1,496 @@
+//
+//  BitVectorKernels.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "BitVectorKernels.hpp"
+#include "SIMDDetect.hpp"
+
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#endif
+
+namespace tesseract {
+
+// Generic kernels. The loops are kept deliberately simple so that their
+// results define the reference behaviour for the SIMD variants below.
+
+static void OrGeneric(uint32_t *dst, const uint32_t *a, const uint32_t *b, int n) {
+  for (int w = 0; w < n; ++w) {
+    dst[w] = a[w] | b[w];
+  }
+}
+static void AndGeneric(uint32_t *dst, const uint32_t *a, const uint32_t *b, int n) {
+  for (int w = 0; w < n; ++w) {
+    dst[w] = a[w] & b[w];
+  }
+}
+static void XorGeneric(uint32_t *dst, const uint32_t *a, const uint32_t *b, int n) {
+  for (int w = 0; w < n; ++w) {
+    dst[w] = a[w] ^ b[w];
+  }
+}
+static void AndNotGeneric(uint32_t *dst, const uint32_t *a, const uint32_t *b, int n) {
+  for (int w = 0; w < n; ++w) {
+    dst[w] = a[w] & ~b[w];
+  }
+}
+
+const BitOpKernels kBitOpsGeneric = {"generic", OrGeneric, AndGeneric,
+                                     XorGeneric, AndNotGeneric};
+
+// Counts n words, pairing them up into 64-bit loads. POPCOUNT64 is the
+// per-word popcount for the instruction set of the calling kernel.
+#define POPCOUNT_WORDS(POPCOUNT64)                                            \
+  int64_t total = 0;                                                          \
+  int w = 0;                                                                  \
+  for (; w + 2 <= n; w += 2) {                                                \
+    uint64_t word;                                                            \
+    memcpy(&word, p + w, sizeof(word));                                       \
+    total += POPCOUNT64(word);                                                \
+  }                                                                           \
+  if (w < n) {                                                                \
+    total += POPCOUNT64(uint64_t(p[w]));                                      \
+  }                                                                           \
+  return total;
+
+int64_t PopCountGeneric(const uint32_t *p, int n) {
+  POPCOUNT_WORDS(std::popcount)
+}
+
+// Counts OP(a[w], b[w]) over n words, pairing them up into 64-bit loads like
+// POPCOUNT_WORDS. OP(0, 0) is 0 for all the operations, so the zero upper
+// half of the last unpaired word adds nothing.
+#define BITCOUNT_WORDS(POPCOUNT64, OP)                                        \
+  int64_t total = 0;                                                          \
+  int w = 0;                                                                  \
+  for (; w + 2 <= n; w += 2) {                                                \
+    uint64_t x, y;                                                            \
+    memcpy(&x, a + w, sizeof(x));                                             \
+    memcpy(&y, b + w, sizeof(y));                                             \
+    total += POPCOUNT64(uint64_t(OP(x, y)));                                  \
+  }                                                                           \
+  if (w < n) {                                                                \
+    total += POPCOUNT64(uint64_t(OP(uint64_t(a[w]), uint64_t(b[w]))));        \
+  }                                                                           \
+  return total;
+
+#define ANDOR_COUNT_WORDS(POPCOUNT64)                                         \
+  int64_t and_total = 0, or_total = 0;                                        \
+  int w = 0;                                                                  \
+  for (; w + 2 <= n; w += 2) {                                                \
+    uint64_t x, y;                                                            \
+    memcpy(&x, a + w, sizeof(x));                                             \
+    memcpy(&y, b + w, sizeof(y));                                             \
+    and_total += POPCOUNT64(x & y);                                           \
+    or_total += POPCOUNT64(x | y);                                            \
+  }                                                                           \
+  if (w < n) {                                                                \
+    and_total += POPCOUNT64(uint64_t(a[w] & b[w]));                           \
+    or_total += POPCOUNT64(uint64_t(a[w] | b[w]));                            \
+  }                                                                           \
+  *and_count = and_total;                                                     \
+  *or_count = or_total;
+
+#define OP_AND(x, y) ((x) & (y))
+#define OP_OR(x, y) ((x) | (y))
+#define OP_XOR(x, y) ((x) ^ (y))
+#define OP_ANDNOT(x, y) ((x) & ~(y))
+
+// Defines the five fused count kernels Name##And ... Name##AndOr.
+#define DEFINE_SCALAR_COUNT_KERNELS(Name, Attr, POPCOUNT64)                   \
+  Attr static int64_t Name##And(const uint32_t *a, const uint32_t *b, int n) { \
+    BITCOUNT_WORDS(POPCOUNT64, OP_AND)                                        \
+  }                                                                           \
+  Attr static int64_t Name##Or(const uint32_t *a, const uint32_t *b, int n) {  \
+    BITCOUNT_WORDS(POPCOUNT64, OP_OR)                                         \
+  }                                                                           \
+  Attr static int64_t Name##Xor(const uint32_t *a, const uint32_t *b, int n) { \
+    BITCOUNT_WORDS(POPCOUNT64, OP_XOR)                                        \
+  }                                                                           \
+  Attr static int64_t Name##AndNot(const uint32_t *a, const uint32_t *b,      \
+                                   int n) {                                   \
+    BITCOUNT_WORDS(POPCOUNT64, OP_ANDNOT)                                     \
+  }                                                                           \
+  Attr static void Name##AndOr(const uint32_t *a, const uint32_t *b, int n,   \
+                               int64_t *and_count, int64_t *or_count) {       \
+    ANDOR_COUNT_WORDS(POPCOUNT64)                                             \
+  }
+
+DEFINE_SCALAR_COUNT_KERNELS(CountGeneric, , std::popcount)
+
+const BitCountKernels kBitCountsGeneric = {
+    "generic",        CountGenericAnd,    CountGenericOr, CountGenericXor,
+    CountGenericAndNot, CountGenericAndOr};
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The SIMD kernels are compiled with per-function target attributes so that
+// this file needs no special compiler flags; SIMDDetect makes sure they are
+// only called on hardware that supports them. Loads and stores are unaligned
+// because std::vector only guarantees alignof(uint32_t). The tail that does
+// not fill a whole register is handled by the generic loop.
+
+// Note that _mm*_andnot_* computes ~x & y, hence the swapped operands.
+#define DEFINE_SIMD_KERNEL(Name, Attr, Vec, Lanes, Load, Store, Expr, Tail)   \
+  __attribute__((target(Attr))) static void Name(                             \
+      uint32_t *dst, const uint32_t *a, const uint32_t *b, int n) {           \
+    int w = 0;                                                                \
+    for (; w + Lanes <= n; w += Lanes) {                                      \
+      Vec x = Load(reinterpret_cast<const Vec *>(a + w));                     \
+      Vec y = Load(reinterpret_cast<const Vec *>(b + w));                     \
+      Store(reinterpret_cast<Vec *>(dst + w), Expr);                          \
+    }                                                                         \
+    Tail(dst + w, a + w, b + w, n - w);                                       \
+  }
+
+DEFINE_SIMD_KERNEL(OrSSE2, "sse2", __m128i, 4, _mm_loadu_si128, _mm_storeu_si128,
+                   _mm_or_si128(x, y), OrGeneric)
+DEFINE_SIMD_KERNEL(AndSSE2, "sse2", __m128i, 4, _mm_loadu_si128, _mm_storeu_si128,
+                   _mm_and_si128(x, y), AndGeneric)
+DEFINE_SIMD_KERNEL(XorSSE2, "sse2", __m128i, 4, _mm_loadu_si128, _mm_storeu_si128,
+                   _mm_xor_si128(x, y), XorGeneric)
+DEFINE_SIMD_KERNEL(AndNotSSE2, "sse2", __m128i, 4, _mm_loadu_si128, _mm_storeu_si128,
+                   _mm_andnot_si128(y, x), AndNotGeneric)
+
+DEFINE_SIMD_KERNEL(OrAVX2, "avx2", __m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256,
+                   _mm256_or_si256(x, y), OrGeneric)
+DEFINE_SIMD_KERNEL(AndAVX2, "avx2", __m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256,
+                   _mm256_and_si256(x, y), AndGeneric)
+DEFINE_SIMD_KERNEL(XorAVX2, "avx2", __m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256,
+                   _mm256_xor_si256(x, y), XorGeneric)
+DEFINE_SIMD_KERNEL(AndNotAVX2, "avx2", __m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256,
+                   _mm256_andnot_si256(y, x), AndNotGeneric)
+
+DEFINE_SIMD_KERNEL(OrAVX512, "avx512f", __m512i, 16, _mm512_loadu_si512, _mm512_storeu_si512,
+                   _mm512_or_si512(x, y), OrGeneric)
+DEFINE_SIMD_KERNEL(AndAVX512, "avx512f", __m512i, 16, _mm512_loadu_si512, _mm512_storeu_si512,
+                   _mm512_and_si512(x, y), AndGeneric)
+DEFINE_SIMD_KERNEL(XorAVX512, "avx512f", __m512i, 16, _mm512_loadu_si512, _mm512_storeu_si512,
+                   _mm512_xor_si512(x, y), XorGeneric)
+DEFINE_SIMD_KERNEL(AndNotAVX512, "avx512f", __m512i, 16, _mm512_loadu_si512, _mm512_storeu_si512,
+                   _mm512_andnot_si512(y, x), AndNotGeneric)
+
+#undef DEFINE_SIMD_KERNEL
+
+const BitOpKernels kBitOpsSSE2 = {"sse2", OrSSE2, AndSSE2, XorSSE2, AndNotSSE2};
+const BitOpKernels kBitOpsAVX2 = {"avx2", OrAVX2, AndAVX2, XorAVX2, AndNotAVX2};
+const BitOpKernels kBitOpsAVX512 = {"avx512", OrAVX512, AndAVX512, XorAVX512,
+                                    AndNotAVX512};
+
+int64_t PopCountPOPCNT(const uint32_t *p, int n) __attribute__((target("popcnt")));
+int64_t PopCountPOPCNT(const uint32_t *p, int n) {
+  POPCOUNT_WORDS(__builtin_popcountll)
+}
+
+// Returns the popcount of each 64-bit lane of v, using the nibble lookup
+// table of Mula et al.
+__attribute__((target("avx2"))) static inline __m256i PopCount256(__m256i v) {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  __m256i lo = _mm256_and_si256(v, low_mask);
+  __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+  __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                   _mm256_shuffle_epi8(lookup, hi));
+  return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2"))) static inline __m256i Load256(const uint32_t *p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+// Carry-save adder: (h, l) = a + b + c, bitwise.
+__attribute__((target("avx2"))) static inline void CSA(__m256i *h, __m256i *l,
+                                                       __m256i a, __m256i b,
+                                                       __m256i c) {
+  __m256i u = _mm256_xor_si256(a, b);
+  *h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+  *l = _mm256_xor_si256(u, c);
+}
+
+__attribute__((target("avx2,popcnt"))) int64_t PopCountAVX2(const uint32_t *p,
+                                                            int n) {
+  const int kLanes = 8;
+  const int kBlock = 16 * kLanes;
+  __m256i total = _mm256_setzero_si256();
+  __m256i ones = _mm256_setzero_si256();
+  __m256i twos = _mm256_setzero_si256();
+  __m256i fours = _mm256_setzero_si256();
+  __m256i eights = _mm256_setzero_si256();
+  __m256i sixteens, twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+  int w = 0;
+  for (; w + kBlock <= n; w += kBlock) {
+    const uint32_t *q = p + w;
+    CSA(&twos_a, &ones, ones, Load256(q + 0 * kLanes), Load256(q + 1 * kLanes));
+    CSA(&twos_b, &ones, ones, Load256(q + 2 * kLanes), Load256(q + 3 * kLanes));
+    CSA(&fours_a, &twos, twos, twos_a, twos_b);
+    CSA(&twos_a, &ones, ones, Load256(q + 4 * kLanes), Load256(q + 5 * kLanes));
+    CSA(&twos_b, &ones, ones, Load256(q + 6 * kLanes), Load256(q + 7 * kLanes));
+    CSA(&fours_b, &twos, twos, twos_a, twos_b);
+    CSA(&eights_a, &fours, fours, fours_a, fours_b);
+    CSA(&twos_a, &ones, ones, Load256(q + 8 * kLanes), Load256(q + 9 * kLanes));
+    CSA(&twos_b, &ones, ones, Load256(q + 10 * kLanes), Load256(q + 11 * kLanes));
+    CSA(&fours_a, &twos, twos, twos_a, twos_b);
+    CSA(&twos_a, &ones, ones, Load256(q + 12 * kLanes), Load256(q + 13 * kLanes));
+    CSA(&twos_b, &ones, ones, Load256(q + 14 * kLanes), Load256(q + 15 * kLanes));
+    CSA(&fours_b, &twos, twos, twos_a, twos_b);
+    CSA(&eights_b, &fours, fours, fours_a, fours_b);
+    CSA(&sixteens, &eights, eights, eights_a, eights_b);
+    total = _mm256_add_epi64(total, PopCount256(sixteens));
+  }
+  total = _mm256_slli_epi64(total, 4);
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(PopCount256(eights), 3));
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(PopCount256(fours), 2));
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(PopCount256(twos), 1));
+  total = _mm256_add_epi64(total, PopCount256(ones));
+  for (; w + kLanes <= n; w += kLanes) {
+    total = _mm256_add_epi64(total, PopCount256(Load256(p + w)));
+  }
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), total);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+         PopCountPOPCNT(p + w, n - w);
+}
+
+DEFINE_SCALAR_COUNT_KERNELS(CountPOPCNT, __attribute__((target("popcnt"))),
+                            __builtin_popcountll)
+
+const BitCountKernels kBitCountsPOPCNT = {
+    "popcnt",        CountPOPCNTAnd,    CountPOPCNTOr, CountPOPCNTXor,
+    CountPOPCNTAndNot, CountPOPCNTAndOr};
+
+// The operations of the fused counts on whole registers, as functors so that
+// one kernel template serves all four. _mm*_andnot_* computes ~x & y.
+#define DEFINE_SIMD_OP(Name, Attr, Vec, Expr)                                 \
+  struct Name {                                                               \
+    __attribute__((target(Attr))) Vec operator()(Vec x, Vec y) const {        \
+      return Expr;                                                            \
+    }                                                                         \
+  };
+
+DEFINE_SIMD_OP(AndOp256, "avx2", __m256i, _mm256_and_si256(x, y))
+DEFINE_SIMD_OP(OrOp256, "avx2", __m256i, _mm256_or_si256(x, y))
+DEFINE_SIMD_OP(XorOp256, "avx2", __m256i, _mm256_xor_si256(x, y))
+DEFINE_SIMD_OP(AndNotOp256, "avx2", __m256i, _mm256_andnot_si256(y, x))
+DEFINE_SIMD_OP(AndOp512, "avx512f", __m512i, _mm512_and_si512(x, y))
+DEFINE_SIMD_OP(OrOp512, "avx512f", __m512i, _mm512_or_si512(x, y))
+DEFINE_SIMD_OP(XorOp512, "avx512f", __m512i, _mm512_xor_si512(x, y))
+DEFINE_SIMD_OP(AndNotOp512, "avx512f", __m512i, _mm512_andnot_si512(y, x))
+
+#undef DEFINE_SIMD_OP
+
+// PopCountAVX2 on op(a, b). The words after the last whole block go through
+// the plain lookup popcount, the last partial register from zero-padded
+// copies, since op(0, 0) == 0.
+template <typename Op>
+__attribute__((target("avx2,popcnt"))) static int64_t CountAVX2(
+    const uint32_t *a, const uint32_t *b, int n) {
+  const int kLanes = 8;
+  const int kBlock = 16 * kLanes;
+  Op op;
+  __m256i total = _mm256_setzero_si256();
+  __m256i ones = _mm256_setzero_si256();
+  __m256i twos = _mm256_setzero_si256();
+  __m256i fours = _mm256_setzero_si256();
+  __m256i eights = _mm256_setzero_si256();
+  __m256i sixteens, twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+  int w = 0;
+#define OP_LOAD(k) op(Load256(a + w + (k) * kLanes), Load256(b + w + (k) * kLanes))
+  for (; w + kBlock <= n; w += kBlock) {
+    CSA(&twos_a, &ones, ones, OP_LOAD(0), OP_LOAD(1));
+    CSA(&twos_b, &ones, ones, OP_LOAD(2), OP_LOAD(3));
+    CSA(&fours_a, &twos, twos, twos_a, twos_b);
+    CSA(&twos_a, &ones, ones, OP_LOAD(4), OP_LOAD(5));
+    CSA(&twos_b, &ones, ones, OP_LOAD(6), OP_LOAD(7));
+    CSA(&fours_b, &twos, twos, twos_a, twos_b);
+    CSA(&eights_a, &fours, fours, fours_a, fours_b);
+    CSA(&twos_a, &ones, ones, OP_LOAD(8), OP_LOAD(9));
+    CSA(&twos_b, &ones, ones, OP_LOAD(10), OP_LOAD(11));
+    CSA(&fours_a, &twos, twos, twos_a, twos_b);
+    CSA(&twos_a, &ones, ones, OP_LOAD(12), OP_LOAD(13));
+    CSA(&twos_b, &ones, ones, OP_LOAD(14), OP_LOAD(15));
+    CSA(&fours_b, &twos, twos, twos_a, twos_b);
+    CSA(&eights_b, &fours, fours, fours_a, fours_b);
+    CSA(&sixteens, &eights, eights, eights_a, eights_b);
+    total = _mm256_add_epi64(total, PopCount256(sixteens));
+  }
+  total = _mm256_slli_epi64(total, 4);
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(PopCount256(eights), 3));
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(PopCount256(fours), 2));
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(PopCount256(twos), 1));
+  total = _mm256_add_epi64(total, PopCount256(ones));
+  for (; w + kLanes <= n; w += kLanes) {
+    total = _mm256_add_epi64(total, PopCount256(OP_LOAD(0)));
+  }
+#undef OP_LOAD
+  if (w < n) {
+    uint32_t tail_a[kLanes] = {}, tail_b[kLanes] = {};
+    memcpy(tail_a, a + w, (n - w) * sizeof(uint32_t));
+    memcpy(tail_b, b + w, (n - w) * sizeof(uint32_t));
+    total = _mm256_add_epi64(total,
+                             PopCount256(op(Load256(tail_a), Load256(tail_b))));
+  }
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), total);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// Per-byte popcounts of v, each at most 8.
+__attribute__((target("avx2"))) static inline __m256i ByteCounts256(__m256i v) {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  __m256i lo = _mm256_and_si256(v, low_mask);
+  __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+  return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                         _mm256_shuffle_epi8(lookup, hi));
+}
+
+// Two Harley-Seal trees do not fit in the 16 ymm registers, so the AND and OR
+// counts are kept as per-byte sums instead, flushed into 64-bit lanes every
+// 31 registers before they can overflow.
+__attribute__((target("avx2"))) static void CountAVX2AndOr(
+    const uint32_t *a, const uint32_t *b, int n, int64_t *and_count,
+    int64_t *or_count) {
+  const int kLanes = 8;
+  const int kFlush = 31;
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i and_total = zero, or_total = zero;
+  int w = 0;
+  while (w + kLanes <= n) {
+    __m256i and_bytes = zero, or_bytes = zero;
+    for (int i = 0; i < kFlush && w + kLanes <= n; ++i, w += kLanes) {
+      __m256i x = Load256(a + w), y = Load256(b + w);
+      and_bytes = _mm256_add_epi8(and_bytes, ByteCounts256(_mm256_and_si256(x, y)));
+      or_bytes = _mm256_add_epi8(or_bytes, ByteCounts256(_mm256_or_si256(x, y)));
+    }
+    and_total = _mm256_add_epi64(and_total, _mm256_sad_epu8(and_bytes, zero));
+    or_total = _mm256_add_epi64(or_total, _mm256_sad_epu8(or_bytes, zero));
+  }
+  int64_t and_lanes[4], or_lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(and_lanes), and_total);
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(or_lanes), or_total);
+  int64_t and_tail, or_tail;
+  CountPOPCNTAndOr(a + w, b + w, n - w, &and_tail, &or_tail);
+  *and_count = and_lanes[0] + and_lanes[1] + and_lanes[2] + and_lanes[3] + and_tail;
+  *or_count = or_lanes[0] + or_lanes[1] + or_lanes[2] + or_lanes[3] + or_tail;
+}
+
+const BitCountKernels kBitCountsAVX2 = {
+    "avx2", CountAVX2<AndOp256>, CountAVX2<OrOp256>, CountAVX2<XorOp256>,
+    CountAVX2<AndNotOp256>, CountAVX2AndOr};
+
+template <typename Op>
+__attribute__((target("avx512f,avx512vpopcntdq"))) static int64_t CountAVX512(
+    const uint32_t *a, const uint32_t *b, int n) {
+  const int kLanes = 16;
+  Op op;
+  __m512i total = _mm512_setzero_si512();
+  int w = 0;
+  for (; w + kLanes <= n; w += kLanes) {
+    __m512i x = _mm512_loadu_si512(a + w), y = _mm512_loadu_si512(b + w);
+    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(op(x, y)));
+  }
+  if (w < n) {
+    __mmask16 mask = __mmask16((1u << (n - w)) - 1);
+    __m512i x = _mm512_maskz_loadu_epi32(mask, a + w);
+    __m512i y = _mm512_maskz_loadu_epi32(mask, b + w);
+    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(op(x, y)));
+  }
+  return _mm512_reduce_add_epi64(total);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) static void CountAVX512AndOr(
+    const uint32_t *a, const uint32_t *b, int n, int64_t *and_count,
+    int64_t *or_count) {
+  const int kLanes = 16;
+  __m512i and_total = _mm512_setzero_si512(), or_total = _mm512_setzero_si512();
+  for (int w = 0; w < n; w += kLanes) {
+    __mmask16 mask = n - w >= kLanes ? __mmask16(0xffff)
+                                     : __mmask16((1u << (n - w)) - 1);
+    __m512i x = _mm512_maskz_loadu_epi32(mask, a + w);
+    __m512i y = _mm512_maskz_loadu_epi32(mask, b + w);
+    and_total = _mm512_add_epi64(and_total, _mm512_popcnt_epi64(_mm512_and_si512(x, y)));
+    or_total = _mm512_add_epi64(or_total, _mm512_popcnt_epi64(_mm512_or_si512(x, y)));
+  }
+  *and_count = _mm512_reduce_add_epi64(and_total);
+  *or_count = _mm512_reduce_add_epi64(or_total);
+}
+
+const BitCountKernels kBitCountsAVX512 = {
+    "avx512", CountAVX512<AndOp512>, CountAVX512<OrOp512>,
+    CountAVX512<XorOp512>, CountAVX512<AndNotOp512>, CountAVX512AndOr};
+
+#endif // x86
+
+#undef POPCOUNT_WORDS
+#undef BITCOUNT_WORDS
+#undef ANDOR_COUNT_WORDS
+#undef DEFINE_SCALAR_COUNT_KERNELS
+#undef OP_AND
+#undef OP_OR
+#undef OP_XOR
+#undef OP_ANDNOT
+
+// Dispatch stubs, the initial value of the kernel pointers. The first call
+// of any kernel runs SIMDDetect, which points BitOps, PopCount and BitCounts
+// at the selected kernels, and forwards to them. Detection thus does not
+// depend on SIMDDetect's object file being linked in for a static
+// initializer, nor on the order of static initialization.
+
+#define DEFINE_DISPATCH_OP(Op)                                                \
+  static void Dispatch##Op(uint32_t *dst, const uint32_t *a,                  \
+                           const uint32_t *b, int n) {                        \
+    SIMDDetect::Initialize();                                                 \
+    BitOps.load(std::memory_order_acquire)->Op(dst, a, b, n);                 \
+  }
+DEFINE_DISPATCH_OP(Or)
+DEFINE_DISPATCH_OP(And)
+DEFINE_DISPATCH_OP(Xor)
+DEFINE_DISPATCH_OP(AndNot)
+#undef DEFINE_DISPATCH_OP
+
+static const BitOpKernels kBitOpsDispatch = {
+    "dispatch", DispatchOr, DispatchAnd, DispatchXor, DispatchAndNot};
+
+static int64_t PopCountDispatch(const uint32_t *p, int n) {
+  SIMDDetect::Initialize();
+  return PopCount.load(std::memory_order_acquire)(p, n);
+}
+
+#define DEFINE_DISPATCH_COUNT(Op)                                             \
+  static int64_t DispatchCount##Op(const uint32_t *a, const uint32_t *b,      \
+                                   int n) {                                   \
+    SIMDDetect::Initialize();                                                 \
+    return BitCounts.load(std::memory_order_acquire)->Op(a, b, n);            \
+  }
+DEFINE_DISPATCH_COUNT(And)
+DEFINE_DISPATCH_COUNT(Or)
+DEFINE_DISPATCH_COUNT(Xor)
+DEFINE_DISPATCH_COUNT(AndNot)
+#undef DEFINE_DISPATCH_COUNT
+
+static void DispatchCountAndOr(const uint32_t *a, const uint32_t *b, int n,
+                               int64_t *and_count, int64_t *or_count) {
+  SIMDDetect::Initialize();
+  BitCounts.load(std::memory_order_acquire)->AndOr(a, b, n, and_count,
+                                                  or_count);
+}
+
+static const BitCountKernels kBitCountsDispatch = {
+    "dispatch",         DispatchCountAnd,    DispatchCountOr,
+    DispatchCountXor,   DispatchCountAndNot, DispatchCountAndOr};
+
+std::atomic<const BitOpKernels *> BitOps{&kBitOpsDispatch};
+std::atomic<PopCountFunction> PopCount{PopCountDispatch};
+std::atomic<const BitCountKernels *> BitCounts{&kBitCountsDispatch};
+
+} // namespace tesseract
@@ -0,0 +1,105 @@
+//
+//  BitVectorKernels.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef BitVectorKernels_hpp
+#define BitVectorKernels_hpp
+
+#include <atomic>
+#include <cstdint>
+
+namespace tesseract {
+
+// Computes dst[w] = a[w] op b[w] for w in [0, n). dst may alias a or b.
+using BitOpFunction = void (*)(uint32_t *dst, const uint32_t *a,
+                               const uint32_t *b, int n);
+
+// A set of word kernels for the bulk logical operations of BitVector.
+// All implementations produce bit-identical results; they only differ in the
+// instruction set used to stream over the words.
+struct BitOpKernels {
+  const char *name;
+  BitOpFunction Or;
+  BitOpFunction And;
+  BitOpFunction Xor;
+  // dst = a & ~b, i.e. set subtraction a - b.
+  BitOpFunction AndNot;
+};
+
+// Portable kernels, one uint32_t at a time. Always available.
+extern const BitOpKernels kBitOpsGeneric;
+
+#if defined(__x86_64__) || defined(__i386__)
+// Only call these if the matching SIMDDetect::Is*Available() returns true.
+extern const BitOpKernels kBitOpsSSE2;
+extern const BitOpKernels kBitOpsAVX2;
+extern const BitOpKernels kBitOpsAVX512;
+#endif
+
+// The kernels selected by SIMDDetect. Until the detector has run, this
+// points at stubs that run it on their first call. The detector stores it
+// from whichever thread calls a kernel first, so load it with
+// std::memory_order_acquire.
+extern std::atomic<const BitOpKernels *> BitOps;
+
+// Returns the number of set bits in the n words at p.
+using PopCountFunction = int64_t (*)(const uint32_t *p, int n);
+
+// Portable popcount, 64 bits at a time.
+int64_t PopCountGeneric(const uint32_t *p, int n);
+#if defined(__x86_64__) || defined(__i386__)
+// Uses the popcnt instruction. Requires SIMDDetect::IsPOPCNTAvailable().
+int64_t PopCountPOPCNT(const uint32_t *p, int n);
+// Harley-Seal carry-save adder tree over 256-bit registers with a nibble
+// lookup popcount. Requires SIMDDetect::IsAVX2Available().
+int64_t PopCountAVX2(const uint32_t *p, int n);
+#endif
+
+// The popcount selected by SIMDDetect, see BitOps.
+extern std::atomic<PopCountFunction> PopCount;
+
+// Returns the number of set bits of a[w] op b[w] over w in [0, n), without
+// storing the words.
+using BitCountFunction = int64_t (*)(const uint32_t *a, const uint32_t *b,
+                                     int n);
+// Sets *and_count and *or_count to the set bits of a & b and a | b, in one
+// pass over the words.
+using AndOrCountFunction = void (*)(const uint32_t *a, const uint32_t *b, int n,
+                                    int64_t *and_count, int64_t *or_count);
+
+// Fused popcounts of the bulk logical operations, for the intersection and
+// union sizes and similarities of two vectors.
+struct BitCountKernels {
+  const char *name;
+  BitCountFunction And;
+  BitCountFunction Or;
+  BitCountFunction Xor;
+  // Counts a & ~b.
+  BitCountFunction AndNot;
+  AndOrCountFunction AndOr;
+};
+
+// Portable kernels, 64 bits at a time. Always available.
+extern const BitCountKernels kBitCountsGeneric;
+
+#if defined(__x86_64__) || defined(__i386__)
+// Only call these if the matching SIMDDetect::Is*Available() returns true:
+// POPCNT needs popcnt, AVX2 avx2 and popcnt, AVX512 avx512f and
+// avx512vpopcntdq.
+extern const BitCountKernels kBitCountsPOPCNT;
+// Harley-Seal carry-save adder trees over the combined words; AndOr keeps
+// per-byte lookup counts for both results instead.
+extern const BitCountKernels kBitCountsAVX2;
+// vpopcntq on 512-bit registers, with masked loads for the tail.
+extern const BitCountKernels kBitCountsAVX512;
+#endif
+
+// The kernels selected by SIMDDetect, see BitOps.
+extern std::atomic<const BitCountKernels *> BitCounts;
+
+} // namespace tesseract
+
+#endif /* BitVectorKernels_hpp */
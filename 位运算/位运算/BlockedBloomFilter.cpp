@@ -0,0 +1,192 @@
+//
+//  BlockedBloomFilter.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "BlockedBloomFilter.hpp"
+#include "BitVectorFile.hpp"
+#include "SIMDDetect.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#endif
+
+// The salts of the Parquet split block Bloom filter: odd, and spread so that
+// the eight products of one hash are close to independent.
+const uint32_t BlockedBloomFilter::Salts[NumProbes] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+namespace {
+
+/// Hashes ahead of the current one whose blocks are prefetched by the batch
+/// loops, enough to keep several misses in flight.
+enum { BloomPrefetchDistance = 16 };
+
+struct BloomFileHeader {
+  uint32_t Magic;
+  uint16_t Version;
+  uint16_t NumProbes;
+  uint32_t BlockBits;
+  uint32_t Reserved;
+  uint64_t NumBlocks;
+  /// bitVectorChecksum() of the blocks.
+  uint64_t Checksum;
+
+  enum : uint32_t { MAGIC = 0x31464242 }; // "BBF1"
+  enum : uint16_t { VERSION = 1 };
+};
+
+static_assert(sizeof(BloomFileHeader) == 32, "Header must stay 32 bytes");
+
+inline void prefetchBlock(const BloomBlock *B) {
+  __builtin_prefetch(B, 1);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/// The low and high half masks of the eight probes of Lo: lane i of the
+/// pair holds the probe bit of word i and of word i + 8 respectively.
+__attribute__((target("avx2"))) inline void
+probeMasksAVX2(uint32_t Lo, __m256i &LowMask, __m256i &HighMask) {
+  const __m256i Salts = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i *>(BlockedBloomFilter::Salts));
+  __m256i P = _mm256_mullo_epi32(_mm256_set1_epi32(int(Lo)), Salts);
+  __m256i Bits = _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_srli_epi32(P, 27));
+  // All ones in the lanes whose bit 26 selects the high half.
+  __m256i High = _mm256_srai_epi32(_mm256_slli_epi32(P, 5), 31);
+  LowMask = _mm256_andnot_si256(High, Bits);
+  HighMask = _mm256_and_si256(High, Bits);
+}
+
+__attribute__((target("avx2"))) void
+insertBatchAVX2(BloomBlock *Blocks, const BlockedBloomFilter &F,
+                const uint64_t *Hashes, size_t N) {
+  for (size_t i = 0; i < N; ++i) {
+    if (i + BloomPrefetchDistance < N)
+      prefetchBlock(&Blocks[F.blockIndex(Hashes[i + BloomPrefetchDistance])]);
+    __m256i LowMask, HighMask;
+    probeMasksAVX2(uint32_t(Hashes[i]), LowMask, HighMask);
+    __m256i *W = reinterpret_cast<__m256i *>(Blocks[F.blockIndex(Hashes[i])].words());
+    _mm256_store_si256(W, _mm256_or_si256(_mm256_load_si256(W), LowMask));
+    _mm256_store_si256(W + 1, _mm256_or_si256(_mm256_load_si256(W + 1), HighMask));
+  }
+}
+
+__attribute__((target("avx2"))) size_t
+mayContainBatchAVX2(const BloomBlock *Blocks, const BlockedBloomFilter &F,
+                    const uint64_t *Hashes, size_t N, bool *Results) {
+  size_t Hits = 0;
+  for (size_t i = 0; i < N; ++i) {
+    if (i + BloomPrefetchDistance < N)
+      prefetchBlock(&Blocks[F.blockIndex(Hashes[i + BloomPrefetchDistance])]);
+    __m256i LowMask, HighMask;
+    probeMasksAVX2(uint32_t(Hashes[i]), LowMask, HighMask);
+    const __m256i *W =
+        reinterpret_cast<const __m256i *>(Blocks[F.blockIndex(Hashes[i])].words());
+    // testc: all bits of the mask are set in the block.
+    bool Hit = _mm256_testc_si256(_mm256_load_si256(W), LowMask) &
+               _mm256_testc_si256(_mm256_load_si256(W + 1), HighMask);
+    Results[i] = Hit;
+    Hits += Hit;
+  }
+  return Hits;
+}
+
+#endif
+
+} // end anonymous namespace
+
+BlockedBloomFilter::BlockedBloomFilter(size_t ExpectedKeys, double BitsPerKey)
+    : Blocks(std::max<size_t>(
+          1, size_t(std::ceil(double(ExpectedKeys) * BitsPerKey / double(BlockBits))))) {
+  assert(Blocks.size() <= (size_t(1) << 32) && "Too many blocks");
+}
+
+void BlockedBloomFilter::insertBatch(const uint64_t *Hashes, size_t N) {
+  assert(!Blocks.empty() && "Filter has no blocks");
+#if defined(__x86_64__) || defined(__i386__)
+  if (tesseract::SIMDDetect::IsAVX2Available())
+    return insertBatchAVX2(Blocks.data(), *this, Hashes, N);
+#endif
+  for (size_t i = 0; i < N; ++i) {
+    if (i + BloomPrefetchDistance < N)
+      prefetchBlock(&Blocks[blockIndex(Hashes[i + BloomPrefetchDistance])]);
+    insert(Hashes[i]);
+  }
+}
+
+size_t BlockedBloomFilter::mayContainBatch(const uint64_t *Hashes, size_t N,
+                                           bool *Results) const {
+  assert(!Blocks.empty() && "Filter has no blocks");
+#if defined(__x86_64__) || defined(__i386__)
+  if (tesseract::SIMDDetect::IsAVX2Available())
+    return mayContainBatchAVX2(Blocks.data(), *this, Hashes, N, Results);
+#endif
+  size_t Hits = 0;
+  for (size_t i = 0; i < N; ++i) {
+    if (i + BloomPrefetchDistance < N)
+      prefetchBlock(&Blocks[blockIndex(Hashes[i + BloomPrefetchDistance])]);
+    Results[i] = mayContain(Hashes[i]);
+    Hits += Results[i];
+  }
+  return Hits;
+}
+
+void BlockedBloomFilter::clear() {
+  for (BloomBlock &B : Blocks)
+    B.Bits.clear(false);
+}
+
+bool BlockedBloomFilter::merge(const BlockedBloomFilter &Other) {
+  if (Other.Blocks.size() != Blocks.size())
+    return false;
+  uint32_t *Dst = Blocks.empty() ? nullptr : Blocks.front().words();
+  const uint32_t *Src = Other.Blocks.empty() ? nullptr : Other.Blocks.front().words();
+  // The blocks are contiguous words, which the compiler vectorizes.
+  for (size_t i = 0, e = Blocks.size() * BlockWords; i < e; ++i)
+    Dst[i] |= Src[i];
+  return true;
+}
+
+bool BlockedBloomFilter::operator==(const BlockedBloomFilter &RHS) const {
+  return Blocks.size() == RHS.Blocks.size() &&
+         (Blocks.empty() ||
+          memcmp(Blocks.data(), RHS.Blocks.data(), getMemorySize()) == 0);
+}
+
+bool BlockedBloomFilter::serialize(FILE *F) const {
+  BloomFileHeader Header = {};
+  Header.Magic = BloomFileHeader::MAGIC;
+  Header.Version = BloomFileHeader::VERSION;
+  Header.NumProbes = NumProbes;
+  Header.BlockBits = BlockBits;
+  Header.NumBlocks = Blocks.size();
+  Header.Checksum = bitVectorChecksum(Blocks.data(), getMemorySize());
+  return fwrite(&Header, sizeof(Header), 1, F) == 1 &&
+         fwrite(Blocks.data(), sizeof(BloomBlock), Blocks.size(), F) ==
+             Blocks.size();
+}
+
+bool BlockedBloomFilter::deserialize(FILE *F) {
+  BloomFileHeader Header;
+  if (fread(&Header, sizeof(Header), 1, F) != 1 ||
+      Header.Magic != BloomFileHeader::MAGIC ||
+      Header.Version != BloomFileHeader::VERSION ||
+      Header.NumProbes != NumProbes || Header.BlockBits != BlockBits ||
+      Header.NumBlocks == 0 || Header.NumBlocks > (uint64_t(1) << 32))
+    return false;
+  std::vector<BloomBlock> Read(Header.NumBlocks);
+  if (fread(Read.data(), sizeof(BloomBlock), Read.size(), F) != Read.size() ||
+      bitVectorChecksum(Read.data(), Read.size() * sizeof(BloomBlock)) !=
+          Header.Checksum)
+    return false;
+  Blocks = std::move(Read);
+  return true;
+}
@@ -0,0 +1,126 @@
+//
+//  BlockedBloomFilter.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef BlockedBloomFilter_hpp
+#define BlockedBloomFilter_hpp
+
+#include "MBitArray.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// A Bloom filter whose probes for one key all fall into a single 512-bit,
+// cache-line-aligned block, so a lookup costs one cache miss instead of one
+// per probe.
+//
+// The filter takes 64-bit hashes. The upper 32 bits pick the block. The lower
+// 32 bits are multiplied by eight odd constants; each product sets one bit in
+// one of the eight 32-bit word pairs (i, i + 8) of the block, so the eight
+// probes are independent and map one-to-one onto the lanes of a 256-bit
+// register. The batch calls use AVX2 for exactly that when it is available,
+// and prefetch the blocks of the hashes a few iterations ahead.
+//
+// Blocks are BitArray<512>s, so bit j of a block is bit j % 32 of its word
+// j / 32, and the whole filter is one array of 32-bit words.
+
+/// BloomBlock - One cache line of the filter.
+struct alignas(64) BloomBlock {
+  BitArray<512> Bits;
+
+  uint32_t *words() {
+    return reinterpret_cast<uint32_t *>(reinterpret_cast<char *>(this) +
+                                        BitArray<512>::offsetOfMap());
+  }
+  const uint32_t *words() const {
+    return reinterpret_cast<const uint32_t *>(
+        reinterpret_cast<const char *>(this) + BitArray<512>::offsetOfMap());
+  }
+};
+
+static_assert(sizeof(BloomBlock) == 64, "A block must be one cache line");
+
+class BlockedBloomFilter {
+public:
+  enum : unsigned { BlockBits = 512, BlockWords = 16, NumProbes = 8 };
+
+  /// An empty shape; deserialize() a filter into it before use.
+  BlockedBloomFilter() = default;
+
+  /// Creates an empty filter of BitsPerKey bits for each of ExpectedKeys
+  /// keys, rounded up to whole blocks. About 10 bits per key give a 1%
+  /// false positive rate.
+  BlockedBloomFilter(size_t ExpectedKeys, double BitsPerKey);
+
+  void insert(uint64_t Hash) {
+    assert(!Blocks.empty() && "Filter has no blocks");
+    BloomBlock &B = Blocks[blockIndex(Hash)];
+    for (unsigned i = 0; i < NumProbes; ++i)
+      B.Bits.set(probeBit(uint32_t(Hash), i));
+  }
+
+  /// Returns false if Hash was never inserted, true if it probably was.
+  bool mayContain(uint64_t Hash) const {
+    assert(!Blocks.empty() && "Filter has no blocks");
+    const BloomBlock &B = Blocks[blockIndex(Hash)];
+    // No early exit: the line is loaded anyway, and without branches the
+    // next lookups can start before this one resolves.
+    bool Hit = true;
+    for (unsigned i = 0; i < NumProbes; ++i)
+      Hit &= B.Bits.get(probeBit(uint32_t(Hash), i));
+    return Hit;
+  }
+
+  /// insert() of N hashes.
+  void insertBatch(const uint64_t *Hashes, size_t N);
+
+  /// Results[i] = mayContain(Hashes[i]) for N hashes. Returns the number of
+  /// hashes that may be contained.
+  size_t mayContainBatch(const uint64_t *Hashes, size_t N,
+                         bool *Results) const;
+
+  /// Removes all keys.
+  void clear();
+
+  /// merge - *this |= Other: afterwards the filter may contain every key of
+  /// both. Returns false, leaving *this unchanged, if the filters were not
+  /// created with the same number of blocks.
+  bool merge(const BlockedBloomFilter &Other);
+
+  /// Writes the filter to F. Filters of the same shape, written by different
+  /// processes, can be read back and merged. Returns false on error.
+  bool serialize(FILE *F) const;
+  /// Reads a filter written by serialize(). Returns false, leaving *this
+  /// unchanged, on error or checksum mismatch.
+  bool deserialize(FILE *F);
+
+  size_t getNumBlocks() const { return Blocks.size(); }
+  size_t getMemorySize() const { return Blocks.size() * sizeof(BloomBlock); }
+  bool operator==(const BlockedBloomFilter &RHS) const;
+
+  /// The block of Hash: the upper 32 bits scaled to the number of blocks.
+  size_t blockIndex(uint64_t Hash) const {
+    return size_t(((Hash >> 32) * Blocks.size()) >> 32);
+  }
+
+  /// Bit of probe I within its block, derived from the lower hash bits: bits
+  /// 31:27 of the product select the bit in the word, bit 26 the word pair
+  /// half.
+  static unsigned probeBit(uint32_t Lo, unsigned I) {
+    uint32_t P = Lo * Salts[I];
+    return (I + ((P >> 26) & 1) * 8) * 32 + (P >> 27);
+  }
+
+  static const uint32_t Salts[NumProbes];
+
+private:
+  std::vector<BloomBlock> Blocks;
+};
+
+#endif /* BlockedBloomFilter_hpp */
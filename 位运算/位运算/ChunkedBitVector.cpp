@@ -0,0 +1,122 @@
+//
+//  ChunkedBitVector.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "ChunkedBitVector.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+ChunkedBitVector::ChunkedBitVector(const NBitVector &V)
+    : ChunkedBitVector(V.size()) {
+  const BitWord *Data = V.getData();
+  unsigned NumWords = V.getNumWords();
+  for (unsigned I = 0; I < Chunks.size(); ++I) {
+    unsigned Begin = I * ChunkWords;
+    unsigned End = std::min(NumWords, Begin + ChunkWords);
+    if (std::any_of(Data + Begin, Data + End, [](BitWord W) { return W; }))
+      memcpy(getWritableChunk(I), Data + Begin, (End - Begin) * sizeof(BitWord));
+  }
+}
+
+ChunkedBitVector::BitWord *ChunkedBitVector::getWritableChunk(unsigned I) {
+  Chunk *&C = Chunks[I];
+  if (!C) {
+    C = new Chunk;
+    memset(C->Words, 0, sizeof(C->Words));
+  } else if (C->RefCount.load(std::memory_order_acquire) != 1) {
+    // Shared with a snapshot. The acquire above pairs with the release in
+    // release(), so a count of 1 also means every former sharer is done
+    // reading and the chunk may be written in place.
+    Chunk *Copy = new Chunk;
+    memcpy(Copy->Words, C->Words, sizeof(C->Words));
+    release(C);
+    C = Copy;
+  }
+  return C->Words;
+}
+
+ChunkedBitVector::size_type ChunkedBitVector::count() const {
+  unsigned NumBits = 0;
+  for (const Chunk *C : Chunks)
+    if (C)
+      for (BitWord W : C->Words)
+        NumBits += std::popcount(W);
+  return NumBits;
+}
+
+bool ChunkedBitVector::any() const {
+  for (const Chunk *C : Chunks)
+    if (C && std::any_of(C->Words, C->Words + ChunkWords,
+                         [](BitWord W) { return W; }))
+      return true;
+  return false;
+}
+
+int ChunkedBitVector::find_next_from(unsigned Idx) const {
+  for (unsigned I = Idx / ChunkBits; Idx < Size; Idx = ++I * ChunkBits) {
+    const Chunk *C = Chunks[I];
+    if (!C)
+      continue;
+    unsigned Bit = Idx % ChunkBits;
+    BitWord W = C->Words[Bit / BITWORD_SIZE] &
+                maskTrailingZeros<BitWord>(Bit % BITWORD_SIZE);
+    for (unsigned i = Bit / BITWORD_SIZE;;) {
+      if (W)
+        return int(I * ChunkBits + i * BITWORD_SIZE + std::countr_zero(W));
+      if (++i == ChunkWords)
+        break;
+      W = C->Words[i];
+    }
+  }
+  return -1;
+}
+
+NBitVector ChunkedBitVector::toBitVector() const {
+  NBitVector Result(Size);
+  BitWord *Data = Result.getData();
+  unsigned NumWords = Result.getNumWords();
+  for (unsigned I = 0; I < Chunks.size(); ++I) {
+    if (!Chunks[I])
+      continue;
+    unsigned Begin = I * ChunkWords;
+    unsigned End = std::min(NumWords, Begin + ChunkWords);
+    memcpy(Data + Begin, Chunks[I]->Words, (End - Begin) * sizeof(BitWord));
+  }
+  return Result;
+}
+
+std::vector<unsigned>
+ChunkedBitVector::changed_chunks(const ChunkedBitVector &Since) const {
+  assert(Size == Since.Size && "Snapshots of different vectors");
+  std::vector<unsigned> Changed;
+  for (unsigned I = 0; I < Chunks.size(); ++I)
+    if (Chunks[I] != Since.Chunks[I])
+      Changed.push_back(I);
+  return Changed;
+}
+
+bool ChunkedBitVector::operator==(const ChunkedBitVector &RHS) const {
+  if (Size != RHS.Size)
+    return false;
+  for (unsigned I = 0; I < Chunks.size(); ++I) {
+    const Chunk *L = Chunks[I], *R = RHS.Chunks[I];
+    if (L == R)
+      continue;
+    for (unsigned i = 0; i < ChunkWords; ++i)
+      if ((L ? L->Words[i] : 0) != (R ? R->Words[i] : 0))
+        return false;
+  }
+  return true;
+}
+
+size_t ChunkedBitVector::getMemorySize() const {
+  size_t Bytes = Chunks.capacity() * sizeof(Chunk *);
+  for (const Chunk *C : Chunks)
+    if (C)
+      Bytes += sizeof(Chunk);
+  return Bytes;
+}
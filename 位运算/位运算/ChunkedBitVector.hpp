@@ -0,0 +1,205 @@
+//
+//  ChunkedBitVector.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef ChunkedBitVector_hpp
+#define ChunkedBitVector_hpp
+
+#include "NBitVector.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <climits>
+#include <vector>
+
+/// ChunkedBitVector - A fixed-size bit vector stored as 4 KiB chunks behind
+/// a page table of reference-counted chunk pointers, with O(chunks)
+/// snapshots.
+///
+/// Copying the vector (snapshot()) copies the page table and takes a
+/// reference on every chunk; no bits are copied. The first write to a chunk
+/// that is shared with a snapshot copies that chunk (copy-on-write), so a
+/// checkpoint costs one pointer per chunk up front and one chunk copy per
+/// chunk written afterwards. Chunks that were never written are null and
+/// read as zeros.
+///
+/// A chunk pointer only changes when its chunk is written while shared, so
+/// changed_chunks() finds the chunks written since a snapshot by comparing
+/// the page tables, e.g. to persist only those.
+///
+/// A ChunkedBitVector is not thread-safe, but its snapshots are independent
+/// objects: one thread may read (or write) a snapshot while another writes
+/// the vector it was taken from.
+class ChunkedBitVector {
+public:
+  typedef NBitVector::BitWord BitWord;
+  typedef unsigned size_type;
+
+  enum : unsigned {
+    BITWORD_SIZE = (unsigned)sizeof(BitWord) * CHAR_BIT,
+    ChunkBytes = 4096,
+    ChunkWords = ChunkBytes / sizeof(BitWord),
+    ChunkBits = ChunkWords * BITWORD_SIZE
+  };
+
+private:
+  struct Chunk {
+    std::atomic<unsigned> RefCount{1};
+    alignas(64) BitWord Words[ChunkWords];
+  };
+
+  std::vector<Chunk *> Chunks;
+  unsigned Size = 0;
+
+  static void retain(Chunk *C) {
+    if (C)
+      C->RefCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static void release(Chunk *C) {
+    if (C && C->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete C;
+  }
+
+  /// Returns the words of chunk I for writing, allocating it if it is null
+  /// and copying it if it is shared.
+  BitWord *getWritableChunk(unsigned I);
+
+public:
+  ChunkedBitVector() = default;
+
+  /// Creates a vector of s zero bits. No chunks are allocated until written.
+  explicit ChunkedBitVector(unsigned s)
+      : Chunks((s + ChunkBits - 1) / ChunkBits), Size(s) {}
+
+  /// Creates a vector holding the bits of V, allocating only the chunks
+  /// that have a set bit.
+  explicit ChunkedBitVector(const NBitVector &V);
+
+  /// Copies share all chunks, see snapshot().
+  ChunkedBitVector(const ChunkedBitVector &RHS)
+      : Chunks(RHS.Chunks), Size(RHS.Size) {
+    for (Chunk *C : Chunks)
+      retain(C);
+  }
+
+  ChunkedBitVector(ChunkedBitVector &&RHS) noexcept
+      : Chunks(std::move(RHS.Chunks)), Size(RHS.Size) {
+    RHS.Chunks.clear();
+    RHS.Size = 0;
+  }
+
+  ChunkedBitVector &operator=(const ChunkedBitVector &RHS) {
+    if (this != &RHS)
+      *this = ChunkedBitVector(RHS);
+    return *this;
+  }
+
+  ChunkedBitVector &operator=(ChunkedBitVector &&RHS) noexcept {
+    std::swap(Chunks, RHS.Chunks);
+    std::swap(Size, RHS.Size);
+    return *this;
+  }
+
+  ~ChunkedBitVector() {
+    for (Chunk *C : Chunks)
+      release(C);
+  }
+
+  /// snapshot - Returns a copy of the current bits that shares all chunks.
+  /// Costs one reference count increment per chunk.
+  ChunkedBitVector snapshot() const { return *this; }
+
+  bool empty() const { return Size == 0; }
+  size_type size() const { return Size; }
+
+  unsigned getNumChunks() const { return unsigned(Chunks.size()); }
+
+  /// The ChunkWords words of chunk I, or nullptr if the chunk is all zeros
+  /// and has never been written.
+  const BitWord *getChunkData(unsigned I) const {
+    assert(I < Chunks.size() && "Chunk out of range");
+    return Chunks[I] ? Chunks[I]->Words : nullptr;
+  }
+
+  bool test(unsigned Idx) const {
+    assert(Idx < Size && "Out-of-bounds Bit access.");
+    const Chunk *C = Chunks[Idx / ChunkBits];
+    unsigned Bit = Idx % ChunkBits;
+    return C && (C->Words[Bit / BITWORD_SIZE] >> (Bit % BITWORD_SIZE)) & 1;
+  }
+
+  bool operator[](unsigned Idx) const { return test(Idx); }
+
+  /// Setting a set bit or resetting a clear one does not count as a write,
+  /// and leaves a shared chunk shared.
+  ChunkedBitVector &set(unsigned Idx) {
+    if (!test(Idx)) {
+      unsigned Bit = Idx % ChunkBits;
+      getWritableChunk(Idx / ChunkBits)[Bit / BITWORD_SIZE] |=
+          BitWord(1) << (Bit % BITWORD_SIZE);
+    }
+    return *this;
+  }
+
+  ChunkedBitVector &reset(unsigned Idx) {
+    if (test(Idx)) {
+      unsigned Bit = Idx % ChunkBits;
+      getWritableChunk(Idx / ChunkBits)[Bit / BITWORD_SIZE] &=
+          ~(BitWord(1) << (Bit % BITWORD_SIZE));
+    }
+    return *this;
+  }
+
+  /// count - Returns the number of set bits, skipping null chunks.
+  size_type count() const;
+  bool any() const;
+  bool none() const { return !any(); }
+
+  /// find_first - Returns the index of the first set bit, -1 if none.
+  int find_first() const { return find_next_from(0); }
+  /// find_next - Returns the index of the next set bit following Prev, -1
+  /// if none.
+  int find_next(unsigned Prev) const { return find_next_from(Prev + 1); }
+  /// Returns the index of the first set bit at or after Idx, -1 if none.
+  int find_next_from(unsigned Idx) const;
+
+  /// for_each_set_bit - Calls F(Idx) for every set bit, in increasing order.
+  template <typename Fn> void for_each_set_bit(Fn &&F) const {
+    for (unsigned I = 0; I < Chunks.size(); ++I) {
+      if (!Chunks[I])
+        continue;
+      const BitWord *Words = Chunks[I]->Words;
+      for (unsigned i = 0; i < ChunkWords; ++i)
+        for (BitWord W = Words[i]; W; W &= W - 1)
+          F(I * ChunkBits + i * BITWORD_SIZE + std::countr_zero(W));
+    }
+  }
+
+  /// Copies the bits into an NBitVector.
+  NBitVector toBitVector() const;
+
+  /// shares_chunk - Returns true if chunk I of this vector and of Other is
+  /// the same memory, so it is unchanged between them.
+  bool shares_chunk(const ChunkedBitVector &Other, unsigned I) const {
+    return I < Other.Chunks.size() && Chunks[I] == Other.Chunks[I];
+  }
+
+  /// changed_chunks - Returns the indices of the chunks written in this
+  /// vector or in Since after one was copied from the other. Both must come
+  /// from the same original vector. O(chunks): only pointers are compared.
+  std::vector<unsigned> changed_chunks(const ChunkedBitVector &Since) const;
+
+  bool operator==(const ChunkedBitVector &RHS) const;
+  bool operator!=(const ChunkedBitVector &RHS) const { return !(*this == RHS); }
+
+  /// Return the size (in bytes) of the page table and allocated chunks,
+  /// counting shared chunks in full.
+  size_t getMemorySize() const;
+};
+
+#endif /* ChunkedBitVector_hpp */
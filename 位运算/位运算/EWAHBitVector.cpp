@@ -0,0 +1,294 @@
+//
+//  EWAHBitVector.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "EWAHBitVector.hpp"
+
+#include <algorithm>
+
+static_assert(sizeof(NBitVector::BitWord) == sizeof(EWAHBitVector::Word),
+              "Literals are copied from and to NBitVector words");
+
+namespace {
+
+void writeLE(std::vector<uint8_t> &Out, uint64_t V, unsigned Bytes) {
+  for (unsigned i = 0; i < Bytes; ++i)
+    Out.push_back(uint8_t(V >> (8 * i)));
+}
+
+uint64_t readLE(const uint8_t *Data, unsigned Bytes) {
+  uint64_t V = 0;
+  for (unsigned i = 0; i < Bytes; ++i)
+    V |= uint64_t(Data[i]) << (8 * i);
+  return V;
+}
+
+const uint32_t EWAHMagic = 0x31485745; // "EWH1"
+
+typedef EWAHBitVector::Word Word;
+
+struct AndOp {
+  static Word apply(Word L, Word R) { return L & R; }
+};
+struct OrOp {
+  static Word apply(Word L, Word R) { return L | R; }
+};
+struct XorOp {
+  static Word apply(Word L, Word R) { return L ^ R; }
+};
+struct AndNotOp {
+  static Word apply(Word L, Word R) { return L & ~R; }
+};
+
+/// Sink of combine() that only counts the bits of the result.
+struct CountSink {
+  size_t Count = 0;
+
+  void addRun(bool Bit, Word N) {
+    if (Bit)
+      Count += size_t(N) * EWAHBitVector::WORD_SIZE;
+  }
+  void addLiteral(Word W) { Count += std::popcount(W); }
+};
+
+} // end anonymous namespace
+
+class EWAHBitVector::Builder {
+  std::vector<Word> &Out;
+  /// Index of the last marker in Out, or Out.size() if there is none yet.
+  size_t Marker;
+
+  void newMarker() {
+    Marker = Out.size();
+    Out.push_back(0);
+  }
+
+public:
+  explicit Builder(std::vector<Word> &Out) : Out(Out), Marker(Out.size()) {}
+
+  /// Appends N clean words of Bit. They extend the last run if no literals
+  /// have followed it yet.
+  void addRun(bool Bit, Word N) {
+    while (N) {
+      Word M = Marker < Out.size() ? Out[Marker] : 0;
+      if (Marker == Out.size() || numLiterals(M) ||
+          (runLength(M) && runBit(M) != Bit) || runLength(M) == MaxRunLength) {
+        newMarker();
+        continue;
+      }
+      Word Add = std::min(N, MaxRunLength - runLength(M));
+      Out[Marker] = (runLength(M) + Add) << 1 | Word(Bit);
+      N -= Add;
+    }
+  }
+
+  /// Appends one word, as a run if it is clean.
+  void addLiteral(Word W) {
+    if (W == 0 || W == ~Word(0)) {
+      addRun(W != 0, 1);
+      return;
+    }
+    if (Marker == Out.size() || numLiterals(Out[Marker]) == MaxLiterals)
+      newMarker();
+    Out[Marker] += Word(1) << 33;
+    Out.push_back(W);
+  }
+};
+
+template <typename OpT, typename SinkT>
+void EWAHBitVector::combine(const EWAHBitVector &LHS, const EWAHBitVector &RHS,
+                            SinkT &S) {
+  Reader A(LHS.Buffer), B(RHS.Buffer);
+  auto fill = [](bool Bit) { return Bit ? ~Word(0) : Word(0); };
+
+  // One side's run against the other's literals. If the run alone decides
+  // the result, the literals are skipped unread.
+  auto runWithLiterals = [&](Word Fill, const Word *Lit, Word N, bool FillLeft) {
+    Word Lo = FillLeft ? OpT::apply(Fill, 0) : OpT::apply(0, Fill);
+    Word Hi = FillLeft ? OpT::apply(Fill, ~Word(0)) : OpT::apply(~Word(0), Fill);
+    if (Lo == Hi) {
+      S.addRun(Lo != 0, N);
+      return;
+    }
+    for (Word i = 0; i < N; ++i)
+      S.addLiteral(FillLeft ? OpT::apply(Fill, Lit[i]) : OpT::apply(Lit[i], Fill));
+  };
+
+  while (!A.Done || !B.Done) {
+    if (A.Run && B.Run) {
+      Word N = std::min(A.Run, B.Run);
+      S.addRun(OpT::apply(fill(A.Bit), fill(B.Bit)) != 0, N);
+      A.skipRun(N);
+      B.skipRun(N);
+    } else if (A.Run) {
+      Word N = std::min(A.Run, B.Lits);
+      runWithLiterals(fill(A.Bit), B.Lit, N, true);
+      A.skipRun(N);
+      B.skipLiterals(N);
+    } else if (B.Run) {
+      Word N = std::min(B.Run, A.Lits);
+      runWithLiterals(fill(B.Bit), A.Lit, N, false);
+      A.skipLiterals(N);
+      B.skipRun(N);
+    } else {
+      Word N = std::min(A.Lits, B.Lits);
+      for (Word i = 0; i < N; ++i)
+        S.addLiteral(OpT::apply(A.Lit[i], B.Lit[i]));
+      A.skipLiterals(N);
+      B.skipLiterals(N);
+    }
+  }
+}
+
+template <typename OpT>
+EWAHBitVector EWAHBitVector::combine(const EWAHBitVector &LHS,
+                                     const EWAHBitVector &RHS) {
+  EWAHBitVector Result;
+  Result.Size = std::max(LHS.Size, RHS.Size);
+  Builder B(Result.Buffer);
+  combine<OpT>(LHS, RHS, B);
+  return Result;
+}
+
+template <typename OpT>
+size_t EWAHBitVector::combineCount(const EWAHBitVector &LHS,
+                                   const EWAHBitVector &RHS) {
+  CountSink S;
+  combine<OpT>(LHS, RHS, S);
+  return S.Count;
+}
+
+EWAHBitVector::EWAHBitVector(const NBitVector &V) : Size(V.size()) {
+  Builder B(Buffer);
+  const NBitVector::BitWord *Data = V.getData();
+  for (unsigned i = 0, e = NumWords(Size); i < e; ++i)
+    B.addLiteral(Data[i]);
+}
+
+NBitVector EWAHBitVector::decompress() const {
+  NBitVector Result(Size);
+  NBitVector::BitWord *Out = Result.getData();
+  for (size_t i = 0; i < Buffer.size();) {
+    Word M = Buffer[i++];
+    if (runBit(M))
+      std::fill_n(Out, runLength(M), ~NBitVector::BitWord(0));
+    Out += runLength(M);
+    for (Word n = numLiterals(M); n; --n)
+      *Out++ = Buffer[i++];
+  }
+  return Result;
+}
+
+bool EWAHBitVector::test(unsigned Idx) const {
+  assert(Idx < Size && "Out-of-bounds Bit access.");
+  Word W = Idx / WORD_SIZE;
+  for (size_t i = 0; i < Buffer.size();) {
+    Word M = Buffer[i++];
+    if (W < runLength(M))
+      return runBit(M);
+    W -= runLength(M);
+    if (W < numLiterals(M))
+      return (Buffer[i + W] >> (Idx % WORD_SIZE)) & 1;
+    W -= numLiterals(M);
+    i += numLiterals(M);
+  }
+  return false;
+}
+
+EWAHBitVector::size_type EWAHBitVector::count() const {
+  size_t NumBits = 0;
+  for (size_t i = 0; i < Buffer.size();) {
+    Word M = Buffer[i++];
+    if (runBit(M))
+      NumBits += runLength(M) * WORD_SIZE;
+    for (Word n = numLiterals(M); n; --n)
+      NumBits += std::popcount(Buffer[i++]);
+  }
+  return size_type(NumBits);
+}
+
+bool EWAHBitVector::any() const {
+  // Literals are never zero, so any literal or run of ones has a set bit.
+  for (size_t i = 0; i < Buffer.size(); i += 1 + numLiterals(Buffer[i]))
+    if (numLiterals(Buffer[i]) || (runBit(Buffer[i]) && runLength(Buffer[i])))
+      return true;
+  return false;
+}
+
+EWAHBitVector operator&(const EWAHBitVector &LHS, const EWAHBitVector &RHS) {
+  return EWAHBitVector::combine<AndOp>(LHS, RHS);
+}
+
+EWAHBitVector operator|(const EWAHBitVector &LHS, const EWAHBitVector &RHS) {
+  return EWAHBitVector::combine<OrOp>(LHS, RHS);
+}
+
+EWAHBitVector operator^(const EWAHBitVector &LHS, const EWAHBitVector &RHS) {
+  return EWAHBitVector::combine<XorOp>(LHS, RHS);
+}
+
+EWAHBitVector andNot(const EWAHBitVector &LHS, const EWAHBitVector &RHS) {
+  return EWAHBitVector::combine<AndNotOp>(LHS, RHS);
+}
+
+size_t andCount(const EWAHBitVector &LHS, const EWAHBitVector &RHS) {
+  return EWAHBitVector::combineCount<AndOp>(LHS, RHS);
+}
+
+size_t orCount(const EWAHBitVector &LHS, const EWAHBitVector &RHS) {
+  return EWAHBitVector::combineCount<OrOp>(LHS, RHS);
+}
+
+size_t xorCount(const EWAHBitVector &LHS, const EWAHBitVector &RHS) {
+  return EWAHBitVector::combineCount<XorOp>(LHS, RHS);
+}
+
+size_t andNotCount(const EWAHBitVector &LHS, const EWAHBitVector &RHS) {
+  return EWAHBitVector::combineCount<AndNotOp>(LHS, RHS);
+}
+
+void EWAHBitVector::serialize(std::vector<uint8_t> &Out) const {
+  writeLE(Out, EWAHMagic, 4);
+  writeLE(Out, Size, 4);
+  writeLE(Out, Buffer.size(), 4);
+  for (Word W : Buffer)
+    writeLE(Out, W, sizeof(Word));
+}
+
+bool EWAHBitVector::deserialize(const uint8_t *Data, size_t Length) {
+  Buffer.clear();
+  Size = 0;
+  if (Length < 12 || readLE(Data, 4) != EWAHMagic)
+    return false;
+  unsigned NewSize = unsigned(readLE(Data + 4, 4));
+  size_t N = size_t(readLE(Data + 8, 4));
+  if ((Length - 12) / sizeof(Word) < N)
+    return false;
+
+  // Re-encode the words through a Builder rather than trusting the stream
+  // to be canonical, checking that they cover exactly NewSize bits.
+  std::vector<Word> NewBuffer;
+  Builder B(NewBuffer);
+  const uint8_t *P = Data + 12;
+  Word Words = 0, Last = 0;
+  for (size_t i = 0; i < N;) {
+    Word M = readLE(P + i++ * sizeof(Word), sizeof(Word));
+    if (numLiterals(M) > N - i)
+      return false;
+    B.addRun(runBit(M), runLength(M));
+    Words += runLength(M);
+    if (runLength(M))
+      Last = runBit(M) ? ~Word(0) : 0;
+    for (Word n = numLiterals(M); n; --n, ++Words)
+      B.addLiteral(Last = readLE(P + i++ * sizeof(Word), sizeof(Word)));
+  }
+  if (Words != NumWords(NewSize) ||
+      (NewSize % WORD_SIZE && Last >> (NewSize % WORD_SIZE)))
+    return false;
+  Buffer = std::move(NewBuffer);
+  Size = NewSize;
+  return true;
+}
@@ -0,0 +1,263 @@
+//
+//  EWAHBitVector.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef EWAHBitVector_hpp
+#define EWAHBitVector_hpp
+
+#include "NBitVector.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+/// EWAHBitVector - An immutable, run-length compressed NBitVector in the
+/// "Enhanced Word-Aligned Hybrid" encoding.
+///
+/// The bits are cut into 64-bit words. Runs of all-zero or all-one words
+/// ("clean" words) are stored as a count; any other ("dirty") word is stored
+/// verbatim as a literal. The stream is a sequence of marker words, each
+/// followed by its literals:
+///   bit 0       the bit value of the clean run
+///   bits 1-32   number of clean words in the run
+///   bits 33-63  number of literal words after the marker
+/// so a marker describes RunLength clean words followed by NumLiterals dirty
+/// ones.
+///
+/// The binary operations and their counts walk both streams at once, a run
+/// or a block of literals at a time: two runs combine in O(1) whatever their
+/// length, and a run that decides the result (0 for AND, 1 for OR) skips the
+/// other side's literals unread. Long runs, such as in page or liveness
+/// bitmaps, are thus never expanded. Random access is a linear scan of the
+/// markers; use decompress() or the set-bit iterator for repeated queries.
+class EWAHBitVector {
+public:
+  typedef uint64_t Word;
+  typedef unsigned size_type;
+
+  enum : unsigned { WORD_SIZE = 64 };
+
+  static constexpr Word MaxRunLength = (Word(1) << 32) - 1;
+  static constexpr Word MaxLiterals = (Word(1) << 31) - 1;
+
+private:
+  std::vector<Word> Buffer;
+  unsigned Size = 0;
+
+  static unsigned NumWords(unsigned S) { return (S + WORD_SIZE - 1) / WORD_SIZE; }
+
+  static bool runBit(Word Marker) { return Marker & 1; }
+  static Word runLength(Word Marker) { return (Marker >> 1) & MaxRunLength; }
+  static Word numLiterals(Word Marker) { return Marker >> 33; }
+
+  /// Reader - Walks a stream run by run and literal by literal. Past the
+  /// end it reads as an endless run of zeros, so that a shorter operand
+  /// behaves as if zero-extended.
+  struct Reader {
+    const Word *P, *End;
+    Word Run = 0, Lits = 0;
+    const Word *Lit = nullptr;
+    bool Bit = false;
+    bool Done = false;
+
+    Reader() : P(nullptr), End(nullptr) { refill(); }
+    explicit Reader(const std::vector<Word> &Buffer)
+        : P(Buffer.data()), End(Buffer.data() + Buffer.size()) {
+      refill();
+    }
+
+    /// Loads the next marker once the current one is used up.
+    void refill() {
+      while (!Run && !Lits) {
+        if (P == End) {
+          Done = true;
+          Bit = false;
+          Run = ~Word(0);
+          return;
+        }
+        Word M = *P++;
+        Bit = runBit(M);
+        Run = runLength(M);
+        Lits = numLiterals(M);
+        Lit = P;
+        P += Lits;
+      }
+    }
+    void skipRun(Word N) {
+      if (!Done) {
+        Run -= N;
+        refill();
+      }
+    }
+    void skipLiterals(Word N) {
+      Lit += N;
+      Lits -= N;
+      refill();
+    }
+  };
+
+  /// Builder - Appends words to a stream, merging clean words into runs.
+  class Builder;
+
+  /// Walks LHS and RHS together, feeding Op of their words to S.
+  template <typename OpT, typename SinkT>
+  static void combine(const EWAHBitVector &LHS, const EWAHBitVector &RHS,
+                      SinkT &S);
+
+  template <typename OpT>
+  static EWAHBitVector combine(const EWAHBitVector &LHS,
+                               const EWAHBitVector &RHS);
+  template <typename OpT>
+  static size_t combineCount(const EWAHBitVector &LHS,
+                             const EWAHBitVector &RHS);
+
+public:
+  EWAHBitVector() = default;
+
+  /// Compresses V.
+  explicit EWAHBitVector(const NBitVector &V);
+
+  /// decompress - Returns the bits as an NBitVector of size() bits.
+  NBitVector decompress() const;
+
+  bool empty() const { return Size == 0; }
+  size_type size() const { return Size; }
+
+  /// test - Returns bit Idx. Linear in the number of markers.
+  bool test(unsigned Idx) const;
+  bool operator[](unsigned Idx) const { return test(Idx); }
+
+  /// count - Returns the number of set bits, reading only the markers and
+  /// the literals.
+  size_type count() const;
+  bool any() const;
+  bool none() const { return !any(); }
+
+  /// The results have the size of the larger operand; the smaller one reads
+  /// as zero-extended.
+  friend EWAHBitVector operator&(const EWAHBitVector &LHS,
+                                 const EWAHBitVector &RHS);
+  friend EWAHBitVector operator|(const EWAHBitVector &LHS,
+                                 const EWAHBitVector &RHS);
+  friend EWAHBitVector operator^(const EWAHBitVector &LHS,
+                                 const EWAHBitVector &RHS);
+  /// andNot - Returns the bits of LHS that are not set in RHS.
+  friend EWAHBitVector andNot(const EWAHBitVector &LHS,
+                              const EWAHBitVector &RHS);
+
+  /// The counts of the operators above, without building the result.
+  friend size_t andCount(const EWAHBitVector &LHS, const EWAHBitVector &RHS);
+  friend size_t orCount(const EWAHBitVector &LHS, const EWAHBitVector &RHS);
+  friend size_t xorCount(const EWAHBitVector &LHS, const EWAHBitVector &RHS);
+  friend size_t andNotCount(const EWAHBitVector &LHS,
+                            const EWAHBitVector &RHS);
+
+  /// The encoding is canonical, so equal bits mean equal streams.
+  bool operator==(const EWAHBitVector &RHS) const {
+    return Size == RHS.Size && Buffer == RHS.Buffer;
+  }
+  bool operator!=(const EWAHBitVector &RHS) const { return !(*this == RHS); }
+
+  /// const_iterator - Streams the indices of the set bits in increasing
+  /// order, decoding one word at a time.
+  class const_iterator {
+    Reader R;
+    Word Cur = 0;
+    unsigned WordIdx = 0;
+    unsigned Base = 0;
+
+    void advance() {
+      while (!Cur) {
+        if (R.Done)
+          return;
+        if (R.Run) {
+          if (!R.Bit) {
+            WordIdx += unsigned(R.Run);
+            R.skipRun(R.Run);
+            continue;
+          }
+          Cur = ~Word(0);
+          R.skipRun(1);
+        } else {
+          Cur = *R.Lit;
+          R.skipLiterals(1);
+        }
+        Base = WordIdx++ * WORD_SIZE;
+      }
+    }
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef unsigned value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const unsigned *pointer;
+    typedef unsigned reference;
+
+    /// An iterator at the end of any vector.
+    const_iterator() = default;
+    explicit const_iterator(const EWAHBitVector &V) : R(V.Buffer) { advance(); }
+
+    unsigned operator*() const { return Base + std::countr_zero(Cur); }
+
+    const_iterator &operator++() {
+      Cur &= Cur - 1;
+      advance();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator Tmp = *this;
+      ++*this;
+      return Tmp;
+    }
+
+    /// Only iterators of the same vector compare meaningfully; all end
+    /// iterators are equal.
+    bool operator==(const const_iterator &RHS) const {
+      if (!Cur || !RHS.Cur)
+        return !Cur && !RHS.Cur;
+      return **this == *RHS;
+    }
+    bool operator!=(const const_iterator &RHS) const { return !(*this == RHS); }
+  };
+
+  const_iterator begin() const { return const_iterator(*this); }
+  const_iterator end() const { return const_iterator(); }
+
+  /// for_each_set_bit - Calls F(Idx) for every set bit, in increasing order.
+  template <typename Fn> void for_each_set_bit(Fn &&F) const {
+    unsigned Pos = 0;
+    for (size_t i = 0; i < Buffer.size();) {
+      Word M = Buffer[i++];
+      Word Run = runLength(M);
+      if (runBit(M))
+        for (Word End = Pos + Run * WORD_SIZE; Pos < End; ++Pos)
+          F(Pos);
+      else
+        Pos += unsigned(Run * WORD_SIZE);
+      for (Word n = numLiterals(M); n; --n, Pos += WORD_SIZE)
+        for (Word W = Buffer[i++]; W; W &= W - 1)
+          F(Pos + unsigned(std::countr_zero(W)));
+    }
+  }
+
+  /// The encoded stream, see the class comment.
+  const std::vector<Word> &getBuffer() const { return Buffer; }
+
+  /// Return the size (in bytes) of the compressed stream.
+  size_t getMemorySize() const { return Buffer.size() * sizeof(Word); }
+
+  /// serialize - Append a little-endian encoding to Out: uint32 magic
+  /// "EWH1", uint32 size in bits, uint32 stream length in words, the stream.
+  void serialize(std::vector<uint8_t> &Out) const;
+  /// deserialize - Replace the vector by the one encoded in Data. Returns
+  /// false and leaves the vector empty if Data is malformed.
+  bool deserialize(const uint8_t *Data, size_t Length);
+};
+
+#endif /* EWAHBitVector_hpp */
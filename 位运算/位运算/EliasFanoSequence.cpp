@@ -0,0 +1,88 @@
+//
+//  EliasFanoSequence.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "EliasFanoSequence.hpp"
+#include "RankSelect.hpp"
+
+#include <climits>
+
+EliasFanoSequence::Builder::Builder(size_t N, uint64_t Universe) {
+  assert((Universe || !N) && "Values need a non-empty universe");
+  unsigned L = 0;
+  if (N && Universe > N)
+    L = unsigned(std::bit_width(Universe / N)) - 1;
+  uint64_t NumBuckets = N ? ((Universe - 1) >> L) + 1 : 0;
+  assert(N + NumBuckets <= UINT_MAX && "Too many values for an NBitVector");
+  Seq.NumValues = N;
+  Seq.Universe = Universe;
+  Seq.L = L;
+  Seq.HighBits = NBitVector(unsigned(N + NumBuckets));
+  Seq.LowBits.assign(size_t((uint64_t(N) * L + 63) / 64) + 1, 0);
+}
+
+EliasFanoSequence EliasFanoSequence::Builder::build() {
+  assert(Pushed == Seq.NumValues && "Fewer values than announced");
+  Seq.buildIndex();
+  Last = 0;
+  Pushed = 0;
+  return std::move(Seq);
+}
+
+void EliasFanoSequence::buildIndex() {
+  // Sample every SampleRate-th zero and one in one pass.
+  const BitWord *Words = HighBits.getData();
+  unsigned NumWords = HighBits.getNumWords();
+  uint64_t Seen[2] = {0, 0};
+  for (unsigned W = 0; W < NumWords; ++W) {
+    BitWord Valid = ~BitWord(0);
+    if (W + 1 == NumWords && HighBits.size() % 64)
+      Valid = maskTrailingOnes<BitWord>(HighBits.size() % 64);
+    for (unsigned B = 0; B < 2; ++B) {
+      BitWord Word = (B ? Words[W] : ~Words[W]) & Valid;
+      unsigned Count = std::popcount(Word);
+      for (uint64_t Next = uint64_t(Samples[B].size()) * SampleRate;
+           Next < Seen[B] + Count; Next += SampleRate)
+        Samples[B].push_back(W * 64 + RankSelectIndex::selectInWord(
+                                           Word, unsigned(Next - Seen[B])));
+      Seen[B] += Count;
+    }
+  }
+}
+
+template <bool Bit> unsigned EliasFanoSequence::select(uint64_t K) const {
+  unsigned Pos = Samples[Bit][size_t(K / SampleRate)];
+  unsigned Rem = unsigned(K % SampleRate);
+  const BitWord *Words = HighBits.getData();
+  unsigned W = Pos / 64;
+  BitWord Word = (Bit ? Words[W] : ~Words[W]) &
+                 maskTrailingZeros<BitWord>(Pos % 64);
+  for (;;) {
+    unsigned Count = std::popcount(Word);
+    if (Rem < Count)
+      break;
+    Rem -= Count;
+    ++W;
+    Word = Bit ? Words[W] : ~Words[W];
+  }
+  return W * 64 + RankSelectIndex::selectInWord(Word, Rem);
+}
+
+template unsigned EliasFanoSequence::select<true>(uint64_t K) const;
+
+EliasFanoSequence::const_iterator
+EliasFanoSequence::next_geq(uint64_t X) const {
+  uint64_t H = X >> L;
+  if (H >= HighBits.size() - NumValues)
+    return end();
+  // Bucket H starts one past zero H - 1, and the H zeros before it put
+  // value P - H there.
+  unsigned P = H ? select<false>(H - 1) + 1 : 0;
+  const_iterator It(*this, P - H, P);
+  while (It.I < NumValues && *It < X)
+    ++It;
+  return It;
+}
@@ -0,0 +1,269 @@
+//
+//  EliasFanoSequence.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef EliasFanoSequence_hpp
+#define EliasFanoSequence_hpp
+
+#include "NBitVector.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// EliasFanoSequence - An immutable, compressed sequence of non-decreasing
+/// integers, e.g. a posting list or an offset table, with constant time
+/// random access and successor queries.
+///
+/// For N values below Universe, each value is split into its low
+/// L = floor(log2(Universe / N)) bits and the remaining high bits:
+///   - the low bits are packed back to back into LowBits;
+///   - value i sets bit (Value >> L) + i of the NBitVector HighBits, i.e.
+///     the high parts are stored in unary, bucket h being the run of ones
+///     preceded by h zeros.
+/// That is at most 2 + L bits per value, against 64 for a uint64_t array.
+///
+/// access(i) is a select1(i) on HighBits plus one read of the low bits.
+/// next_geq(x) finds the start of bucket x >> L with a select0 and scans that
+/// bucket, which holds about one value on average. Both selects start from
+/// the sampled position of every SampleRate-th zero or one and scan the
+/// words after it: HighBits is about half ones, so that is some 512 bits and
+/// a query touches a sample, one or two lines of HighBits and one of
+/// LowBits. (RankSelectIndex::select1 binary searches its rank blocks
+/// instead, a few more dependent misses.) Iteration decodes HighBits a word
+/// at a time.
+class EliasFanoSequence {
+public:
+  typedef uint64_t value_type;
+  typedef NBitVector::BitWord BitWord;
+
+  /// Every SampleRate-th zero and one of HighBits is sampled for select.
+  enum : unsigned { SampleRate = 256 };
+
+  class Builder;
+  class const_iterator;
+
+private:
+  NBitVector HighBits;
+  /// Samples[B][i] is the position in HighBits of the (i * SampleRate)-th
+  /// bit with value B, for select0 and select1.
+  std::vector<uint32_t> Samples[2];
+  /// N values of L bits each, plus one padding word so that a value that
+  /// straddles two words can always read both.
+  std::vector<uint64_t> LowBits;
+  size_t NumValues = 0;
+  uint64_t Universe = 0;
+  unsigned L = 0;
+
+  uint64_t low(size_t I) const {
+    if (!L)
+      return 0;
+    uint64_t Bit = uint64_t(I) * L;
+    size_t W = size_t(Bit / 64);
+    unsigned Shift = unsigned(Bit % 64);
+    uint64_t V = LowBits[W] >> Shift;
+    if (Shift + L > 64)
+      V |= LowBits[W + 1] << (64 - Shift);
+    return V & maskTrailingOnes<uint64_t>(L);
+  }
+
+  /// Returns the position of the K-th (0-based) bit of HighBits with value
+  /// Bit, which must exist.
+  template <bool Bit> unsigned select(uint64_t K) const;
+
+  void buildIndex();
+
+public:
+  EliasFanoSequence() = default;
+
+  /// Encodes the non-decreasing values in [Begin, End), with a universe of
+  /// one past the last value. For input that can only be read once, use a
+  /// Builder.
+  template <typename InputIt>
+  EliasFanoSequence(InputIt Begin, InputIt End);
+
+  EliasFanoSequence(const EliasFanoSequence &) = default;
+  EliasFanoSequence &operator=(const EliasFanoSequence &) = default;
+  /// Moves leave RHS empty.
+  EliasFanoSequence(EliasFanoSequence &&RHS) noexcept
+      : HighBits(std::move(RHS.HighBits)),
+        Samples{std::move(RHS.Samples[0]), std::move(RHS.Samples[1])},
+        LowBits(std::move(RHS.LowBits)), NumValues(RHS.NumValues),
+        Universe(RHS.Universe), L(RHS.L) {
+    RHS.clear();
+  }
+  EliasFanoSequence &operator=(EliasFanoSequence &&RHS) noexcept {
+    if (this != &RHS) {
+      HighBits = std::move(RHS.HighBits);
+      Samples[0] = std::move(RHS.Samples[0]);
+      Samples[1] = std::move(RHS.Samples[1]);
+      LowBits = std::move(RHS.LowBits);
+      NumValues = RHS.NumValues;
+      Universe = RHS.Universe;
+      L = RHS.L;
+      RHS.clear();
+    }
+    return *this;
+  }
+
+  /// clear - Removes all values.
+  void clear() {
+    HighBits = NBitVector();
+    Samples[0].clear();
+    Samples[1].clear();
+    LowBits.clear();
+    NumValues = 0;
+    Universe = 0;
+    L = 0;
+  }
+
+  size_t size() const { return NumValues; }
+  bool empty() const { return NumValues == 0; }
+
+  /// Every value is below universe().
+  uint64_t universe() const { return Universe; }
+  /// The number of low bits stored per value.
+  unsigned getLowBitWidth() const { return L; }
+
+  /// access - Returns value I. I < size().
+  uint64_t access(size_t I) const {
+    assert(I < NumValues && "Out-of-bounds access");
+    uint64_t High = select<true>(I) - I;
+    return (High << L) | low(I);
+  }
+  uint64_t operator[](size_t I) const { return access(I); }
+
+  /// const_iterator - Decodes the values in order, one HighBits word at a
+  /// time. index() is the position of the current value in the sequence.
+  class const_iterator {
+    const EliasFanoSequence *Seq = nullptr;
+    size_t I = 0;
+    unsigned WordIdx = 0;
+    BitWord Cur = 0;
+    uint64_t Value = 0;
+
+    friend class EliasFanoSequence;
+
+    /// An iterator at value I, whose one in HighBits is at Pos.
+    const_iterator(const EliasFanoSequence &S, size_t Idx, unsigned Pos)
+        : Seq(&S), I(Idx), WordIdx(Pos / 64) {
+      if (I == S.NumValues)
+        return;
+      Cur = S.HighBits.getData()[WordIdx] &
+            maskTrailingZeros<BitWord>(Pos % 64);
+      decode();
+    }
+
+    void decode() {
+      while (!Cur)
+        Cur = Seq->HighBits.getData()[++WordIdx];
+      uint64_t Pos = uint64_t(WordIdx) * 64 + std::countr_zero(Cur);
+      Value = ((Pos - I) << Seq->L) | Seq->low(I);
+    }
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef uint64_t value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const uint64_t *pointer;
+    typedef uint64_t reference;
+
+    const_iterator() = default;
+
+    uint64_t operator*() const { return Value; }
+    size_t index() const { return I; }
+
+    const_iterator &operator++() {
+      Cur &= Cur - 1;
+      if (++I < Seq->NumValues)
+        decode();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator Tmp = *this;
+      ++*this;
+      return Tmp;
+    }
+
+    /// Only iterators of the same sequence compare meaningfully.
+    bool operator==(const const_iterator &RHS) const { return I == RHS.I; }
+    bool operator!=(const const_iterator &RHS) const { return I != RHS.I; }
+  };
+
+  const_iterator begin() const { return const_iterator(*this, 0, 0); }
+  const_iterator end() const { return const_iterator(*this, NumValues, 0); }
+
+  /// next_geq - Returns an iterator at the first value >= X, or end() if
+  /// there is none. Iterating on from it walks the rest of the sequence,
+  /// e.g. to intersect posting lists.
+  const_iterator next_geq(uint64_t X) const;
+
+  /// The unary-coded high parts, see the class comment.
+  const NBitVector &getHighBits() const { return HighBits; }
+
+  /// Return the size (in bytes) of the encoding and its indexes.
+  size_t getMemorySize() const {
+    return HighBits.getNumWords() * sizeof(BitWord) +
+           (Samples[0].size() + Samples[1].size()) * sizeof(uint32_t) +
+           LowBits.size() * sizeof(uint64_t);
+  }
+};
+
+/// Builder - Encodes a non-decreasing stream of values one at a time, e.g.
+/// while merging or reading posting lists, given only the number of values
+/// and an upper bound on them up front.
+class EliasFanoSequence::Builder {
+  EliasFanoSequence Seq;
+  uint64_t Last = 0;
+  size_t Pushed = 0;
+
+public:
+  /// Prepares for exactly N values, all below Universe.
+  Builder(size_t N, uint64_t Universe);
+
+  /// push_back - Appends V, which must be at least the previous value and
+  /// below the universe.
+  void push_back(uint64_t V) {
+    assert(Pushed < Seq.NumValues && "More values than announced");
+    assert(V >= Last && V < Seq.Universe && "Value out of order or range");
+    uint64_t High = V >> Seq.L;
+    Seq.HighBits.set(unsigned(High + Pushed));
+    if (Seq.L) {
+      uint64_t Bit = uint64_t(Pushed) * Seq.L;
+      uint64_t Low = V & maskTrailingOnes<uint64_t>(Seq.L);
+      unsigned Shift = unsigned(Bit % 64);
+      Seq.LowBits[size_t(Bit / 64)] |= Low << Shift;
+      if (Shift + Seq.L > 64)
+        Seq.LowBits[size_t(Bit / 64) + 1] |= Low >> (64 - Shift);
+    }
+    Last = V;
+    ++Pushed;
+  }
+
+  /// build - Returns the finished sequence. All N values must have been
+  /// pushed. The builder is left empty.
+  EliasFanoSequence build();
+};
+
+template <typename InputIt>
+EliasFanoSequence::EliasFanoSequence(InputIt Begin, InputIt End) {
+  static_assert(std::is_base_of_v<std::forward_iterator_tag,
+                                  typename std::iterator_traits<
+                                      InputIt>::iterator_category>,
+                "Two passes are needed; use a Builder for single-pass input");
+  size_t N = size_t(std::distance(Begin, End));
+  Builder B(N, N ? uint64_t(*std::next(Begin, N - 1)) + 1 : 0);
+  for (; Begin != End; ++Begin)
+    B.push_back(uint64_t(*Begin));
+  *this = B.build();
+}
+
+#endif /* EliasFanoSequence_hpp */
@@ -9,10 +9,13 @@
 #define GCBitset_hpp
 
 #include <stdio.h>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <cstdint>
 
+#include "SetBitIterator.hpp"
+
 #define panda_bit_utils_ctz __builtin_ctz      // NOLINT(cppcoreguidelines-macro-usage)
 #define panda_bit_utils_ctzll __builtin_ctzll  // NOLINT(cppcoreguidelines-macro-usage)
 
@@ -78,14 +81,212 @@ public:
   
   template <AccessType mode = AccessType::NON_ATOMIC>
   bool SetBit(uintptr_t offset);
-  
-  void ClearBit(uintptr_t offset) {
-    Words()[Index(offset)] &= ~Mask(IndexInWord(offset));
+
+  // Iterate the offsets of the set bits of a bitset of bitSize bytes.
+  SetBitRange<GCBitsetWord> SetBits(size_t bitSize) const {
+    return SetBitRange<GCBitsetWord>(Words(), WordCount(bitSize) * BIT_PER_WORD);
+  }
+
+  template <typename Visitor>
+  void IterateSetBits(size_t bitSize, Visitor &&visitor) const {
+    forEachSetBitInWords(Words(), WordCount(bitSize) * BIT_PER_WORD, visitor);
   }
   
+  template <AccessType mode = AccessType::NON_ATOMIC>
+  void ClearBit(uintptr_t offset);
+
+  template <AccessType mode = AccessType::NON_ATOMIC>
+  bool TestBit(uintptr_t offset) const;
+
+  // Set or clear all bits in [offsetBegin, offsetEnd). Only the two edge words
+  // need a read-modify-write, the words in between are stored whole.
+  template <AccessType mode = AccessType::NON_ATOMIC>
+  void SetBitsInRange(uintptr_t offsetBegin, uintptr_t offsetEnd) {
+    ApplyBitRange<mode, true>(offsetBegin, offsetEnd);
+  }
+
+  template <AccessType mode = AccessType::NON_ATOMIC>
+  void ClearBitsInRange(uintptr_t offsetBegin, uintptr_t offsetEnd) {
+    ApplyBitRange<mode, false>(offsetBegin, offsetEnd);
+  }
+
+  // Calls visitor(offset) for every set bit in [offsetBegin, offsetEnd), in
+  // increasing order. Each word is loaded once and its set bits are peeled
+  // off with ctz, so empty words cost one test.
+  template <AccessType mode = AccessType::NON_ATOMIC, typename Visitor>
+  void IterateMarkedBits(uintptr_t offsetBegin, uintptr_t offsetEnd, Visitor &&visitor) const {
+    ForEachWordInRange<mode>(offsetBegin, offsetEnd, [&](size_t index, GCBitsetWord word) {
+      for (; word != 0; word &= word - 1) {
+        visitor((index << BIT_PER_WORD_LOG2) + panda_bit_utils_ctz(word));
+      }
+    });
+  }
+
+  // Number of set bits in [offsetBegin, offsetEnd), one popcount per word.
+  template <AccessType mode = AccessType::NON_ATOMIC>
+  size_t CountMarkedBits(uintptr_t offsetBegin, uintptr_t offsetEnd) const {
+    size_t count = 0;
+    ForEachWordInRange<mode>(offsetBegin, offsetEnd, [&](size_t, GCBitsetWord word) {
+      count += static_cast<size_t>(__builtin_popcount(word));
+    });
+    return count;
+  }
+
+  // Finds the first run of at least minLength clear bits in [offsetBegin,
+  // offsetEnd), e.g. a gap between live objects big enough to reuse. On
+  // success [*runBegin, *runEnd) is the whole run, cut at offsetEnd. Full and
+  // empty words are skipped a word at a time.
+  template <AccessType mode = AccessType::NON_ATOMIC>
+  bool FindNextFreeRun(uintptr_t offsetBegin, uintptr_t offsetEnd, size_t minLength,
+                       uintptr_t *runBegin, uintptr_t *runEnd) const {
+    uintptr_t offset = offsetBegin;
+    while (offset < offsetEnd) {
+      uintptr_t begin = FindNextBit<mode, false>(offset, offsetEnd);
+      if (begin == offsetEnd) {
+        return false;
+      }
+      uintptr_t end = FindNextBit<mode, true>(begin, offsetEnd);
+      if (end - begin >= minLength) {
+        *runBegin = begin;
+        *runEnd = end;
+        return true;
+      }
+      offset = end;
+    }
+    return false;
+  }
+
+  // Number of regions of regionBits bits in a bitset of bitSize bytes, the
+  // last one possibly partial.
+  static size_t RegionCount(size_t bitSize, size_t regionBits) {
+    return (bitSize * BIT_PER_BYTE + regionBits - 1) / regionBits;
+  }
+
+  // Fills liveBytes[0, RegionCount(bitSize, regionBits)) with the live bytes
+  // of each region of a bitset of bitSize bytes, every set bit standing for
+  // bytesPerBit bytes of heap. A parallel sweeper can instead give each
+  // thread its own regions and call CountMarkedBits on them.
+  template <AccessType mode = AccessType::NON_ATOMIC>
+  void CollectLiveBytesPerRegion(size_t bitSize, size_t regionBits, size_t bytesPerBit,
+                                 size_t *liveBytes) const {
+    size_t totalBits = WordCount(bitSize) * BIT_PER_WORD;
+    for (size_t i = 0, begin = 0; begin < totalBits; i++, begin += regionBits) {
+      size_t end = begin + regionBits < totalBits ? begin + regionBits : totalBits;
+      liveBytes[i] = CountMarkedBits<mode>(begin, end) * bytesPerBit;
+    }
+  }
+
 private:
+  using AtomicWord = std::atomic<GCBitsetWord>;
+  static_assert(sizeof(AtomicWord) == sizeof(GCBitsetWord) && AtomicWord::is_always_lock_free,
+                "GCBitset words are accessed in place as atomics");
+
+  AtomicWord *AtomicWordAt(size_t index) {
+    return reinterpret_cast<AtomicWord *>(&Words()[index]);
+  }
+
+  const AtomicWord *AtomicWordAt(size_t index) const {
+    return reinterpret_cast<const AtomicWord *>(&Words()[index]);
+  }
+
+  template <AccessType mode, bool value>
+  void ApplyWordMask(size_t index, GCBitsetWord mask) {
+    if constexpr (mode == AccessType::ATOMIC) {
+      if (value) {
+        AtomicWordAt(index)->fetch_or(mask, std::memory_order_release);
+      } else {
+        AtomicWordAt(index)->fetch_and(~mask, std::memory_order_release);
+      }
+    } else {
+      if (value) {
+        Words()[index] |= mask;
+      } else {
+        Words()[index] &= ~mask;
+      }
+    }
+  }
+
+  template <AccessType mode, bool value>
+  void ApplyBitRange(uintptr_t offsetBegin, uintptr_t offsetEnd) {
+    assert(offsetBegin <= offsetEnd);
+    if (offsetBegin == offsetEnd) {
+      return;
+    }
+    size_t beginIndex = Index(offsetBegin);
+    size_t endIndex = Index(offsetEnd - 1);
+    GCBitsetWord beginMask = ~GCBitsetWord(0) << IndexInWord(offsetBegin);
+    GCBitsetWord endMask = ~GCBitsetWord(0) >> (BIT_PER_WORD_MASK - IndexInWord(offsetEnd - 1));
+    if (beginIndex == endIndex) {
+      ApplyWordMask<mode, value>(beginIndex, beginMask & endMask);
+      return;
+    }
+    ApplyWordMask<mode, value>(beginIndex, beginMask);
+    GCBitsetWord fill = value ? ~GCBitsetWord(0) : 0;
+    for (size_t i = beginIndex + 1; i < endIndex; i++) {
+      if constexpr (mode == AccessType::ATOMIC) {
+        AtomicWordAt(i)->store(fill, std::memory_order_release);
+      } else {
+        Words()[i] = fill;
+      }
+    }
+    ApplyWordMask<mode, value>(endIndex, endMask);
+  }
+
+  template <AccessType mode>
+  GCBitsetWord LoadWord(size_t index) const {
+    if constexpr (mode == AccessType::ATOMIC) {
+      return AtomicWordAt(index)->load(std::memory_order_acquire);
+    } else {
+      return Words()[index];
+    }
+  }
+
+  // Calls fn(index, word) for every word overlapping [offsetBegin,
+  // offsetEnd), with the bits outside the range masked off.
+  template <AccessType mode, typename Fn>
+  void ForEachWordInRange(uintptr_t offsetBegin, uintptr_t offsetEnd, Fn &&fn) const {
+    assert(offsetBegin <= offsetEnd);
+    if (offsetBegin == offsetEnd) {
+      return;
+    }
+    size_t beginIndex = Index(offsetBegin);
+    size_t endIndex = Index(offsetEnd - 1);
+    GCBitsetWord beginMask = ~GCBitsetWord(0) << IndexInWord(offsetBegin);
+    GCBitsetWord endMask = ~GCBitsetWord(0) >> (BIT_PER_WORD_MASK - IndexInWord(offsetEnd - 1));
+    if (beginIndex == endIndex) {
+      fn(beginIndex, LoadWord<mode>(beginIndex) & beginMask & endMask);
+      return;
+    }
+    fn(beginIndex, LoadWord<mode>(beginIndex) & beginMask);
+    for (size_t i = beginIndex + 1; i < endIndex; i++) {
+      fn(i, LoadWord<mode>(i));
+    }
+    fn(endIndex, LoadWord<mode>(endIndex) & endMask);
+  }
+
+  // Offset of the first bit equal to value in [offset, offsetEnd), or
+  // offsetEnd if there is none.
+  template <AccessType mode, bool value>
+  uintptr_t FindNextBit(uintptr_t offset, uintptr_t offsetEnd) const {
+    if (offset >= offsetEnd) {
+      return offsetEnd;
+    }
+    size_t index = Index(offset);
+    size_t endIndex = Index(offsetEnd - 1);
+    GCBitsetWord flip = value ? 0 : ~GCBitsetWord(0);
+    GCBitsetWord word = (LoadWord<mode>(index) ^ flip) & (~GCBitsetWord(0) << IndexInWord(offset));
+    while (word == 0) {
+      if (++index > endIndex) {
+        return offsetEnd;
+      }
+      word = LoadWord<mode>(index) ^ flip;
+    }
+    uintptr_t found = (index << BIT_PER_WORD_LOG2) + panda_bit_utils_ctz(word);
+    return found < offsetEnd ? found : offsetEnd;
+  }
+
   GCBitsetWord Mask(size_t index) const {
-    return 1 << index;
+    return GCBitsetWord(1) << index;
   }
 
   size_t IndexInWord(uintptr_t offset) const {
@@ -113,17 +314,41 @@ inline bool GCBitset::SetBit<AccessType::NON_ATOMIC>(uintptr_t offset) {
   return true;
 }
 
+// Test-and-set for parallel marking. The relaxed pre-check keeps already
+// marked words shared in the other cores' caches; the fetch_or then claims the
+// bit in a single RMW instead of a CAS retry loop. acq_rel orders the marking
+// thread's earlier writes before the mark, and makes the winner observe the
+// writes that preceded earlier marks of the same word.
 template <>
 inline bool GCBitset::SetBit<AccessType::ATOMIC>(uintptr_t offset) {
-  auto word = reinterpret_cast<std::atomic<GCBitsetWord> *>(&Words()[Index(offset)]);
+  auto word = AtomicWordAt(Index(offset));
   auto mask = Mask(IndexInWord(offset));
-  auto oldValue = word->load(std::memory_order_relaxed);
-  do {
-      if (oldValue & mask) {
-          return false;
-      }
-  } while (!word->compare_exchange_weak(oldValue, oldValue | mask, std::memory_order_seq_cst));
-  return true;
+  if (word->load(std::memory_order_relaxed) & mask) {
+    return false;
+  }
+  return (word->fetch_or(mask, std::memory_order_acq_rel) & mask) == 0;
+}
+
+template <>
+inline void GCBitset::ClearBit<AccessType::NON_ATOMIC>(uintptr_t offset) {
+  Words()[Index(offset)] &= ~Mask(IndexInWord(offset));
+}
+
+template <>
+inline void GCBitset::ClearBit<AccessType::ATOMIC>(uintptr_t offset) {
+  AtomicWordAt(Index(offset))->fetch_and(~Mask(IndexInWord(offset)), std::memory_order_release);
+}
+
+template <>
+inline bool GCBitset::TestBit<AccessType::NON_ATOMIC>(uintptr_t offset) const {
+  return Words()[Index(offset)] & Mask(IndexInWord(offset));
+}
+
+// A single acquire load of the whole word, so the result never mixes two
+// concurrent updates, and the object published before the mark is visible.
+template <>
+inline bool GCBitset::TestBit<AccessType::ATOMIC>(uintptr_t offset) const {
+  return AtomicWordAt(Index(offset))->load(std::memory_order_acquire) & Mask(IndexInWord(offset));
 }
 
 #endif /* GCBitset_hpp */
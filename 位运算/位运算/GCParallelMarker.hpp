@@ -0,0 +1,189 @@
+//
+//  GCParallelMarker.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef GCParallelMarker_hpp
+#define GCParallelMarker_hpp
+
+#include "GCBitset.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Work-stealing driver that lets N threads mark into one shared GCBitset.
+//
+// Every thread owns a lock-free work queue. It pops from the back of its own
+// queue (LIFO, depth-first, cache friendly) and steals from the front of the
+// others' queues when it runs dry. An object is pushed only by the thread whose
+// SetBit<ATOMIC> flipped its mark bit, so each object is traced exactly once.
+// Marking ends when the number of pushed-but-unprocessed objects drops to 0.
+class GCParallelMarker {
+public:
+  GCParallelMarker(GCBitset *bitset, uint32_t threadNum)
+      : bitset_(bitset), threadNum_(threadNum == 0 ? 1 : threadNum) {}
+
+  // Marks every object reachable from roots. trace(offset, push) must call
+  // push(childOffset) for every reference held by the object at offset; it is
+  // called concurrently from all marking threads.
+  template <typename Tracer>
+  void Mark(const std::vector<uintptr_t> &roots, Tracer &&trace) {
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    for (uint32_t i = 0; i < threadNum_; i++) {
+      queues.push_back(std::make_unique<WorkQueue>());
+    }
+    pending_.store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < roots.size(); i++) {
+      if (bitset_->SetBit<AccessType::ATOMIC>(roots[i])) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        queues[i % threadNum_]->Push(roots[i]);
+      }
+    }
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < threadNum_; i++) {
+      workers.emplace_back([&, i] { Drain(queues, i, trace); });
+    }
+    Drain(queues, 0, trace);
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+private:
+  // Chase-Lev work-stealing deque (Chase and Lev, SPAA 2005, with the C11
+  // orderings of Le et al., PPoPP 2013). Only the owner calls Push and Pop,
+  // which touch bottom_ and take no lock; thieves race on top_ with one CAS.
+  // The ring doubles when full. Outgrown rings stay alive until the queue
+  // is destroyed, since a thief may still be reading one: a mark is short
+  // lived and the rings add up to less than twice the largest one.
+  class WorkQueue {
+  public:
+    WorkQueue() { Grow(nullptr, 0, 0); }
+
+    void Push(uintptr_t offset) {
+      int64_t bottom = bottom_.load(std::memory_order_relaxed);
+      int64_t top = top_.load(std::memory_order_acquire);
+      Ring *ring = ring_.load(std::memory_order_relaxed);
+      if (bottom - top > int64_t(ring->mask)) {
+        ring = Grow(ring, top, bottom);
+      }
+      ring->Put(bottom, offset);
+      std::atomic_thread_fence(std::memory_order_release);
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    bool Pop(uintptr_t *offset) {
+      int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+      Ring *ring = ring_.load(std::memory_order_relaxed);
+      bottom_.store(bottom, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t top = top_.load(std::memory_order_relaxed);
+      if (top > bottom) {
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+      }
+      *offset = ring->Get(bottom);
+      if (top < bottom) {
+        return true;
+      }
+      // Last item: race the thieves for it.
+      bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed);
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return won;
+    }
+
+    // Steal from the opposite end, so the owner keeps its hot, deep work.
+    // Fails when the queue is empty or another thread got the item first.
+    bool Steal(uintptr_t *offset) {
+      int64_t top = top_.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t bottom = bottom_.load(std::memory_order_acquire);
+      if (top >= bottom) {
+        return false;
+      }
+      uintptr_t item = ring_.load(std::memory_order_acquire)->Get(top);
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        return false;
+      }
+      *offset = item;
+      return true;
+    }
+
+  private:
+    struct Ring {
+      explicit Ring(size_t capacity)
+          : mask(capacity - 1), slots(new std::atomic<uintptr_t>[capacity]) {}
+
+      uintptr_t Get(int64_t i) const {
+        return slots[size_t(i) & mask].load(std::memory_order_relaxed);
+      }
+      void Put(int64_t i, uintptr_t offset) {
+        slots[size_t(i) & mask].store(offset, std::memory_order_relaxed);
+      }
+
+      size_t mask;
+      std::unique_ptr<std::atomic<uintptr_t>[]> slots;
+    };
+
+    // Owner only. Copies [top, bottom) into a ring twice the size of old.
+    Ring *Grow(Ring *old, int64_t top, int64_t bottom) {
+      auto ring = std::make_unique<Ring>(old ? 2 * (old->mask + 1) : kInitialCapacity);
+      for (int64_t i = top; i < bottom; i++) {
+        ring->Put(i, old->Get(i));
+      }
+      rings_.push_back(std::move(ring));
+      ring_.store(rings_.back().get(), std::memory_order_release);
+      return rings_.back().get();
+    }
+
+    static constexpr size_t kInitialCapacity = 1024;
+
+    // top_ and bottom_ are written by different threads; keep them apart.
+    alignas(64) std::atomic<int64_t> top_ {0};
+    alignas(64) std::atomic<int64_t> bottom_ {0};
+    std::atomic<Ring *> ring_ {nullptr};
+    std::vector<std::unique_ptr<Ring>> rings_;
+  };
+
+  template <typename Tracer>
+  void Drain(std::vector<std::unique_ptr<WorkQueue>> &queues, uint32_t self, Tracer &trace) {
+    WorkQueue &own = *queues[self];
+    auto push = [&](uintptr_t child) {
+      if (bitset_->SetBit<AccessType::ATOMIC>(child)) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        own.Push(child);
+      }
+    };
+    uintptr_t offset;
+    while (true) {
+      bool found = own.Pop(&offset);
+      for (uint32_t i = 1; !found && i < threadNum_; i++) {
+        found = queues[(self + i) % threadNum_]->Steal(&offset);
+      }
+      if (found) {
+        trace(offset, push);
+        // Children were counted before this object is retired, so pending_
+        // only reaches 0 once no queue can receive new work.
+        pending_.fetch_sub(1, std::memory_order_acq_rel);
+      } else if (pending_.load(std::memory_order_acquire) == 0) {
+        return;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  GCBitset *bitset_;
+  uint32_t threadNum_;
+  std::atomic<size_t> pending_ {0};
+};
+
+#endif /* GCParallelMarker_hpp */
@@ -0,0 +1,265 @@
+//
+//  HierarchicalBitVector.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef HierarchicalBitVector_hpp
+#define HierarchicalBitVector_hpp
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+/// HierarchicalBitVector - A fixed-size bit vector with summary levels for
+/// fast searches in huge, sparse vectors.
+///
+/// Level 0 holds the bits. Every following level holds one bit per word of
+/// the level below, set iff that word is non-zero, until a level fits in a
+/// single word. A 2^30 bit vector has five levels, and the summaries cost
+/// about 1.6% extra memory.
+///
+/// set/reset propagate upwards only while a word changes between zero and
+/// non-zero. The searches climb the summaries until they find a non-zero
+/// word and then descend with one count-trailing/leading-zeros per level,
+/// so they never scan runs of zero words.
+class HierarchicalBitVector {
+  typedef uint64_t BitWord;
+
+  enum { BITWORD_SIZE = 64 };
+
+  std::vector<std::vector<BitWord>> Levels;
+  unsigned Size = 0;
+
+  static unsigned NumBitWords(unsigned S) {
+    return (S + BITWORD_SIZE - 1) / BITWORD_SIZE;
+  }
+
+  static unsigned highestSetBit(BitWord W) {
+    return BITWORD_SIZE - 1 - std::countl_zero(W);
+  }
+
+  /// Descend from the set bit Pos of level Level to the lowest (or highest)
+  /// set bit of level 0 below it.
+  int descend(unsigned Level, unsigned Pos, bool Lowest) const {
+    while (Level > 0) {
+      --Level;
+      BitWord W = Levels[Level][Pos];
+      Pos = Pos * BITWORD_SIZE +
+            (Lowest ? unsigned(std::countr_zero(W)) : highestSetBit(W));
+    }
+    return int(Pos);
+  }
+
+  /// Calls F for the set bits of level Stop below word WordIdx of Level.
+  template <typename Fn>
+  void forEachSetBitBelow(unsigned Level, unsigned WordIdx, unsigned Stop,
+                          Fn &F) const {
+    for (BitWord W = Levels[Level][WordIdx]; W; W &= W - 1) {
+      unsigned Pos = WordIdx * BITWORD_SIZE + std::countr_zero(W);
+      if (Level == Stop)
+        F(Pos);
+      else
+        forEachSetBitBelow(Level - 1, Pos, Stop, F);
+    }
+  }
+
+public:
+  typedef unsigned size_type;
+
+  HierarchicalBitVector() = default;
+
+  /// Creates a vector of S bits, all unset.
+  explicit HierarchicalBitVector(unsigned S) : Size(S) {
+    unsigned Words = std::max(1u, NumBitWords(S));
+    do {
+      Levels.emplace_back(Words, 0);
+      Words = NumBitWords(Words);
+    } while (Levels.back().size() > 1);
+  }
+
+  bool empty() const { return Size == 0; }
+  size_type size() const { return Size; }
+  unsigned getNumLevels() const { return unsigned(Levels.size()); }
+
+  /// any - Returns true if any bit is set. Only looks at the top level.
+  bool any() const { return !Levels.empty() && Levels.back()[0] != 0; }
+  bool none() const { return !any(); }
+
+  bool test(unsigned Idx) const {
+    assert(Idx < Size && "Out-of-bounds Bit access.");
+    return (Levels[0][Idx / BITWORD_SIZE] >> (Idx % BITWORD_SIZE)) & 1;
+  }
+  bool operator[](unsigned Idx) const { return test(Idx); }
+
+  HierarchicalBitVector &set(unsigned Idx) {
+    assert(Idx < Size && "Out-of-bounds Bit access.");
+    for (auto &Level : Levels) {
+      BitWord &W = Level[Idx / BITWORD_SIZE];
+      bool WasZero = W == 0;
+      W |= BitWord(1) << (Idx % BITWORD_SIZE);
+      if (!WasZero)
+        break;
+      Idx /= BITWORD_SIZE;
+    }
+    return *this;
+  }
+
+  HierarchicalBitVector &reset(unsigned Idx) {
+    assert(Idx < Size && "Out-of-bounds Bit access.");
+    for (auto &Level : Levels) {
+      BitWord &W = Level[Idx / BITWORD_SIZE];
+      W &= ~(BitWord(1) << (Idx % BITWORD_SIZE));
+      if (W != 0)
+        break;
+      Idx /= BITWORD_SIZE;
+    }
+    return *this;
+  }
+
+  /// reset - Clear all bits, touching only the non-zero words.
+  HierarchicalBitVector &reset() {
+    // Clear bottom-up, so every level is cleared using the still intact
+    // summary above it.
+    for (unsigned L = 0; L + 1 < Levels.size(); ++L) {
+      auto &Above = Levels[L + 1];
+      for (unsigned i = 0; i < Above.size(); ++i)
+        for (BitWord W = Above[i]; W; W &= W - 1)
+          Levels[L][i * BITWORD_SIZE + std::countr_zero(W)] = 0;
+    }
+    if (!Levels.empty())
+      Levels.back()[0] = 0;
+    return *this;
+  }
+
+  /// count - Returns the number of set bits, visiting only non-zero words.
+  size_type count() const {
+    if (Levels.size() == 1)
+      return std::popcount(Levels[0][0]);
+    unsigned NumBits = 0;
+    auto CountWord = [&](unsigned WordIdx) {
+      NumBits += std::popcount(Levels[0][WordIdx]);
+    };
+    forEachSetBitBelow(unsigned(Levels.size() - 1), 0, 1, CountWord);
+    return NumBits;
+  }
+
+  /// find_first_from - Returns the index of the first set bit at or after
+  /// Idx, or -1 if there is none.
+  int find_first_from(unsigned Idx) const {
+    if (Idx >= Size)
+      return -1;
+    for (unsigned L = 0; L < Levels.size(); ++L) {
+      unsigned WordIdx = Idx / BITWORD_SIZE;
+      BitWord W = Levels[L][WordIdx] & (~BitWord(0) << (Idx % BITWORD_SIZE));
+      if (W)
+        return descend(L, WordIdx * BITWORD_SIZE + std::countr_zero(W), true);
+      // Nothing left in this word, continue with the next word's summary bit.
+      Idx = WordIdx + 1;
+      if (Idx >= Levels[L].size())
+        return -1;
+    }
+    return -1;
+  }
+
+  /// find_last_before - Returns the index of the last set bit before Idx,
+  /// or -1 if there is none.
+  int find_last_before(unsigned Idx) const {
+    assert(Idx <= Size && "Out-of-bounds Bit access.");
+    if (Idx == 0)
+      return -1;
+    unsigned Pos = Idx - 1;
+    for (unsigned L = 0; L < Levels.size(); ++L) {
+      unsigned WordIdx = Pos / BITWORD_SIZE;
+      unsigned Bit = Pos % BITWORD_SIZE;
+      BitWord W = Levels[L][WordIdx] & (~BitWord(0) >> (BITWORD_SIZE - 1 - Bit));
+      if (W)
+        return descend(L, WordIdx * BITWORD_SIZE + highestSetBit(W), false);
+      if (WordIdx == 0)
+        return -1;
+      Pos = WordIdx - 1;
+    }
+    return -1;
+  }
+
+  /// find_first - Returns the index of the first set bit, -1 if none.
+  int find_first() const { return find_first_from(0); }
+
+  /// find_last - Returns the index of the last set bit, -1 if none.
+  int find_last() const { return find_last_before(Size); }
+
+  /// find_next - Returns the index of the next set bit following Prev, or -1
+  /// if there is none.
+  int find_next(unsigned Prev) const { return find_first_from(Prev + 1); }
+
+  /// find_prev - Returns the index of the first set bit that precedes
+  /// PriorTo, or -1 if there is none.
+  int find_prev(unsigned PriorTo) const { return find_last_before(PriorTo); }
+
+  /// for_each_set_bit - Calls F(Idx) for every set bit, in increasing order,
+  /// descending only into non-zero summary words.
+  template <typename Fn> void for_each_set_bit(Fn &&F) const {
+    if (!Levels.empty())
+      forEachSetBitBelow(unsigned(Levels.size() - 1), 0, 0, F);
+  }
+
+  class const_set_bits_iterator {
+    const HierarchicalBitVector *Parent;
+    int Current;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = unsigned;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const unsigned *;
+    using reference = unsigned;
+
+    const_set_bits_iterator(const HierarchicalBitVector &Parent, int Current)
+        : Parent(&Parent), Current(Current) {}
+
+    unsigned operator*() const { return unsigned(Current); }
+    const_set_bits_iterator &operator++() {
+      Current = Parent->find_next(unsigned(Current));
+      return *this;
+    }
+    const_set_bits_iterator operator++(int) {
+      auto Tmp = *this;
+      ++*this;
+      return Tmp;
+    }
+    bool operator==(const const_set_bits_iterator &RHS) const {
+      return Parent == RHS.Parent && Current == RHS.Current;
+    }
+    bool operator!=(const const_set_bits_iterator &RHS) const {
+      return !(*this == RHS);
+    }
+  };
+
+  const_set_bits_iterator set_bits_begin() const {
+    return const_set_bits_iterator(*this, find_first());
+  }
+  const_set_bits_iterator set_bits_end() const {
+    return const_set_bits_iterator(*this, -1);
+  }
+
+  struct set_bits_range {
+    const_set_bits_iterator Begin, End;
+    const_set_bits_iterator begin() const { return Begin; }
+    const_set_bits_iterator end() const { return End; }
+  };
+  set_bits_range set_bits() const { return {set_bits_begin(), set_bits_end()}; }
+
+  /// Return the size (in bytes) of the bit vector, summaries included.
+  size_t getMemorySize() const {
+    size_t Bytes = 0;
+    for (auto &Level : Levels)
+      Bytes += Level.size() * sizeof(BitWord);
+    return Bytes;
+  }
+};
+
+#endif /* HierarchicalBitVector_hpp */
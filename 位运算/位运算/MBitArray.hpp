@@ -19,6 +19,8 @@
 #include <cstdint>
 #include <cstddef>
 
+#include "SetBitIterator.hpp"
+
 template <size_t nbits>
 class BitArray {
 public:
@@ -82,6 +84,17 @@ public:
       return map[elementIndex];
     }
 
+    // Iterate over the indices of the set bits, e.g.
+    //   for (size_t bit : array.setBits()) { ... }
+    SetBitRange<WordT> setBits() const {
+      return SetBitRange<WordT>(map, nbits);
+    }
+
+    template <typename F>
+    void forEachSetBit(F&& f) const {
+      forEachSetBitInWords(map, nbits, f);
+    }
+
     static void getIndexAndMask(size_t offset, size_t* indexp, WordT* maskp) {
       static_assert(bitsPerElement == 32, "unexpected bitsPerElement value");
       *indexp = offset / bitsPerElement;
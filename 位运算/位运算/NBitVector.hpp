@@ -8,9 +8,18 @@
 #ifndef NBitVector_hpp
 #define NBitVector_hpp
 
+#include "AlignedAllocator.hpp"
+#include "SetBitIterator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <climits>
 #include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <type_traits>
 #include <vector>
 #include <valarray>
@@ -52,6 +61,25 @@ template <typename T, std::size_t SizeOfT> struct TrailingZerosCounter {
   }
 };
 
+#if defined(__GNUC__) || defined(__clang__)
+// One tzcnt/bsf (x86) or rbit+clz (arm64) instead of the bisection above.
+template <typename T> struct TrailingZerosCounter<T, 4> {
+  static std::size_t count(T Val, ZeroBehavior ZB) {
+    if (ZB != ZB_Undefined && Val == 0)
+      return 32;
+    return __builtin_ctz(Val);
+  }
+};
+
+template <typename T> struct TrailingZerosCounter<T, 8> {
+  static std::size_t count(T Val, ZeroBehavior ZB) {
+    if (ZB != ZB_Undefined && Val == 0)
+      return 64;
+    return __builtin_ctzll(Val);
+  }
+};
+#endif
+
 /// Count number of 0's from the least significant bit to the most
 ///   stopping at the first 1.
 ///
@@ -68,6 +96,57 @@ std::size_t countTrailingZeros(T Val, ZeroBehavior ZB = ZB_Width) {
 }
 
 
+template <typename T, std::size_t SizeOfT> struct LeadingZerosCounter {
+  static std::size_t count(T Val, ZeroBehavior) {
+    if (!Val)
+      return std::numeric_limits<T>::digits;
+
+    // Bisection method.
+    std::size_t ZeroBits = 0;
+    for (T Shift = std::numeric_limits<T>::digits >> 1; Shift; Shift >>= 1) {
+      T Tmp = Val >> Shift;
+      if (Tmp)
+        Val = Tmp;
+      else
+        ZeroBits |= Shift;
+    }
+    return ZeroBits;
+  }
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+template <typename T> struct LeadingZerosCounter<T, 4> {
+  static std::size_t count(T Val, ZeroBehavior ZB) {
+    if (ZB != ZB_Undefined && Val == 0)
+      return 32;
+    return __builtin_clz(Val);
+  }
+};
+
+template <typename T> struct LeadingZerosCounter<T, 8> {
+  static std::size_t count(T Val, ZeroBehavior ZB) {
+    if (ZB != ZB_Undefined && Val == 0)
+      return 64;
+    return __builtin_clzll(Val);
+  }
+};
+#endif
+
+/// Count number of 0's from the most significant bit to the least
+///   stopping at the first 1.
+///
+/// Only unsigned integral types are allowed.
+///
+/// \param ZB the behavior on an input of 0. Only ZB_Width and ZB_Undefined are
+///   valid arguments.
+template <typename T>
+std::size_t countLeadingZeros(T Val, ZeroBehavior ZB = ZB_Width) {
+  static_assert(std::numeric_limits<T>::is_integer &&
+                    !std::numeric_limits<T>::is_signed,
+                "Only unsigned integral types are allowed.");
+  return LeadingZerosCounter<T, sizeof(T)>::count(Val, ZB);
+}
+
 /// Create a bitmask with the N right-most bits set to 1, and all other
 /// bits set to 0.  Only unsigned types are allowed.
 template <typename T> T maskTrailingOnes(unsigned N) {
@@ -89,42 +168,78 @@ template <typename T> T maskTrailingZeros(unsigned N) {
   return maskLeadingOnes<T>(CHAR_BIT * sizeof(T) - N);
 }
 
-class NBitVector {
-  
+/// BasicNBitVector - The bit vector, with its words allocated by AllocatorT
+/// (rebound to BitWord). The default allocator aligns them to a cache line;
+/// a stateful arena allocator may be passed to the constructors.
+template <typename AllocatorT = AlignedAllocator<unsigned long>>
+class BasicNBitVector {
+public:
   typedef unsigned long BitWord;
+  typedef typename std::allocator_traits<AllocatorT>::template rebind_alloc<
+      BitWord>
+      allocator_type;
 
   enum { BITWORD_SIZE = (unsigned)sizeof(BitWord) * CHAR_BIT };
   
-  std::vector<BitWord> Bits;
+private:
+  typedef std::vector<BitWord, allocator_type> WordVector;
+
+  WordVector Bits;
   unsigned Size;
+  /// Bumped by every change of the bits or the size, see getGeneration().
+  uint64_t Generation = 0;
   
 private:
-  void init_words(std::vector<BitWord> &B, bool t) {
+  void init_words(WordVector &B, bool t) {
     if (B.size() > 0)
       memset(B.data(), 0 - (int)t, B.size() * sizeof(BitWord));
   }
   
-  void init_words_from(std::vector<BitWord> &B, unsigned words, bool t) {
-    for (size_t i = words * sizeof(BitWord); i < Bits.size() * sizeof(BitWord); i++)
-      Bits.data()[i] = 0 - (int)t;
+  void init_words_from(WordVector &B, unsigned words, bool t) {
+    for (size_t i = words; i < B.size(); i++)
+      B[i] = 0 - BitWord(t);
   }
   
   unsigned NumBitWords(unsigned S) const {
     return (S + BITWORD_SIZE - 1) / BITWORD_SIZE;
   }
+
+  /// Splits [Begin, End) into partial edge words and a run of whole words.
+  /// Calls Edge(WordIdx, Mask) for each partial word and Body(FirstWord,
+  /// NumWords) once for the whole words, if any.
+  template <typename EdgeFn, typename BodyFn>
+  static void for_each_range_word(unsigned Begin, unsigned End, EdgeFn Edge,
+                                  BodyFn Body) {
+    if (Begin == End)
+      return;
+    unsigned FirstWord = Begin / BITWORD_SIZE;
+    unsigned LastWord = (End - 1) / BITWORD_SIZE;
+    BitWord FirstMask = maskTrailingZeros<BitWord>(Begin % BITWORD_SIZE);
+    BitWord LastMask = maskTrailingOnes<BitWord>((End - 1) % BITWORD_SIZE + 1);
+    if (FirstWord == LastWord) {
+      Edge(FirstWord, FirstMask & LastMask);
+      return;
+    }
+    if (FirstMask != ~BitWord(0))
+      Edge(FirstWord++, FirstMask);
+    if (LastMask != ~BitWord(0))
+      Edge(LastWord--, LastMask);
+    if (FirstWord <= LastWord)
+      Body(FirstWord, LastWord - FirstWord + 1);
+  }
   
 public:
   typedef unsigned size_type;
   
   class reference {
-    friend class BitVector;
-
     BitWord *WordRef;
+    uint64_t *Generation;
     unsigned BitPos;
 
   public:
-    reference(NBitVector &b, unsigned idx) {
+    reference(BasicNBitVector &b, unsigned idx) {
       WordRef = &b.Bits[idx / BITWORD_SIZE];
+      Generation = &b.Generation;
       BitPos = idx % BITWORD_SIZE;
     }
 
@@ -137,6 +252,7 @@ public:
     }
 
     reference& operator=(bool t) {
+      ++*Generation;
       if (t)
         *WordRef |= BitWord(1) << BitPos;
       else
@@ -150,11 +266,16 @@ public:
   };
   
   /// BitVector default ctor - Creates an empty bitvector.
-  NBitVector() : Size(0) {}
+  BasicNBitVector() : Size(0) {}
+
+  /// Creates an empty bitvector that will allocate from A.
+  explicit BasicNBitVector(const allocator_type &A) : Bits(A), Size(0) {}
 
   /// BitVector ctor - Creates a bitvector of specified number of bits. All
   /// bits are initialized to the specified value.
-  explicit NBitVector(unsigned s, bool t = false) : Size(s) {
+  explicit BasicNBitVector(unsigned s, bool t = false,
+                           const allocator_type &A = allocator_type())
+      : Bits(A), Size(s) {
     size_t Capacity = NumBitWords(s);
     Bits.resize(Capacity, 0 - BitWord(t));
     init_words(Bits, t);
@@ -162,6 +283,46 @@ public:
       clear_unused_bits();
   }
   
+  BasicNBitVector(const BasicNBitVector &RHS)
+      : Bits(RHS.Bits), Size(RHS.Size) {}
+  /// Bumps the generation rather than copying it: the words may be reused
+  /// in place, and an index of the old bits must not take them for its own.
+  BasicNBitVector &operator=(const BasicNBitVector &RHS) {
+    if (this != &RHS) {
+      Bits = RHS.Bits;
+      Size = RHS.Size;
+      ++Generation;
+    }
+    return *this;
+  }
+
+  /// Moves take the words of RHS without allocating and leave it empty.
+  BasicNBitVector(BasicNBitVector &&RHS) noexcept
+      : Bits(std::move(RHS.Bits)), Size(RHS.Size) {
+    RHS.Size = 0;
+    ++RHS.Generation;
+  }
+
+  /// Allocation-free unless the allocators neither propagate nor compare
+  /// equal, in which case the words are moved one by one as std::vector
+  /// does.
+  BasicNBitVector &operator=(BasicNBitVector &&RHS) noexcept(
+      std::allocator_traits<allocator_type>::
+          propagate_on_container_move_assignment::value ||
+      std::allocator_traits<allocator_type>::is_always_equal::value) {
+    if (this != &RHS) {
+      Bits = std::move(RHS.Bits);
+      Size = RHS.Size;
+      ++Generation;
+      RHS.Bits.clear();
+      RHS.Size = 0;
+      ++RHS.Generation;
+    }
+    return *this;
+  }
+
+  allocator_type get_allocator() const { return Bits.get_allocator(); }
+
   bool empty() const { return Size == 0; }
   
   size_type size() const { return Size; }
@@ -191,6 +352,14 @@ public:
   bool none() const {
     return !any();
   }
+
+  /// count - Returns the number of bits which are set.
+  size_type count() const {
+    unsigned NumBits = 0;
+    for (unsigned i = 0; i < NumBitWords(size()); ++i)
+      NumBits += std::popcount(Bits[i]);
+    return NumBits;
+  }
   
   /// find_first_in - Returns the index of the first set bit in the range
   /// [Begin, End).  Returns -1 if all bits in the range are unset.
@@ -222,10 +391,167 @@ public:
     return -1;
   }
   
+  /// find_last_in - Returns the index of the last set bit in the range
+  /// [Begin, End).  Returns -1 if all bits in the range are unset.
+  int find_last_in(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= Size);
+    if (Begin == End)
+      return -1;
+
+    unsigned LastWord = (End - 1) / BITWORD_SIZE;
+    unsigned FirstWord = Begin / BITWORD_SIZE;
+
+    for (unsigned i = LastWord + 1; i >= FirstWord + 1; --i) {
+      unsigned CurrentWord = i - 1;
+
+      BitWord Copy = Bits[CurrentWord];
+      if (CurrentWord == LastWord) {
+        unsigned LastBit = (End - 1) % BITWORD_SIZE;
+        Copy &= maskTrailingOnes<BitWord>(LastBit + 1);
+      }
+
+      if (CurrentWord == FirstWord) {
+        unsigned FirstBit = Begin % BITWORD_SIZE;
+        Copy &= maskTrailingZeros<BitWord>(FirstBit);
+      }
+
+      if (Copy != 0)
+        return (CurrentWord + 1) * BITWORD_SIZE - countLeadingZeros(Copy) - 1;
+    }
+
+    return -1;
+  }
+
   /// find_first - Returns the index of the first set bit, -1 if none
   /// of the bits are set.
   int find_first() const { return find_first_in(0, Size); }
 
+  /// find_last - Returns the index of the last set bit, -1 if none of the bits
+  /// are set.
+  int find_last() const { return find_last_in(0, Size); }
+
+  /// find_next - Returns the index of the next set bit following the
+  /// "Prev" bit. Returns -1 if the next set bit is not found.
+  int find_next(unsigned Prev) const { return find_first_in(Prev + 1, Size); }
+
+  /// find_prev - Returns the index of the first set bit that precedes
+  /// the bit at \p PriorTo.  Returns -1 if all previous bits are unset.
+  int find_prev(unsigned PriorTo) const { return find_last_in(0, PriorTo); }
+
+  /// find_first_unset - Returns the index of the first unset bit, -1 if all
+  /// of the bits are set.
+  int find_first_unset() const { return find_first_unset_in(0, Size); }
+
+  /// find_last_unset - Returns the index of the last unset bit, -1 if all of
+  /// the bits are set.
+  int find_last_unset() const { return find_last_unset_in(0, Size); }
+
+  /// find_next_unset - Returns the index of the next unset bit following the
+  /// "Prev" bit.  Returns -1 if all remaining bits are set.
+  int find_next_unset(unsigned Prev) const {
+    return find_first_unset_in(Prev + 1, Size);
+  }
+
+  /// find_prev_unset - Returns the index of the first unset bit that precedes
+  /// the bit at \p PriorTo.  Returns -1 if all previous bits are set.
+  int find_prev_unset(unsigned PriorTo) const {
+    return find_last_unset_in(0, PriorTo);
+  }
+
+  /// find_first_unset_in - Returns the index of the first unset bit in the
+  /// range [Begin, End).  Returns -1 if all bits in the range are set.
+  int find_first_unset_in(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= Size);
+    if (Begin == End)
+      return -1;
+
+    unsigned FirstWord = Begin / BITWORD_SIZE;
+    unsigned LastWord = (End - 1) / BITWORD_SIZE;
+
+    for (unsigned i = FirstWord; i <= LastWord; ++i) {
+      BitWord Copy = ~Bits[i];
+
+      if (i == FirstWord)
+        Copy &= maskTrailingZeros<BitWord>(Begin % BITWORD_SIZE);
+
+      if (i == LastWord)
+        Copy &= maskTrailingOnes<BitWord>((End - 1) % BITWORD_SIZE + 1);
+      if (Copy != 0)
+        return i * BITWORD_SIZE + countTrailingZeros(Copy);
+    }
+
+    return -1;
+  }
+
+  /// find_last_unset_in - Returns the index of the last unset bit in the
+  /// range [Begin, End).  Returns -1 if all bits in the range are set.
+  int find_last_unset_in(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= Size);
+    if (Begin == End)
+      return -1;
+
+    unsigned LastWord = (End - 1) / BITWORD_SIZE;
+    unsigned FirstWord = Begin / BITWORD_SIZE;
+
+    for (unsigned i = LastWord + 1; i >= FirstWord + 1; --i) {
+      unsigned CurrentWord = i - 1;
+
+      BitWord Copy = ~Bits[CurrentWord];
+      if (CurrentWord == LastWord)
+        Copy &= maskTrailingOnes<BitWord>((End - 1) % BITWORD_SIZE + 1);
+
+      if (CurrentWord == FirstWord)
+        Copy &= maskTrailingZeros<BitWord>(Begin % BITWORD_SIZE);
+
+      if (Copy != 0)
+        return (CurrentWord + 1) * BITWORD_SIZE - countLeadingZeros(Copy) - 1;
+    }
+
+    return -1;
+  }
+
+  /// count - Returns the number of set bits in the range [Begin, End).
+  size_type count(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= Size && "Invalid range");
+    unsigned NumBits = 0;
+    for_each_range_word(Begin, End,
+        [&](unsigned W, BitWord Mask) { NumBits += std::popcount(Bits[W] & Mask); },
+        [&](unsigned W, unsigned N) {
+          for (unsigned i = W; i != W + N; ++i)
+            NumBits += std::popcount(Bits[i]);
+        });
+    return NumBits;
+  }
+
+  /// any_in - Returns true if any bit in [Begin, End) is set.
+  bool any_in(unsigned Begin, unsigned End) const {
+    return find_first_in(Begin, End) != -1;
+  }
+
+  /// all_in - Returns true if all bits in [Begin, End) are set. True for an
+  /// empty range.
+  bool all_in(unsigned Begin, unsigned End) const {
+    return find_first_unset_in(Begin, End) == -1;
+  }
+
+  typedef SetBitIterator<BitWord> const_set_bits_iterator;
+  typedef const_set_bits_iterator set_iterator;
+
+  const_set_bits_iterator set_bits_begin() const {
+    return const_set_bits_iterator(Bits.data(), Size);
+  }
+  const_set_bits_iterator set_bits_end() const {
+    return const_set_bits_iterator();
+  }
+  SetBitRange<BitWord> set_bits() const {
+    return SetBitRange<BitWord>(Bits.data(), Size);
+  }
+
+  /// for_each_set_bit - Calls F(Idx) for every set bit, in increasing order.
+  template <typename Fn> void for_each_set_bit(Fn &&F) const {
+    forEachSetBitInWords(Bits.data(), Size, F);
+  }
+
   bool at(uint32_t idx) const {
     assert(idx < Size && "Index must be within the bitset");
     return Bits[idx / BITWORD_SIZE] & BitWord(1) << (idx % BITWORD_SIZE);
@@ -234,10 +560,12 @@ public:
   /// clear - Removes all bits from the bitvector. Does not change capacity.
   void clear() {
     Size = 0;
+    ++Generation;
   }
   
   /// resize - Grow or shrink the bitvector.
   void resize(unsigned N, bool t = false) {
+    ++Generation;
     if (N > getBitCapacity()) {
       unsigned OldCapacity = Bits.size();
       Bits.resize(NumBitWords(N), 0 - BitWord(t));
@@ -258,34 +586,84 @@ public:
   }
   
   void reserve(unsigned N) {
-    if (N > getBitCapacity())
+    if (N > getBitCapacity()) {
       Bits.resize(NumBitWords(N), 0 - BitWord(false));
+      ++Generation;
+    }
   }
   
-  NBitVector &set() {
+  BasicNBitVector &set() {
+    ++Generation;
     init_words(Bits, true);
+    clear_unused_bits();
     return *this;
   }
 
-  NBitVector &set(uint32_t idx) {
+  BasicNBitVector &set(uint32_t idx) {
+    ++Generation;
     Bits[idx / BITWORD_SIZE] |= BitWord(1) << (idx % BITWORD_SIZE);
     return *this;
   }
   
-  NBitVector &reset() {
+  /// set - Efficiently set a range of bits in [Begin, End). Whole words are
+  /// filled with memset.
+  BasicNBitVector &set(unsigned Begin, unsigned End) {
+    assert(Begin <= End && "Attempted to set backwards range!");
+    assert(End <= size() && "Attempted to set out-of-bounds range!");
+    ++Generation;
+    for_each_range_word(Begin, End,
+        [&](unsigned W, BitWord Mask) { Bits[W] |= Mask; },
+        [&](unsigned W, unsigned N) {
+          memset(&Bits[W], 0xff, N * sizeof(BitWord));
+        });
+    return *this;
+  }
+
+  BasicNBitVector &reset() {
+    ++Generation;
     init_words(Bits, false);
     return *this;
   }
+
+  /// reset - Efficiently reset a range of bits in [Begin, End).
+  BasicNBitVector &reset(unsigned Begin, unsigned End) {
+    assert(Begin <= End && "Attempted to reset backwards range!");
+    assert(End <= size() && "Attempted to reset out-of-bounds range!");
+    ++Generation;
+    for_each_range_word(Begin, End,
+        [&](unsigned W, BitWord Mask) { Bits[W] &= ~Mask; },
+        [&](unsigned W, unsigned N) {
+          memset(&Bits[W], 0, N * sizeof(BitWord));
+        });
+    return *this;
+  }
   
-  NBitVector &reset(unsigned idx) {
+  BasicNBitVector &reset(unsigned idx) {
+    ++Generation;
     Bits[idx / BITWORD_SIZE] &= ~(BitWord(1) << (idx % BITWORD_SIZE));
     return *this;
   }
   
-  NBitVector &flip(unsigned idx) {
+  BasicNBitVector &flip(unsigned idx) {
+    ++Generation;
     Bits[idx / BITWORD_SIZE] ^= BitWord(1) << (idx % BITWORD_SIZE);
     return *this;
   }
+
+  /// flip - Flip a range of bits in [Begin, End).
+  BasicNBitVector &flip(unsigned Begin, unsigned End) {
+    assert(Begin <= End && "Attempted to flip backwards range!");
+    assert(End <= size() && "Attempted to flip out-of-bounds range!");
+    ++Generation;
+    for_each_range_word(Begin, End,
+        [&](unsigned W, BitWord Mask) { Bits[W] ^= Mask; },
+        [&](unsigned W, unsigned N) {
+          BitWord *Words = &Bits[W];
+          for (unsigned i = 0; i != N; ++i)
+            Words[i] = ~Words[i];
+        });
+    return *this;
+  }
   
   reference operator[](unsigned idx) {
     assert (idx < Size && "Out-of-bounds Bit access.");
@@ -302,8 +680,67 @@ public:
     return (*this)[idx];
   }
 
+  // Comparison operators.
+  bool operator==(const BasicNBitVector &RHS) const {
+    if (size() != RHS.size())
+      return false;
+    unsigned NumWords = NumBitWords(size());
+    return std::equal(Bits.begin(), Bits.begin() + NumWords, RHS.Bits.begin());
+  }
+
+  bool operator!=(const BasicNBitVector &RHS) const {
+    return !(*this == RHS);
+  }
+
+  /// Intersection, union, disjoint union.
+  BasicNBitVector &operator&=(const BasicNBitVector &RHS) {
+    unsigned ThisWords = NumBitWords(size());
+    unsigned RHSWords  = NumBitWords(RHS.size());
+    unsigned i;
+    ++Generation;
+    for (i = 0; i != std::min(ThisWords, RHSWords); ++i)
+      Bits[i] &= RHS.Bits[i];
+
+    // Any bits that are just in this bitvector become zero, because they aren't
+    // in the RHS bit vector.  Any words only in RHS are ignored because they
+    // are already zero in the LHS.
+    for (; i != ThisWords; ++i)
+      Bits[i] = 0;
+
+    return *this;
+  }
+
+  /// reset - Reset bits that are set in RHS. Same as *this &= ~RHS.
+  BasicNBitVector &reset(const BasicNBitVector &RHS) {
+    unsigned ThisWords = NumBitWords(size());
+    unsigned RHSWords  = NumBitWords(RHS.size());
+    ++Generation;
+    for (unsigned i = 0; i != std::min(ThisWords, RHSWords); ++i)
+      Bits[i] &= ~RHS.Bits[i];
+    return *this;
+  }
+
+  BasicNBitVector &operator|=(const BasicNBitVector &RHS) {
+    if (size() < RHS.size())
+      resize(RHS.size());
+    ++Generation;
+    for (size_t i = 0, e = RHS.NumBitWords(RHS.size()); i != e; ++i)
+      Bits[i] |= RHS.Bits[i];
+    return *this;
+  }
+
+  BasicNBitVector &operator^=(const BasicNBitVector &RHS) {
+    if (size() < RHS.size())
+      resize(RHS.size());
+    ++Generation;
+    for (size_t i = 0, e = RHS.NumBitWords(RHS.size()); i != e; ++i)
+      Bits[i] ^= RHS.Bits[i];
+    return *this;
+  }
+
   // Set the unused bits in the high words.
   void set_unused_bits(bool t = true) {
+    ++Generation;
     //  Set high words first.
     unsigned UsedWords = NumBitWords(Size);
     if (Bits.size() > UsedWords)
@@ -326,10 +763,29 @@ public:
   }
   
 public:
+  /// Return the underlying words, for the auxiliary indexes layered on top of
+  /// the bit vector. Only the first getNumWords() words are in use.
+  const BitWord *getData() const { return Bits.data(); }
+  /// Mutable words for bulk loaders. Bits past size() must be left zero.
+  /// Counts as a change of the bits, see getGeneration().
+  BitWord *getData() {
+    ++Generation;
+    return Bits.data();
+  }
+  unsigned getNumWords() const { return NumBitWords(Size); }
+
+  /// getGeneration - A counter that changes whenever the bits or the size
+  /// may have changed: every mutator and the mutable getData() bump it.
+  /// Indexes built over the vector, such as RankSelectIndex, record it to
+  /// detect that they are stale.
+  uint64_t getGeneration() const { return Generation; }
+
   /// Return the size (in bytes) of the bit vector.
   size_t getMemorySize() const { return Bits.size() * sizeof(BitWord); }
   size_t getBitCapacity() const { return Bits.size() * BITWORD_SIZE; }
   
 };
 
+typedef BasicNBitVector<> NBitVector;
+
 #endif /* NBitVector_hpp */
@@ -0,0 +1,314 @@
+//
+//  ParallelBitOps.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "ParallelBitOps.hpp"
+#include "BitVectorKernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const size_t CacheLineBytes = 64;
+
+/// Chunks of a word array. Every boundary but the first and last falls on
+/// a cache line of the array.
+struct ChunkPlan {
+  size_t NumWords = 0;
+  size_t FirstEnd = 0;
+  size_t ChunkWords = 0;
+  size_t NumChunks = 1;
+
+  size_t begin(size_t K) const {
+    return K == 0 ? 0 : FirstEnd + (K - 1) * ChunkWords;
+  }
+  size_t end(size_t K) const {
+    return K == 0 ? FirstEnd : std::min(NumWords, FirstEnd + K * ChunkWords);
+  }
+};
+
+template <typename WordT>
+ChunkPlan planChunks(const ThreadPool &Pool, const WordT *Base,
+                     size_t NumWords) {
+  ChunkPlan Plan;
+  Plan.NumWords = NumWords;
+  Plan.FirstEnd = NumWords;
+  unsigned Threads = Pool.getNumThreads();
+  if (NumWords * sizeof(WordT) < ParallelMinBytes || Threads == 1)
+    return Plan;
+
+  // A few chunks per thread, so a slow thread does not hold up the loop.
+  const size_t LineWords = CacheLineBytes / sizeof(WordT);
+  size_t ChunkWords = (NumWords + Threads * 4 - 1) / (Threads * 4);
+  ChunkWords = (ChunkWords + LineWords - 1) / LineWords * LineWords;
+  size_t Lead = (CacheLineBytes - uintptr_t(Base) % CacheLineBytes) %
+                CacheLineBytes / sizeof(WordT);
+  Plan.ChunkWords = ChunkWords;
+  Plan.FirstEnd = std::min(NumWords, Lead + ChunkWords);
+  Plan.NumChunks = 1 + (NumWords - Plan.FirstEnd + ChunkWords - 1) / ChunkWords;
+  return Plan;
+}
+
+/// Calls F(Begin, End) for every chunk of the NumWords words at Base.
+template <typename WordT, typename Fn>
+void forEachChunk(ThreadPool &Pool, const WordT *Base, size_t NumWords,
+                  Fn &&F) {
+  ChunkPlan Plan = planChunks(Pool, Base, NumWords);
+  Pool.parallelFor(Plan.NumChunks,
+                   [&](size_t K) { F(Plan.begin(K), Plan.end(K)); });
+}
+
+/// Sums F(Begin, End) over the chunks of the NumWords words at Base.
+template <typename WordT, typename Fn>
+size_t sumChunks(ThreadPool &Pool, const WordT *Base, size_t NumWords,
+                 Fn &&F) {
+  struct alignas(CacheLineBytes) Partial {
+    size_t Value = 0;
+  };
+  ChunkPlan Plan = planChunks(Pool, Base, NumWords);
+  std::vector<Partial> Sums(Plan.NumChunks);
+  Pool.parallelFor(Plan.NumChunks, [&](size_t K) {
+    Sums[K].Value = F(Plan.begin(K), Plan.end(K));
+  });
+  size_t Total = 0;
+  for (const Partial &P : Sums)
+    Total += P.Value;
+  return Total;
+}
+
+/// Returns true if Pred(Word) holds for any of the NumWords words at Words.
+/// Chunks still waiting to run are skipped once a match is found.
+template <typename WordT, typename PredFn>
+bool anyWord(ThreadPool &Pool, const WordT *Words, size_t NumWords,
+             PredFn Pred) {
+  std::atomic<bool> Found{false};
+  forEachChunk(Pool, Words, NumWords, [&](size_t Begin, size_t End) {
+    if (Found.load(std::memory_order_relaxed))
+      return;
+    for (size_t i = Begin; i < End; ++i) {
+      if (Pred(Words[i])) {
+        Found.store(true, std::memory_order_relaxed);
+        return;
+      }
+    }
+  });
+  return Found.load(std::memory_order_relaxed);
+}
+
+/// All NumBits bits of Words are set. The last partial word is checked
+/// serially.
+template <typename WordT>
+bool allBits(ThreadPool &Pool, const WordT *Words, size_t NumBits) {
+  constexpr size_t WordBits = sizeof(WordT) * 8;
+  size_t FullWords = NumBits / WordBits;
+  if (size_t Rem = NumBits % WordBits) {
+    WordT Mask = WordT(-1) >> (WordBits - Rem);
+    if ((Words[FullWords] & Mask) != Mask)
+      return false;
+  }
+  return !anyWord(Pool, Words, FullWords,
+                  [](WordT W) { return W != WordT(-1); });
+}
+
+int tesseractWords(const tesseract::BitVector &V) { return (V.size() + 31) / 32; }
+
+/// Clears the bits past size() in the last word of V, which |= and ^= with
+/// a longer operand can set.
+void clearTesseractPadding(tesseract::BitVector &V) {
+  if (int Rem = V.size() % 32)
+    V.data()[tesseractWords(V) - 1] &= (uint32_t(1) << Rem) - 1;
+}
+
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// NBitVector
+//===----------------------------------------------------------------------===//
+
+void parallelSet(NBitVector &V, ThreadPool &Pool) {
+  typedef NBitVector::BitWord BitWord;
+  BitWord *Words = V.getData();
+  forEachChunk(Pool, Words, V.getNumWords(), [&](size_t Begin, size_t End) {
+    memset(Words + Begin, 0xff, (End - Begin) * sizeof(BitWord));
+  });
+  if (unsigned Rem = V.size() % NBitVector::BITWORD_SIZE)
+    Words[V.getNumWords() - 1] = maskTrailingOnes<BitWord>(Rem);
+}
+
+void parallelReset(NBitVector &V, ThreadPool &Pool) {
+  NBitVector::BitWord *Words = V.getData();
+  forEachChunk(Pool, Words, V.getNumWords(), [&](size_t Begin, size_t End) {
+    memset(Words + Begin, 0, (End - Begin) * sizeof(NBitVector::BitWord));
+  });
+}
+
+bool parallelAny(const NBitVector &V, ThreadPool &Pool) {
+  return anyWord(Pool, V.getData(), V.getNumWords(),
+                 [](NBitVector::BitWord W) { return W != 0; });
+}
+
+bool parallelAll(const NBitVector &V, ThreadPool &Pool) {
+  return allBits(Pool, V.getData(), V.size());
+}
+
+size_t parallelCount(const NBitVector &V, ThreadPool &Pool) {
+  const NBitVector::BitWord *Words = V.getData();
+  return sumChunks(Pool, Words, V.getNumWords(), [&](size_t Begin, size_t End) {
+    size_t Ones = 0;
+    for (size_t i = Begin; i < End; ++i)
+      Ones += std::popcount(Words[i]);
+    return Ones;
+  });
+}
+
+void parallelAnd(NBitVector &Dst, const NBitVector &RHS, ThreadPool &Pool) {
+  NBitVector::BitWord *D = Dst.getData();
+  const NBitVector::BitWord *R = RHS.getData();
+  size_t RHSWords = RHS.getNumWords();
+  // Words only in Dst become zero, as in NBitVector::operator&=.
+  forEachChunk(Pool, D, Dst.getNumWords(), [&](size_t Begin, size_t End) {
+    size_t Mid = std::clamp(RHSWords, Begin, End);
+    for (size_t i = Begin; i < Mid; ++i)
+      D[i] &= R[i];
+    for (size_t i = Mid; i < End; ++i)
+      D[i] = 0;
+  });
+}
+
+void parallelOr(NBitVector &Dst, const NBitVector &RHS, ThreadPool &Pool) {
+  if (Dst.size() < RHS.size())
+    Dst.resize(RHS.size());
+  NBitVector::BitWord *D = Dst.getData();
+  const NBitVector::BitWord *R = RHS.getData();
+  forEachChunk(Pool, D, RHS.getNumWords(), [&](size_t Begin, size_t End) {
+    for (size_t i = Begin; i < End; ++i)
+      D[i] |= R[i];
+  });
+}
+
+void parallelXor(NBitVector &Dst, const NBitVector &RHS, ThreadPool &Pool) {
+  if (Dst.size() < RHS.size())
+    Dst.resize(RHS.size());
+  NBitVector::BitWord *D = Dst.getData();
+  const NBitVector::BitWord *R = RHS.getData();
+  forEachChunk(Pool, D, RHS.getNumWords(), [&](size_t Begin, size_t End) {
+    for (size_t i = Begin; i < End; ++i)
+      D[i] ^= R[i];
+  });
+}
+
+void parallelResetBits(NBitVector &Dst, const NBitVector &RHS,
+                       ThreadPool &Pool) {
+  NBitVector::BitWord *D = Dst.getData();
+  const NBitVector::BitWord *R = RHS.getData();
+  size_t Common = std::min(Dst.getNumWords(), RHS.getNumWords());
+  forEachChunk(Pool, D, Common, [&](size_t Begin, size_t End) {
+    for (size_t i = Begin; i < End; ++i)
+      D[i] &= ~R[i];
+  });
+}
+
+//===----------------------------------------------------------------------===//
+// tesseract::BitVector
+//===----------------------------------------------------------------------===//
+
+void parallelSetAllFalse(tesseract::BitVector &V, ThreadPool &Pool) {
+  uint32_t *Words = V.data();
+  forEachChunk(Pool, Words, tesseractWords(V), [&](size_t Begin, size_t End) {
+    memset(Words + Begin, 0, (End - Begin) * sizeof(uint32_t));
+  });
+}
+
+void parallelSetAllTrue(tesseract::BitVector &V, ThreadPool &Pool) {
+  uint32_t *Words = V.data();
+  int NumWords = tesseractWords(V);
+  forEachChunk(Pool, Words, NumWords, [&](size_t Begin, size_t End) {
+    memset(Words + Begin, 0xff, (End - Begin) * sizeof(uint32_t));
+  });
+  if (int Rem = V.size() % 32)
+    Words[NumWords - 1] = (uint32_t(1) << Rem) - 1;
+}
+
+bool parallelAny(const tesseract::BitVector &V, ThreadPool &Pool) {
+  return anyWord(Pool, V.data(), tesseractWords(V),
+                 [](uint32_t W) { return W != 0; });
+}
+
+bool parallelAll(const tesseract::BitVector &V, ThreadPool &Pool) {
+  return allBits(Pool, V.data(), V.size());
+}
+
+int64_t parallelNumSetBits(const tesseract::BitVector &V, ThreadPool &Pool) {
+  const uint32_t *Words = V.data();
+  tesseract::PopCountFunction Count =
+      tesseract::PopCount.load(std::memory_order_acquire);
+  return sumChunks(Pool, Words, tesseractWords(V), [&](size_t Begin, size_t End) {
+    return size_t(Count(Words + Begin, int(End - Begin)));
+  });
+}
+
+void parallelAnd(tesseract::BitVector &Dst, const tesseract::BitVector &Other,
+                 ThreadPool &Pool) {
+  uint32_t *D = Dst.data();
+  const tesseract::BitOpKernels *Ops =
+      tesseract::BitOps.load(std::memory_order_acquire);
+  const uint32_t *O = Other.data();
+  size_t OtherWords = tesseractWords(Other);
+  forEachChunk(Pool, D, tesseractWords(Dst), [&](size_t Begin, size_t End) {
+    size_t Mid = std::clamp(OtherWords, Begin, End);
+    Ops->And(D + Begin, D + Begin, O + Begin, int(Mid - Begin));
+    memset(D + Mid, 0, (End - Mid) * sizeof(uint32_t));
+  });
+}
+
+void parallelOr(tesseract::BitVector &Dst, const tesseract::BitVector &Other,
+                ThreadPool &Pool) {
+  uint32_t *D = Dst.data();
+  const tesseract::BitOpKernels *Ops =
+      tesseract::BitOps.load(std::memory_order_acquire);
+  const uint32_t *O = Other.data();
+  size_t Common = std::min(tesseractWords(Dst), tesseractWords(Other));
+  forEachChunk(Pool, D, Common, [&](size_t Begin, size_t End) {
+    Ops->Or(D + Begin, D + Begin, O + Begin, int(End - Begin));
+  });
+  clearTesseractPadding(Dst);
+}
+
+void parallelXor(tesseract::BitVector &Dst, const tesseract::BitVector &Other,
+                 ThreadPool &Pool) {
+  uint32_t *D = Dst.data();
+  const tesseract::BitOpKernels *Ops =
+      tesseract::BitOps.load(std::memory_order_acquire);
+  const uint32_t *O = Other.data();
+  size_t Common = std::min(tesseractWords(Dst), tesseractWords(Other));
+  forEachChunk(Pool, D, Common, [&](size_t Begin, size_t End) {
+    Ops->Xor(D + Begin, D + Begin, O + Begin, int(End - Begin));
+  });
+  clearTesseractPadding(Dst);
+}
+
+void parallelSetSubtract(tesseract::BitVector &Dst,
+                         const tesseract::BitVector &V1,
+                         const tesseract::BitVector &V2, ThreadPool &Pool) {
+  if (Dst.size() != V1.size())
+    Dst.Init(V1.size());
+  uint32_t *D = Dst.data();
+  const tesseract::BitOpKernels *Ops =
+      tesseract::BitOps.load(std::memory_order_acquire);
+  const uint32_t *A = V1.data();
+  const uint32_t *B = V2.data();
+  size_t Common = std::min(tesseractWords(V1), tesseractWords(V2));
+  forEachChunk(Pool, D, tesseractWords(V1), [&](size_t Begin, size_t End) {
+    size_t Mid = std::clamp(Common, Begin, End);
+    Ops->AndNot(D + Begin, A + Begin, B + Begin, int(Mid - Begin));
+    if (D != A)
+      memcpy(D + Mid, A + Mid, (End - Mid) * sizeof(uint32_t));
+  });
+}
@@ -0,0 +1,73 @@
+//
+//  ParallelBitOps.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef ParallelBitOps_hpp
+#define ParallelBitOps_hpp
+
+#include "NBitVector.hpp"
+#include "TBitVector.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Multi-threaded whole-vector operations for multi-gigabit bit vectors.
+//
+// The words are split into chunks whose boundaries fall on cache lines of
+// the destination, so no two threads ever write the same line, and every
+// thread streams a contiguous range. Counts and any/all are reduced from
+// per-chunk results; any/all also stop early once the answer is known.
+//
+// Vectors under ParallelMinBytes run serially on the calling thread: below
+// that the wake-up of the pool costs more than the work. The semantics,
+// including mismatched sizes, are those of the serial operators.
+
+/// Vectors smaller than this are processed serially.
+enum : size_t { ParallelMinBytes = 1 << 20 };
+
+/// NBitVector
+void parallelSet(NBitVector &V, ThreadPool &Pool = ThreadPool::getGlobal());
+void parallelReset(NBitVector &V, ThreadPool &Pool = ThreadPool::getGlobal());
+bool parallelAny(const NBitVector &V, ThreadPool &Pool = ThreadPool::getGlobal());
+bool parallelAll(const NBitVector &V, ThreadPool &Pool = ThreadPool::getGlobal());
+size_t parallelCount(const NBitVector &V,
+                     ThreadPool &Pool = ThreadPool::getGlobal());
+/// Dst op= RHS.
+void parallelAnd(NBitVector &Dst, const NBitVector &RHS,
+                 ThreadPool &Pool = ThreadPool::getGlobal());
+void parallelOr(NBitVector &Dst, const NBitVector &RHS,
+                ThreadPool &Pool = ThreadPool::getGlobal());
+void parallelXor(NBitVector &Dst, const NBitVector &RHS,
+                 ThreadPool &Pool = ThreadPool::getGlobal());
+/// Dst.reset(RHS), i.e. Dst &= ~RHS.
+void parallelResetBits(NBitVector &Dst, const NBitVector &RHS,
+                       ThreadPool &Pool = ThreadPool::getGlobal());
+
+/// tesseract::BitVector, on the selected BitOps/PopCount kernels.
+void parallelSetAllFalse(tesseract::BitVector &V,
+                         ThreadPool &Pool = ThreadPool::getGlobal());
+void parallelSetAllTrue(tesseract::BitVector &V,
+                        ThreadPool &Pool = ThreadPool::getGlobal());
+bool parallelAny(const tesseract::BitVector &V,
+                 ThreadPool &Pool = ThreadPool::getGlobal());
+bool parallelAll(const tesseract::BitVector &V,
+                 ThreadPool &Pool = ThreadPool::getGlobal());
+int64_t parallelNumSetBits(const tesseract::BitVector &V,
+                           ThreadPool &Pool = ThreadPool::getGlobal());
+void parallelAnd(tesseract::BitVector &Dst, const tesseract::BitVector &Other,
+                 ThreadPool &Pool = ThreadPool::getGlobal());
+void parallelOr(tesseract::BitVector &Dst, const tesseract::BitVector &Other,
+                ThreadPool &Pool = ThreadPool::getGlobal());
+void parallelXor(tesseract::BitVector &Dst, const tesseract::BitVector &Other,
+                 ThreadPool &Pool = ThreadPool::getGlobal());
+/// Dst = V1 - V2, as tesseract::BitVector::SetSubtract.
+void parallelSetSubtract(tesseract::BitVector &Dst,
+                         const tesseract::BitVector &V1,
+                         const tesseract::BitVector &V2,
+                         ThreadPool &Pool = ThreadPool::getGlobal());
+
+#endif /* ParallelBitOps_hpp */
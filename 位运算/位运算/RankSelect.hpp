@@ -0,0 +1,299 @@
+//
+//  RankSelect.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef RankSelect_hpp
+#define RankSelect_hpp
+
+#include "NBitVector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// Poppy: https://www.cs.cmu.edu/~dga/papers/zhou-sea2013.pdf
+
+/// RankSelectIndex - Constant time rank1/select1 over an NBitVector.
+///
+/// The index uses the cache-friendly "poppy" layout: one 64-bit entry per
+/// 2048-bit block holds the number of set bits before the block (32 bits)
+/// and the counts of the first three 512-bit sub-blocks (10 bits each), so a
+/// rank touches one index entry and at most eight words of the bit vector.
+/// select1 additionally samples the block of every SelectSampleRate-th set
+/// bit and binary searches the block entries between two samples. The total
+/// overhead is about 3.1% for rank plus at most 0.4% for select.
+///
+/// The index does not observe the bit vector. It describes the vector as it
+/// was when build() ran, and must be rebuilt after the vector changes: an
+/// index built over an NBitVector records the vector's generation, and
+/// valid() and the assertions in rank1/select1 check it.
+///
+/// The index can also be attached to words and index arrays it does not own,
+/// e.g. a memory-mapped file written with the index (see BitVectorFile.hpp).
+class RankSelectIndex {
+  typedef NBitVector::BitWord BitWord;
+
+  static_assert(NBitVector::BITWORD_SIZE == 64, "Unsupported word size");
+
+  enum {
+    BLOCK_BITS = 2048,
+    SUBBLOCK_BITS = 512,
+    WORDS_PER_BLOCK = BLOCK_BITS / 64,
+    WORDS_PER_SUBBLOCK = SUBBLOCK_BITS / 64,
+    SelectSampleRate = 8192
+  };
+
+  const NBitVector *Vector = nullptr;
+  /// Vector->getGeneration() when the index was built.
+  uint64_t Generation = 0;
+  const BitWord *Bits = nullptr;
+  unsigned Size = 0;
+  unsigned NumOnes = 0;
+  /// Per block: [63:32] set bits before the block, [29:0] three 10-bit
+  /// sub-block counts, the first one in the low bits.
+  std::vector<uint64_t> OwnedBlocks;
+  /// Block index holding the (i * SelectSampleRate)-th set bit.
+  std::vector<uint32_t> OwnedSamples;
+  /// Index arrays owned by someone else, see attach(). Null when owned.
+  const uint64_t *ExtBlocks = nullptr;
+  const uint32_t *ExtSamples = nullptr;
+  size_t NumBlocks = 0;
+  size_t NumSamples = 0;
+
+  const uint64_t *blocks() const {
+    return ExtBlocks ? ExtBlocks : OwnedBlocks.data();
+  }
+  const uint32_t *samples() const {
+    return ExtSamples ? ExtSamples : OwnedSamples.data();
+  }
+
+  static unsigned blockRank(uint64_t Entry) { return unsigned(Entry >> 32); }
+
+  /// Sum of the first N (0-3) sub-block counts of a block entry.
+  static unsigned subBlockRank(uint64_t Entry, unsigned N) {
+    unsigned Sum = 0;
+    for (unsigned i = 0; i < N; ++i)
+      Sum += (Entry >> (10 * i)) & 0x3ff;
+    return Sum;
+  }
+
+public:
+  /// Position of the K-th (0-based) set bit of Word. K < popcount(Word).
+  static unsigned selectInWord(uint64_t Word, unsigned K) {
+    unsigned Pos = 0;
+    for (;;) {
+      unsigned ByteCount = std::popcount(Word & 0xff);
+      if (K < ByteCount)
+        break;
+      K -= ByteCount;
+      Word >>= 8;
+      Pos += 8;
+    }
+    for (; K; --K)
+      Word &= Word - 1;
+    return Pos + std::countr_zero(Word);
+  }
+
+  RankSelectIndex() = default;
+  explicit RankSelectIndex(const NBitVector &V) { build(V); }
+
+  /// build - (Re)compute the index for V in a single pass over its words.
+  void build(const NBitVector &V) {
+    build(V.getData(), V.size());
+    Vector = &V;
+    Generation = V.getGeneration();
+  }
+
+  /// build - (Re)compute the index for the first NumBits bits of Words.
+  void build(const BitWord *Words, unsigned NumBits) {
+    Vector = nullptr;
+    Bits = Words;
+    Size = NumBits;
+    ExtBlocks = nullptr;
+    ExtSamples = nullptr;
+    unsigned NumWords = (NumBits + 63) / 64;
+    NumBlocks = (NumWords + WORDS_PER_BLOCK - 1) / WORDS_PER_BLOCK;
+    std::vector<uint64_t> &Blocks = OwnedBlocks;
+    std::vector<uint32_t> &Samples = OwnedSamples;
+    Blocks.assign(NumBlocks, 0);
+    Samples.clear();
+
+    unsigned Total = 0;
+    for (unsigned B = 0; B < NumBlocks; ++B) {
+      uint64_t Entry = uint64_t(Total) << 32;
+      unsigned BlockStart = Total;
+      for (unsigned S = 0; S < BLOCK_BITS / SUBBLOCK_BITS; ++S) {
+        unsigned Count = 0;
+        unsigned W = B * WORDS_PER_BLOCK + S * WORDS_PER_SUBBLOCK;
+        unsigned E = std::min<unsigned>(W + WORDS_PER_SUBBLOCK, NumWords);
+        for (; W < E; ++W)
+          Count += std::popcount(Bits[W]);
+        if (S < 3)
+          Entry |= uint64_t(Count) << (10 * S);
+        Total += Count;
+      }
+      // Sample every block that contains a multiple of SelectSampleRate.
+      while (Samples.size() * SelectSampleRate < Total &&
+             Samples.size() * SelectSampleRate >= BlockStart)
+        Samples.push_back(B);
+      Blocks[B] = Entry;
+    }
+    NumOnes = Total;
+    NumSamples = Samples.size();
+  }
+
+  /// attach - Use index arrays produced by an earlier build() over the same
+  /// bits, without copying them. All pointers must outlive the index. Check
+  /// arrays that were not built here with isConsistent() first.
+  void attach(const BitWord *Words, unsigned NumBits, unsigned Ones,
+              const uint64_t *BlockData, size_t BlockCount,
+              const uint32_t *SampleData, size_t SampleCount) {
+    Vector = nullptr;
+    Bits = Words;
+    Size = NumBits;
+    NumOnes = Ones;
+    OwnedBlocks.clear();
+    OwnedSamples.clear();
+    ExtBlocks = BlockData;
+    ExtSamples = SampleData;
+    NumBlocks = BlockCount;
+    NumSamples = SampleCount;
+  }
+
+  /// The raw index arrays, for persisting the index next to the bits.
+  const uint64_t *getBlockData() const { return blocks(); }
+  size_t getNumBlocks() const { return NumBlocks; }
+  const uint32_t *getSampleData() const { return samples(); }
+  size_t getNumSamples() const { return NumSamples; }
+
+  /// Returns the number of index blocks needed for NumBits bits.
+  static size_t getNumBlocksFor(uint64_t NumBits) {
+    return size_t((NumBits + BLOCK_BITS - 1) / BLOCK_BITS);
+  }
+  /// Returns the number of select samples for NumOnes set bits.
+  static size_t getNumSamplesFor(uint64_t NumOnes) {
+    return size_t((NumOnes + SelectSampleRate - 1) / SelectSampleRate);
+  }
+
+  /// isConsistent - Returns true if index arrays from an untrusted source,
+  /// e.g. a file, are shaped like those build() makes for NumBits bits with
+  /// NumOnes set: the right number of blocks and samples, block ranks that
+  /// never decrease nor exceed NumOnes, sub-block counts that fit their
+  /// sub-blocks, and samples that point at a block at or before their set
+  /// bit. O(blocks + samples). It cannot tell whether the counts match the
+  /// bits; rank1 and select1 over a consistent index stay within the bits
+  /// either way, but may return wrong answers.
+  static bool isConsistent(unsigned NumBits, unsigned NumOnes,
+                           const uint64_t *BlockData, size_t BlockCount,
+                           const uint32_t *SampleData, size_t SampleCount) {
+    if (BlockCount != getNumBlocksFor(NumBits) ||
+        SampleCount != getNumSamplesFor(NumOnes))
+      return false;
+    for (size_t B = 0; B < BlockCount; ++B) {
+      uint64_t Entry = BlockData[B];
+      for (unsigned S = 0; S < 3; ++S)
+        if (((Entry >> (10 * S)) & 0x3ff) > SUBBLOCK_BITS)
+          return false;
+      uint64_t End = uint64_t(blockRank(Entry)) + subBlockRank(Entry, 3);
+      uint64_t Next = B + 1 < BlockCount ? blockRank(BlockData[B + 1]) : NumOnes;
+      if ((B == 0 && blockRank(Entry) != 0) || End > Next || Next > NumOnes)
+        return false;
+    }
+    for (size_t i = 0; i < SampleCount; ++i)
+      if (SampleData[i] >= BlockCount ||
+          (i && SampleData[i] < SampleData[i - 1]) ||
+          blockRank(BlockData[SampleData[i]]) > i * SelectSampleRate)
+        return false;
+    return true;
+  }
+
+  /// valid - Returns true if the index was built for V and V has not been
+  /// modified since, according to its generation counter.
+  bool valid(const NBitVector &V) const {
+    return Vector == &V && Generation == V.getGeneration() &&
+           Bits == V.getData() && Size == V.size();
+  }
+
+  /// count - Returns the number of set bits in the indexed vector.
+  unsigned count() const { return NumOnes; }
+
+  /// rank1 - Returns the number of set bits in [0, Idx). Idx <= size().
+  unsigned rank1(unsigned Idx) const {
+    assert((Bits || !Size) && (!Vector || valid(*Vector)) &&
+           "Stale rank/select index");
+    assert(Idx <= Size && "Out-of-bounds rank");
+    if (Idx == Size)
+      return NumOnes;
+    uint64_t Entry = blocks()[Idx / BLOCK_BITS];
+    unsigned Rank = blockRank(Entry) +
+                    subBlockRank(Entry, (Idx % BLOCK_BITS) / SUBBLOCK_BITS);
+    unsigned W = Idx / SUBBLOCK_BITS * WORDS_PER_SUBBLOCK;
+    for (unsigned E = Idx / 64; W < E; ++W)
+      Rank += std::popcount(Bits[W]);
+    if (unsigned Rem = Idx % 64)
+      Rank += std::popcount(Bits[W] & maskTrailingOnes<BitWord>(Rem));
+    return Rank;
+  }
+
+  /// rank0 - Returns the number of unset bits in [0, Idx).
+  unsigned rank0(unsigned Idx) const { return Idx - rank1(Idx); }
+
+  /// select1 - Returns the position of the K-th (0-based) set bit, or -1 if
+  /// fewer than K + 1 bits are set.
+  int select1(unsigned K) const {
+    assert((Bits || !Size) && (!Vector || valid(*Vector)) &&
+           "Stale rank/select index");
+    if (K >= NumOnes)
+      return -1;
+
+    // Binary search for the last block starting at or before the K-th one,
+    // between the two samples around it.
+    const uint64_t *Blocks = blocks();
+    const uint32_t *Samples = samples();
+    unsigned Sample = K / SelectSampleRate;
+    unsigned Lo = Samples[Sample];
+    unsigned Hi = Sample + 1 < NumSamples ? Samples[Sample + 1] + 1
+                                          : unsigned(NumBlocks);
+    while (Hi - Lo > 1) {
+      unsigned Mid = Lo + (Hi - Lo) / 2;
+      if (blockRank(Blocks[Mid]) <= K)
+        Lo = Mid;
+      else
+        Hi = Mid;
+    }
+
+    uint64_t Entry = Blocks[Lo];
+    K -= blockRank(Entry);
+    unsigned S = 0;
+    for (; S < 3; ++S) {
+      unsigned Count = (Entry >> (10 * S)) & 0x3ff;
+      if (K < Count)
+        break;
+      K -= Count;
+    }
+
+    // The bit is in sub-block S. The scan is bounded all the same, so that
+    // an attached index that does not match its bits cannot read past them.
+    unsigned W = Lo * WORDS_PER_BLOCK + S * WORDS_PER_SUBBLOCK;
+    unsigned E = std::min<unsigned>(W + WORDS_PER_SUBBLOCK, (Size + 63) / 64);
+    for (; W < E; ++W) {
+      unsigned Count = std::popcount(Bits[W]);
+      if (K < Count)
+        return W * 64 + selectInWord(Bits[W], K);
+      K -= Count;
+    }
+    return -1;
+  }
+
+  /// Return the size (in bytes) of the index.
+  size_t getMemorySize() const {
+    return NumBlocks * sizeof(uint64_t) + NumSamples * sizeof(uint32_t);
+  }
+};
+
+#endif /* RankSelect_hpp */
@@ -0,0 +1,555 @@
+//
+//  RoaringBitmap.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "RoaringBitmap.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+
+namespace {
+
+void writeLE(std::vector<uint8_t> &Out, uint64_t V, unsigned Bytes) {
+  for (unsigned i = 0; i < Bytes; ++i)
+    Out.push_back(uint8_t(V >> (8 * i)));
+}
+
+uint64_t readLE(const uint8_t *Data, unsigned Bytes) {
+  uint64_t V = 0;
+  for (unsigned i = 0; i < Bytes; ++i)
+    V |= uint64_t(Data[i]) << (8 * i);
+  return V;
+}
+
+const uint32_t RoaringMagic = 0x314d4252; // "RBM1"
+
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// RoaringContainer
+//===----------------------------------------------------------------------===//
+
+void RoaringContainer::toBitmap() {
+  NBitVector NewDense(ChunkBits);
+  for_each_set_bit([&](uint32_t V) { NewDense.set(V); });
+  Dense = std::move(NewDense);
+  Values = std::vector<uint16_t>();
+  Runs = std::vector<RunInterval>();
+  K = Bitmap;
+}
+
+void RoaringContainer::toArray() {
+  std::vector<uint16_t> NewValues;
+  NewValues.reserve(Card);
+  for_each_set_bit([&](uint32_t V) { NewValues.push_back(uint16_t(V)); });
+  Values = std::move(NewValues);
+  Runs = std::vector<RunInterval>();
+  Dense = NBitVector();
+  K = Array;
+}
+
+void RoaringContainer::normalize() {
+  if (K == Array && Card > ArrayMaxSize)
+    toBitmap();
+  else if (K == Bitmap && Card <= ArrayMaxSize)
+    toArray();
+}
+
+void RoaringContainer::expandRuns() {
+  if (K != Run)
+    return;
+  if (Card > ArrayMaxSize)
+    toBitmap();
+  else
+    toArray();
+}
+
+bool RoaringContainer::test(uint16_t Low) const {
+  switch (K) {
+  case Array:
+    return std::binary_search(Values.begin(), Values.end(), Low);
+  case Bitmap:
+    return Dense.test(Low);
+  case Run: {
+    auto I = std::upper_bound(
+        Runs.begin(), Runs.end(), Low,
+        [](uint16_t V, const RunInterval &R) { return V < R.Start; });
+    return I != Runs.begin() && Low <= std::prev(I)->last();
+  }
+  }
+  return false;
+}
+
+bool RoaringContainer::set(uint16_t Low) {
+  switch (K) {
+  case Array: {
+    auto I = std::lower_bound(Values.begin(), Values.end(), Low);
+    if (I != Values.end() && *I == Low)
+      return false;
+    Values.insert(I, Low);
+    ++Card;
+    normalize();
+    return true;
+  }
+  case Bitmap:
+    if (Dense.test(Low))
+      return false;
+    Dense.set(Low);
+    ++Card;
+    return true;
+  case Run:
+    if (test(Low))
+      return false;
+    expandRuns();
+    return set(Low);
+  }
+  return false;
+}
+
+bool RoaringContainer::reset(uint16_t Low) {
+  switch (K) {
+  case Array: {
+    auto I = std::lower_bound(Values.begin(), Values.end(), Low);
+    if (I == Values.end() || *I != Low)
+      return false;
+    Values.erase(I);
+    --Card;
+    return true;
+  }
+  case Bitmap:
+    if (!Dense.test(Low))
+      return false;
+    Dense.reset(Low);
+    --Card;
+    normalize();
+    return true;
+  case Run:
+    if (!test(Low))
+      return false;
+    expandRuns();
+    return reset(Low);
+  }
+  return false;
+}
+
+RoaringContainer RoaringContainer::combineRuns(const RoaringContainer &LHS,
+                                               const RoaringContainer &RHS,
+                                               SetOp Op) {
+  if (LHS.K != Run || RHS.K != Run || (Op != OpAnd && Op != OpOr)) {
+    RoaringContainer L = LHS, R = RHS;
+    L.expandRuns();
+    R.expandRuns();
+    return combine(L, R, Op);
+  }
+
+  RoaringContainer C;
+  C.K = Run;
+  auto Append = [&C](uint32_t Start, uint32_t Last) {
+    if (!C.Runs.empty() && C.Runs.back().last() + 1 >= Start) {
+      RunInterval &Back = C.Runs.back();
+      uint32_t NewLast = std::max(Back.last(), Last);
+      C.Card += NewLast - Back.last();
+      Back.Length = uint16_t(NewLast - Back.Start);
+      return;
+    }
+    C.Runs.push_back({uint16_t(Start), uint16_t(Last - Start)});
+    C.Card += Last - Start + 1;
+  };
+
+  auto I = LHS.Runs.begin(), IE = LHS.Runs.end();
+  auto J = RHS.Runs.begin(), JE = RHS.Runs.end();
+  if (Op == OpAnd) {
+    while (I != IE && J != JE) {
+      uint32_t Start = std::max(I->Start, J->Start);
+      uint32_t Last = std::min(I->last(), J->last());
+      if (Start <= Last)
+        Append(Start, Last);
+      if (I->last() < J->last())
+        ++I;
+      else
+        ++J;
+    }
+  } else {
+    while (I != IE || J != JE) {
+      if (J == JE || (I != IE && I->Start < J->Start))
+        Append(I->Start, I->last()), ++I;
+      else
+        Append(J->Start, J->last()), ++J;
+    }
+  }
+  C.runOptimize();
+  return C;
+}
+
+RoaringContainer RoaringContainer::combine(const RoaringContainer &LHS,
+                                           const RoaringContainer &RHS,
+                                           SetOp Op) {
+  if (LHS.K == Run || RHS.K == Run)
+    return combineRuns(LHS, RHS, Op);
+
+  RoaringContainer C;
+  if (LHS.K == Array && RHS.K == Array) {
+    auto Out = std::back_inserter(C.Values);
+    const auto &L = LHS.Values, &R = RHS.Values;
+    switch (Op) {
+    case OpAnd:
+      std::set_intersection(L.begin(), L.end(), R.begin(), R.end(), Out);
+      break;
+    case OpOr:
+      std::set_union(L.begin(), L.end(), R.begin(), R.end(), Out);
+      break;
+    case OpXor:
+      std::set_symmetric_difference(L.begin(), L.end(), R.begin(), R.end(),
+                                    Out);
+      break;
+    case OpAndNot:
+      std::set_difference(L.begin(), L.end(), R.begin(), R.end(), Out);
+      break;
+    }
+    C.Card = uint32_t(C.Values.size());
+    C.normalize();
+    return C;
+  }
+
+  if (LHS.K == Bitmap && RHS.K == Bitmap) {
+    C.K = Bitmap;
+    C.Dense = LHS.Dense;
+    switch (Op) {
+    case OpAnd: C.Dense &= RHS.Dense; break;
+    case OpOr: C.Dense |= RHS.Dense; break;
+    case OpXor: C.Dense ^= RHS.Dense; break;
+    case OpAndNot: C.Dense.reset(RHS.Dense); break;
+    }
+    C.Card = C.Dense.count();
+    C.normalize();
+    return C;
+  }
+
+  // One array, one bitmap. Results that can only shrink the array are built
+  // as arrays, everything else starts from a copy of the bitmap.
+  const RoaringContainer &A = LHS.K == Array ? LHS : RHS;
+  const RoaringContainer &B = LHS.K == Array ? RHS : LHS;
+  if (Op == OpAnd || (Op == OpAndNot && LHS.K == Array)) {
+    bool Keep = Op == OpAnd;
+    for (uint16_t V : A.Values)
+      if (B.Dense.test(V) == Keep)
+        C.Values.push_back(V);
+    C.Card = uint32_t(C.Values.size());
+    return C;
+  }
+
+  C.K = Bitmap;
+  C.Dense = B.Dense;
+  for (uint16_t V : A.Values) {
+    if (Op == OpOr)
+      C.Dense.set(V);
+    else if (Op == OpXor)
+      C.Dense.flip(V);
+    else
+      C.Dense.reset(V);
+  }
+  C.Card = C.Dense.count();
+  C.normalize();
+  return C;
+}
+
+void RoaringContainer::runOptimize() {
+  // Count the runs without materializing them.
+  size_t NumRuns = 0;
+  switch (K) {
+  case Array:
+    for (size_t i = 0; i < Values.size(); ++i)
+      if (i == 0 || Values[i] != Values[i - 1] + 1)
+        ++NumRuns;
+    break;
+  case Bitmap: {
+    const NBitVector::BitWord *Words = Dense.getData();
+    NBitVector::BitWord Carry = 0;
+    for (unsigned i = 0, e = Dense.getNumWords(); i != e; ++i) {
+      // A run starts at every set bit whose lower neighbour is clear.
+      NumRuns += std::popcount(Words[i] & ~((Words[i] << 1) | Carry));
+      Carry = Words[i] >> (NBitVector::BITWORD_SIZE - 1);
+    }
+    break;
+  }
+  case Run:
+    NumRuns = Runs.size();
+    break;
+  }
+
+  size_t RunBytes = NumRuns * sizeof(RunInterval);
+  size_t OtherBytes = std::min<size_t>(Card * sizeof(uint16_t), ChunkBits / 8);
+  if (RunBytes >= OtherBytes) {
+    expandRuns();
+    return;
+  }
+  if (K == Run)
+    return;
+
+  std::vector<RunInterval> NewRuns;
+  NewRuns.reserve(NumRuns);
+  for_each_set_bit([&](uint32_t V) {
+    if (!NewRuns.empty() && NewRuns.back().last() + 1 == V)
+      ++NewRuns.back().Length;
+    else
+      NewRuns.push_back({uint16_t(V), 0});
+  });
+  Runs = std::move(NewRuns);
+  Values = std::vector<uint16_t>();
+  Dense = NBitVector();
+  K = Run;
+}
+
+bool RoaringContainer::operator==(const RoaringContainer &RHS) const {
+  if (Card != RHS.Card)
+    return false;
+  if (K == RHS.K) {
+    switch (K) {
+    case Array: return Values == RHS.Values;
+    case Bitmap: return Dense == RHS.Dense;
+    case Run: return Runs == RHS.Runs;
+    }
+  }
+  std::vector<uint16_t> L, R;
+  for_each_set_bit([&](uint32_t V) { L.push_back(uint16_t(V)); });
+  RHS.for_each_set_bit([&](uint32_t V) { R.push_back(uint16_t(V)); });
+  return L == R;
+}
+
+size_t RoaringContainer::getMemorySize() const {
+  return Values.capacity() * sizeof(uint16_t) +
+         Runs.capacity() * sizeof(RunInterval) + Dense.getMemorySize();
+}
+
+void RoaringContainer::serialize(std::vector<uint8_t> &Out) const {
+  writeLE(Out, K, 1);
+  switch (K) {
+  case Array:
+    writeLE(Out, Card, 4);
+    for (uint16_t V : Values)
+      writeLE(Out, V, 2);
+    break;
+  case Bitmap:
+    writeLE(Out, Card, 4);
+    for (unsigned i = 0, e = Dense.getNumWords(); i != e; ++i)
+      writeLE(Out, Dense.getData()[i], sizeof(NBitVector::BitWord));
+    break;
+  case Run:
+    writeLE(Out, Runs.size(), 4);
+    for (const RunInterval &R : Runs) {
+      writeLE(Out, R.Start, 2);
+      writeLE(Out, R.Length, 2);
+    }
+    break;
+  }
+}
+
+size_t RoaringContainer::deserialize(const uint8_t *Data, size_t Length) {
+  *this = RoaringContainer();
+  if (Length < 5)
+    return 0;
+  uint8_t Kind = Data[0];
+  uint32_t N = uint32_t(readLE(Data + 1, 4));
+  const uint8_t *P = Data + 5;
+  size_t Avail = Length - 5;
+
+  switch (Kind) {
+  case Array: {
+    if (N == 0 || N > ArrayMaxSize || Avail < size_t(N) * 2)
+      return 0;
+    for (uint32_t i = 0; i < N; ++i, P += 2) {
+      uint16_t V = uint16_t(readLE(P, 2));
+      if (i && V <= Values.back())
+        return 0;
+      Values.push_back(V);
+    }
+    Card = N;
+    break;
+  }
+  case Bitmap: {
+    const unsigned WordBytes = sizeof(NBitVector::BitWord);
+    const unsigned NumWords = unsigned(ChunkBits) / NBitVector::BITWORD_SIZE;
+    if (N <= ArrayMaxSize || Avail < size_t(NumWords) * WordBytes)
+      return 0;
+    K = Bitmap;
+    Dense = NBitVector(ChunkBits);
+    for (unsigned i = 0; i < NumWords; ++i, P += WordBytes) {
+      NBitVector::BitWord W = NBitVector::BitWord(readLE(P, WordBytes));
+      for (; W; W &= W - 1)
+        Dense.set(i * NBitVector::BITWORD_SIZE + std::countr_zero(W));
+    }
+    Card = Dense.count();
+    if (Card != N)
+      return 0;
+    break;
+  }
+  case Run: {
+    if (N == 0 || Avail < size_t(N) * 4)
+      return 0;
+    K = Run;
+    for (uint32_t i = 0; i < N; ++i, P += 4) {
+      RunInterval R = {uint16_t(readLE(P, 2)), uint16_t(readLE(P + 2, 2))};
+      if (R.last() >= ChunkBits ||
+          (i && uint32_t(R.Start) <= Runs.back().last() + 1))
+        return 0;
+      Runs.push_back(R);
+      Card += uint32_t(R.Length) + 1;
+    }
+    break;
+  }
+  default:
+    return 0;
+  }
+  return size_t(P - Data);
+}
+
+//===----------------------------------------------------------------------===//
+// RoaringBitmap
+//===----------------------------------------------------------------------===//
+
+long RoaringBitmap::findKey(uint16_t Key) const {
+  auto I = std::lower_bound(Keys.begin(), Keys.end(), Key);
+  long Pos = long(I - Keys.begin());
+  return (I != Keys.end() && *I == Key) ? Pos : ~Pos;
+}
+
+uint64_t RoaringBitmap::count() const {
+  uint64_t NumBits = 0;
+  for (const RoaringContainer &C : Containers)
+    NumBits += C.count();
+  return NumBits;
+}
+
+bool RoaringBitmap::test(uint32_t Idx) const {
+  long Pos = findKey(uint16_t(Idx >> 16));
+  return Pos >= 0 && Containers[Pos].test(uint16_t(Idx));
+}
+
+RoaringBitmap &RoaringBitmap::set(uint32_t Idx) {
+  uint16_t Key = uint16_t(Idx >> 16);
+  long Pos = findKey(Key);
+  if (Pos < 0) {
+    Pos = ~Pos;
+    Keys.insert(Keys.begin() + Pos, Key);
+    Containers.insert(Containers.begin() + Pos, RoaringContainer());
+  }
+  Containers[Pos].set(uint16_t(Idx));
+  return *this;
+}
+
+RoaringBitmap &RoaringBitmap::reset(uint32_t Idx) {
+  long Pos = findKey(uint16_t(Idx >> 16));
+  if (Pos >= 0 && Containers[Pos].reset(uint16_t(Idx)) &&
+      Containers[Pos].empty()) {
+    Keys.erase(Keys.begin() + Pos);
+    Containers.erase(Containers.begin() + Pos);
+  }
+  return *this;
+}
+
+RoaringBitmap RoaringBitmap::combine(const RoaringBitmap &LHS,
+                                     const RoaringBitmap &RHS,
+                                     RoaringContainer::SetOp Op) {
+  bool KeepLHSOnly = Op != RoaringContainer::OpAnd;
+  bool KeepRHSOnly =
+      Op == RoaringContainer::OpOr || Op == RoaringContainer::OpXor;
+
+  RoaringBitmap Result;
+  size_t I = 0, IE = LHS.Keys.size(), J = 0, JE = RHS.Keys.size();
+  while (I != IE || J != JE) {
+    if (J == JE || (I != IE && LHS.Keys[I] < RHS.Keys[J])) {
+      if (KeepLHSOnly) {
+        Result.Keys.push_back(LHS.Keys[I]);
+        Result.Containers.push_back(LHS.Containers[I]);
+      }
+      ++I;
+    } else if (I == IE || RHS.Keys[J] < LHS.Keys[I]) {
+      if (KeepRHSOnly) {
+        Result.Keys.push_back(RHS.Keys[J]);
+        Result.Containers.push_back(RHS.Containers[J]);
+      }
+      ++J;
+    } else {
+      RoaringContainer C =
+          RoaringContainer::combine(LHS.Containers[I], RHS.Containers[J], Op);
+      if (!C.empty()) {
+        Result.Keys.push_back(LHS.Keys[I]);
+        Result.Containers.push_back(std::move(C));
+      }
+      ++I, ++J;
+    }
+  }
+  return Result;
+}
+
+RoaringBitmap &RoaringBitmap::operator&=(const RoaringBitmap &RHS) {
+  return *this = combine(*this, RHS, RoaringContainer::OpAnd);
+}
+
+RoaringBitmap &RoaringBitmap::operator|=(const RoaringBitmap &RHS) {
+  return *this = combine(*this, RHS, RoaringContainer::OpOr);
+}
+
+RoaringBitmap &RoaringBitmap::operator^=(const RoaringBitmap &RHS) {
+  return *this = combine(*this, RHS, RoaringContainer::OpXor);
+}
+
+RoaringBitmap &RoaringBitmap::reset(const RoaringBitmap &RHS) {
+  return *this = combine(*this, RHS, RoaringContainer::OpAndNot);
+}
+
+bool RoaringBitmap::operator==(const RoaringBitmap &RHS) const {
+  return Keys == RHS.Keys && std::equal(Containers.begin(), Containers.end(),
+                                        RHS.Containers.begin());
+}
+
+void RoaringBitmap::runOptimize() {
+  for (RoaringContainer &C : Containers)
+    C.runOptimize();
+}
+
+size_t RoaringBitmap::getMemorySize() const {
+  size_t Bytes = Keys.capacity() * sizeof(uint16_t) +
+                 Containers.capacity() * sizeof(RoaringContainer);
+  for (const RoaringContainer &C : Containers)
+    Bytes += C.getMemorySize();
+  return Bytes;
+}
+
+void RoaringBitmap::serialize(std::vector<uint8_t> &Out) const {
+  writeLE(Out, RoaringMagic, 4);
+  writeLE(Out, Keys.size(), 4);
+  for (size_t i = 0; i < Keys.size(); ++i) {
+    writeLE(Out, Keys[i], 2);
+    Containers[i].serialize(Out);
+  }
+}
+
+bool RoaringBitmap::deserialize(const uint8_t *Data, size_t Length) {
+  Keys.clear();
+  Containers.clear();
+  if (Length < 8 || readLE(Data, 4) != RoaringMagic)
+    return false;
+  size_t N = size_t(readLE(Data + 4, 4));
+  size_t Pos = 8;
+  for (size_t i = 0; i < N; ++i) {
+    RoaringContainer C;
+    size_t Read = 0;
+    if (Length - Pos >= 2)
+      Read = C.deserialize(Data + Pos + 2, Length - Pos - 2);
+    uint16_t Key = Read ? uint16_t(readLE(Data + Pos, 2)) : 0;
+    if (!Read || (!Keys.empty() && Key <= Keys.back())) {
+      Keys.clear();
+      Containers.clear();
+      return false;
+    }
+    Keys.push_back(Key);
+    Containers.push_back(std::move(C));
+    Pos += 2 + Read;
+  }
+  return true;
+}
@@ -0,0 +1,187 @@
+//
+//  RoaringBitmap.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef RoaringBitmap_hpp
+#define RoaringBitmap_hpp
+
+#include "NBitVector.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// https://arxiv.org/abs/1603.06549
+
+/// RoaringContainer - The set of low 16 bits of one 64K chunk of a
+/// RoaringBitmap, in whichever of three representations is smallest:
+///  - Array:  sorted uint16_t values, for at most ArrayMaxSize values.
+///  - Bitmap: a 65536-bit NBitVector (8 KiB), for dense chunks.
+///  - Run:    sorted, non-adjacent [Start, Start + Length] runs, only chosen
+///            by runOptimize().
+class RoaringContainer {
+public:
+  enum Kind : uint8_t { Array, Bitmap, Run };
+
+  struct RunInterval {
+    uint16_t Start;
+    /// The run covers Start + Length, i.e. Length + 1 values.
+    uint16_t Length;
+
+    uint32_t last() const { return uint32_t(Start) + Length; }
+    bool operator==(const RunInterval &RHS) const {
+      return Start == RHS.Start && Length == RHS.Length;
+    }
+  };
+
+  enum { ChunkBits = 1 << 16, ArrayMaxSize = 4096 };
+
+  enum SetOp { OpAnd, OpOr, OpXor, OpAndNot };
+
+private:
+  Kind K = Array;
+  uint32_t Card = 0;
+  std::vector<uint16_t> Values;
+  std::vector<RunInterval> Runs;
+  NBitVector Dense;
+
+  /// Switch between Array and Bitmap so that neither exceeds its intended
+  /// cardinality range.
+  void normalize();
+  /// Convert a Run container into an Array or Bitmap one.
+  void expandRuns();
+  void toBitmap();
+  void toArray();
+
+  static RoaringContainer combineRuns(const RoaringContainer &LHS,
+                                      const RoaringContainer &RHS, SetOp Op);
+
+public:
+  Kind kind() const { return K; }
+  uint32_t count() const { return Card; }
+  bool empty() const { return Card == 0; }
+
+  bool test(uint16_t Low) const;
+  /// set/reset - Returns true if the container changed.
+  bool set(uint16_t Low);
+  bool reset(uint16_t Low);
+
+  /// Compute LHS Op RHS for any pair of container kinds.
+  static RoaringContainer combine(const RoaringContainer &LHS,
+                                  const RoaringContainer &RHS, SetOp Op);
+
+  /// runOptimize - Switch to the Run representation if it is the smallest.
+  void runOptimize();
+
+  bool operator==(const RoaringContainer &RHS) const;
+
+  template <typename Fn> void for_each_set_bit(Fn &&F) const {
+    switch (K) {
+    case Array:
+      for (uint16_t V : Values)
+        F(V);
+      break;
+    case Bitmap:
+      Dense.for_each_set_bit(F);
+      break;
+    case Run:
+      for (const RunInterval &R : Runs)
+        for (uint32_t V = R.Start, E = R.last(); V <= E; ++V)
+          F(V);
+      break;
+    }
+  }
+
+  /// Return the size (in bytes) of the payload.
+  size_t getMemorySize() const;
+
+  void serialize(std::vector<uint8_t> &Out) const;
+  /// Returns the number of bytes read, or 0 if Data is malformed.
+  size_t deserialize(const uint8_t *Data, size_t Length);
+};
+
+/// RoaringBitmap - A compressed set of uint32_t values.
+///
+/// The universe is split into 64K chunks keyed by the high 16 bits. Only
+/// non-empty chunks are stored, each in its own RoaringContainer, so memory
+/// is proportional to the number of set bits for sparse data and to 1 bit
+/// per value for dense clusters.
+class RoaringBitmap {
+  std::vector<uint16_t> Keys;
+  std::vector<RoaringContainer> Containers;
+
+  /// Index of Key in Keys, or ~index of the insertion point.
+  long findKey(uint16_t Key) const;
+
+  static RoaringBitmap combine(const RoaringBitmap &LHS,
+                               const RoaringBitmap &RHS,
+                               RoaringContainer::SetOp Op);
+
+public:
+  RoaringBitmap() = default;
+
+  bool empty() const { return Keys.empty(); }
+  bool any() const { return !empty(); }
+
+  /// count - Returns the number of values in the set.
+  uint64_t count() const;
+
+  bool test(uint32_t Idx) const;
+  RoaringBitmap &set(uint32_t Idx);
+  RoaringBitmap &reset(uint32_t Idx);
+
+  RoaringBitmap &operator&=(const RoaringBitmap &RHS);
+  RoaringBitmap &operator|=(const RoaringBitmap &RHS);
+  RoaringBitmap &operator^=(const RoaringBitmap &RHS);
+  /// reset - Reset bits that are set in RHS. Same as *this &= ~RHS.
+  RoaringBitmap &reset(const RoaringBitmap &RHS);
+
+  friend RoaringBitmap operator&(const RoaringBitmap &LHS,
+                                 const RoaringBitmap &RHS) {
+    return combine(LHS, RHS, RoaringContainer::OpAnd);
+  }
+  friend RoaringBitmap operator|(const RoaringBitmap &LHS,
+                                 const RoaringBitmap &RHS) {
+    return combine(LHS, RHS, RoaringContainer::OpOr);
+  }
+  friend RoaringBitmap operator^(const RoaringBitmap &LHS,
+                                 const RoaringBitmap &RHS) {
+    return combine(LHS, RHS, RoaringContainer::OpXor);
+  }
+  /// andNot - Returns the values of LHS that are not in RHS.
+  friend RoaringBitmap andNot(const RoaringBitmap &LHS,
+                              const RoaringBitmap &RHS) {
+    return combine(LHS, RHS, RoaringContainer::OpAndNot);
+  }
+
+  bool operator==(const RoaringBitmap &RHS) const;
+  bool operator!=(const RoaringBitmap &RHS) const { return !(*this == RHS); }
+
+  /// runOptimize - Convert containers to run lists where that is smaller.
+  void runOptimize();
+
+  /// for_each_set_bit - Calls F(Idx) for every value, in increasing order.
+  template <typename Fn> void for_each_set_bit(Fn &&F) const {
+    for (size_t i = 0; i < Keys.size(); ++i) {
+      uint32_t High = uint32_t(Keys[i]) << 16;
+      Containers[i].for_each_set_bit(
+          [&](uint32_t Low) { F(High | Low); });
+    }
+  }
+
+  /// Return the size (in bytes) of the bitmap, including container headers.
+  size_t getMemorySize() const;
+
+  /// serialize - Append a little-endian encoding of the set to Out:
+  ///   uint32 magic "RBM1", uint32 container count, then per container
+  ///   uint16 key, uint8 kind, uint32 cardinality or run count, payload.
+  void serialize(std::vector<uint8_t> &Out) const;
+  /// deserialize - Replace the set by the one encoded in Data. Returns false
+  /// and leaves the set empty if Data is malformed.
+  bool deserialize(const uint8_t *Data, size_t Length);
+};
+
+#endif /* RoaringBitmap_hpp */
@@ -0,0 +1,92 @@
+//
+//  SIMDDetect.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "SIMDDetect.hpp"
+#include "BitVectorKernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define HAS_CPUID
+#  include <cpuid.h>
+#  ifndef bit_AVX512VPOPCNTDQ
+#    define bit_AVX512VPOPCNTDQ (1 << 14)
+#  endif
+#endif
+
+namespace tesseract {
+
+const SIMDDetect &SIMDDetect::detector() {
+  static const SIMDDetect instance;
+  return instance;
+}
+
+#if defined(HAS_CPUID)
+// Reads the extended control register 0, which tells whether the OS saves the
+// AVX / AVX-512 register state on context switches.
+static inline unsigned long long xgetbv() {
+  unsigned eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<unsigned long long>(edx) << 32) | eax;
+}
+#endif
+
+// Constructor.
+// Tests the architecture in a system-dependent way to detect the SIMD
+// extensions and selects the matching bit vector kernels.
+SIMDDetect::SIMDDetect() {
+  const BitOpKernels *bit_ops = &kBitOpsGeneric;
+  PopCountFunction pop_count = PopCountGeneric;
+  const BitCountKernels *bit_counts = &kBitCountsGeneric;
+
+#if defined(HAS_CPUID)
+  unsigned a, b, c, d;
+  if (__get_cpuid(1, &a, &b, &c, &d)) {
+    sse2_available_ = (d & bit_SSE2) != 0;
+    popcnt_available_ = (c & bit_POPCNT) != 0;
+    // The OS must save the ymm (and zmm) state for AVX2 / AVX-512 to be usable.
+    bool xsave = (c & bit_OSXSAVE) != 0;
+    unsigned long long xcr0 = xsave ? xgetbv() : 0;
+    bool ymm_enabled = (xcr0 & 0x6) == 0x6;
+    bool zmm_enabled = (xcr0 & 0xe6) == 0xe6;
+    if (__get_cpuid_max(0, nullptr) >= 7) {
+      __cpuid_count(7, 0, a, b, c, d);
+      avx2_available_ = ymm_enabled && (b & bit_AVX2) != 0;
+      avx512F_available_ = zmm_enabled && (b & bit_AVX512F) != 0;
+      avx512vpopcntdq_available_ =
+          avx512F_available_ && (c & bit_AVX512VPOPCNTDQ) != 0;
+    }
+  }
+
+  // Select the fastest kernels the hardware supports.
+  if (avx512F_available_) {
+    bit_ops = &kBitOpsAVX512;
+  } else if (avx2_available_) {
+    bit_ops = &kBitOpsAVX2;
+  } else if (sse2_available_) {
+    bit_ops = &kBitOpsSSE2;
+  }
+  if (avx2_available_ && popcnt_available_) {
+    pop_count = PopCountAVX2;
+  } else if (popcnt_available_) {
+    pop_count = PopCountPOPCNT;
+  }
+  if (avx512vpopcntdq_available_) {
+    bit_counts = &kBitCountsAVX512;
+  } else if (avx2_available_ && popcnt_available_) {
+    bit_counts = &kBitCountsAVX2;
+  } else if (popcnt_available_) {
+    bit_counts = &kBitCountsPOPCNT;
+  }
+#endif
+
+  // Publish each choice once, so that a concurrent kernel call sees either
+  // its dispatch stub or the final kernels.
+  BitOps.store(bit_ops, std::memory_order_release);
+  PopCount.store(pop_count, std::memory_order_release);
+  BitCounts.store(bit_counts, std::memory_order_release);
+}
+
+} // namespace tesseract
@@ -0,0 +1,71 @@
+//
+//  SIMDDetect.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef SIMDDetect_hpp
+#define SIMDDetect_hpp
+
+// https://github.com/tesseract-ocr/tesseract/blob/main/src/arch/simddetect.h
+
+namespace tesseract {
+
+// Architecture detector. Add code here to detect any other architectures for
+// SIMD-based faster bit vector kernels. The detector runs once, on the first
+// query or the first call of a kernel, and selects the fastest available
+// kernels.
+class SIMDDetect {
+public:
+  // Returns true if SSE2 is available on this system.
+  static inline bool IsSSE2Available() {
+    return detector().sse2_available_;
+  }
+  // Returns true if AVX2 (integer AVX) is available on this system.
+  static inline bool IsAVX2Available() {
+    return detector().avx2_available_;
+  }
+  // Returns true if AVX512F is available on this system.
+  static inline bool IsAVX512FAvailable() {
+    return detector().avx512F_available_;
+  }
+  // Returns true if AVX512 VPOPCNTDQ (vpopcntq on zmm registers) is available
+  // on this system.
+  static inline bool IsAVX512VPOPCNTDQAvailable() {
+    return detector().avx512vpopcntdq_available_;
+  }
+  // Returns true if the popcnt instruction is available on this system.
+  static inline bool IsPOPCNTAvailable() {
+    return detector().popcnt_available_;
+  }
+
+  // Runs the detection and kernel selection if they have not run yet.
+  // Thread-safe: the detector is a function-local static, and it publishes
+  // each selected kernel pointer with a single release store.
+  static void Initialize() {
+    detector();
+  }
+
+private:
+  // Constructor, must set all static member variables.
+  SIMDDetect();
+
+  // Singleton, constructed on first use.
+  static const SIMDDetect &detector();
+
+  // If true, then SSe2 has been detected.
+  bool sse2_available_ = false;
+  // If true, then AVX2 has been detected.
+  bool avx2_available_ = false;
+  // If true, then AVX512F has been detected.
+  bool avx512F_available_ = false;
+  // If true, then AVX512 VPOPCNTDQ has been detected.
+  bool avx512vpopcntdq_available_ = false;
+  // If true, then popcnt has been detected.
+  bool popcnt_available_ = false;
+};
+
+} // namespace tesseract
+
+#endif /* SIMDDetect_hpp */
@@ -0,0 +1,128 @@
+//
+//  SetBitIterator.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef SetBitIterator_hpp
+#define SetBitIterator_hpp
+
+#include <bit>
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+// Shared set-bit iteration for all the bitset flavours in this project. They
+// all store bits little-endian in an array of unsigned words, so iterating
+// only needs the word array, its length and the number of valid bits.
+//
+// Each word is loaded once and the set bits are peeled off with x & (x - 1),
+// so the work is one count-trailing-zeros per set bit plus one test per word.
+
+/// Forward iterator over the indices of the set bits of a word array.
+template <typename WordT> class SetBitIterator {
+  static_assert(std::is_unsigned<WordT>::value, "Invalid word type!");
+  enum { BITS_PER_WORD = sizeof(WordT) * CHAR_BIT };
+
+  const WordT *Words = nullptr;
+  size_t NumWords = 0;
+  size_t NumBits = 0;
+  size_t WordIdx = 0;
+  // Remaining set bits of Words[WordIdx].
+  WordT Cur = 0;
+
+  // Bits past NumBits may be set in the last word, e.g. by a memset based
+  // set-all, so it is masked when loaded.
+  WordT load(size_t Idx) const {
+    WordT W = Words[Idx];
+    if (Idx == NumWords - 1 && NumBits % BITS_PER_WORD)
+      W &= WordT(-1) >> (BITS_PER_WORD - NumBits % BITS_PER_WORD);
+    return W;
+  }
+
+  void skipEmptyWords() {
+    while (!Cur && ++WordIdx < NumWords)
+      Cur = load(WordIdx);
+  }
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const size_t *;
+  using reference = size_t;
+
+  /// The end iterator.
+  SetBitIterator() = default;
+
+  SetBitIterator(const WordT *Words, size_t NumBits)
+      : Words(Words), NumWords((NumBits + BITS_PER_WORD - 1) / BITS_PER_WORD),
+        NumBits(NumBits) {
+    if (NumWords) {
+      Cur = load(0);
+      skipEmptyWords();
+    }
+  }
+
+  size_t operator*() const {
+    return WordIdx * BITS_PER_WORD + std::countr_zero(Cur);
+  }
+
+  SetBitIterator &operator++() {
+    Cur &= Cur - 1;
+    skipEmptyWords();
+    return *this;
+  }
+
+  SetBitIterator operator++(int) {
+    SetBitIterator Tmp = *this;
+    ++*this;
+    return Tmp;
+  }
+
+  /// All exhausted iterators compare equal to the default constructed one.
+  bool operator==(const SetBitIterator &RHS) const {
+    bool AtEnd = WordIdx >= NumWords, RHSAtEnd = RHS.WordIdx >= RHS.NumWords;
+    if (AtEnd || RHSAtEnd)
+      return AtEnd == RHSAtEnd;
+    return Words == RHS.Words && WordIdx == RHS.WordIdx && Cur == RHS.Cur;
+  }
+  bool operator!=(const SetBitIterator &RHS) const { return !(*this == RHS); }
+};
+
+/// A begin/end pair for range-based for loops over the set bits.
+template <typename WordT> class SetBitRange {
+  const WordT *Words;
+  size_t NumBits;
+
+public:
+  SetBitRange(const WordT *Words, size_t NumBits)
+      : Words(Words), NumBits(NumBits) {}
+
+  SetBitIterator<WordT> begin() const {
+    return SetBitIterator<WordT>(Words, NumBits);
+  }
+  SetBitIterator<WordT> end() const { return SetBitIterator<WordT>(); }
+};
+
+/// Calls F(Idx) for every set bit index of the first NumBits bits of Words,
+/// in increasing order. The inner loop has no word-boundary checks, so F is
+/// inlined into a tight loop.
+template <typename WordT, typename Fn>
+inline void forEachSetBitInWords(const WordT *Words, size_t NumBits, Fn &&F) {
+  constexpr size_t BitsPerWord = sizeof(WordT) * CHAR_BIT;
+  size_t FullWords = NumBits / BitsPerWord;
+  for (size_t i = 0; i < FullWords; ++i) {
+    for (WordT W = Words[i]; W; W &= W - 1)
+      F(i * BitsPerWord + std::countr_zero(W));
+  }
+  if (size_t Rem = NumBits % BitsPerWord) {
+    WordT W = Words[FullWords] & (WordT(-1) >> (BitsPerWord - Rem));
+    for (; W; W &= W - 1)
+      F(FullWords * BitsPerWord + std::countr_zero(W));
+  }
+}
+
+#endif /* SetBitIterator_hpp */
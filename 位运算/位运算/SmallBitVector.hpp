@@ -0,0 +1,612 @@
+//
+//  SmallBitVector.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef SmallBitVector_hpp
+#define SmallBitVector_hpp
+
+#include "NBitVector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+/// SmallBitVector - A bit vector that stores up to 120 bits inline, in the
+/// spirit of LLVM's SmallBitVector, and only allocates an NBitVector once it
+/// grows past that. The whole object is two words.
+///
+/// In small mode Words[0] holds bits [0, 64) and Words[1] holds bits
+/// [64, 120) in its low 56 bits, the size in bits [62:56] and a tag in bit 63.
+/// In large mode Words[1] is 0 and Words[0] is the NBitVector pointer. As in
+/// NBitVector, bits past size() are always zero.
+class SmallBitVector {
+public:
+  typedef NBitVector::BitWord BitWord;
+
+private:
+  enum {
+    BITWORD_SIZE = NBitVector::BITWORD_SIZE,
+    SmallNumSizeBits = 7,
+    SmallHiDataBits = BITWORD_SIZE - 1 - SmallNumSizeBits,
+    SmallNumDataBits = BITWORD_SIZE + SmallHiDataBits
+  };
+  static_assert(BITWORD_SIZE == 64, "Unsupported word size");
+  static_assert(sizeof(uintptr_t) <= sizeof(BitWord), "Pointer must fit a word");
+
+  static constexpr BitWord SmallTag = BitWord(1) << (BITWORD_SIZE - 1);
+  static constexpr BitWord HiDataMask = (BitWord(1) << SmallHiDataBits) - 1;
+
+  BitWord Words[2] = {0, SmallTag};
+
+public:
+  typedef unsigned size_type;
+
+  // Encapsulation of a single bit.
+  class reference {
+    SmallBitVector &TheVector;
+    unsigned BitPos;
+
+  public:
+    reference(SmallBitVector &b, unsigned Idx) : TheVector(b), BitPos(Idx) {}
+
+    reference(const reference&) = default;
+
+    reference& operator=(reference t) {
+      *this = bool(t);
+      return *this;
+    }
+
+    reference& operator=(bool t) {
+      if (t)
+        TheVector.set(BitPos);
+      else
+        TheVector.reset(BitPos);
+      return *this;
+    }
+
+    operator bool() const {
+      return const_cast<const SmallBitVector &>(TheVector).operator[](BitPos);
+    }
+  };
+
+private:
+  bool isSmall() const { return Words[1] & SmallTag; }
+
+  NBitVector *getPointer() const {
+    assert(!isSmall());
+    return reinterpret_cast<NBitVector *>(uintptr_t(Words[0]));
+  }
+
+  void switchToSmall(BitWord Lo, BitWord Hi, unsigned NewSize) {
+    Words[0] = Lo;
+    Words[1] = SmallTag | (BitWord(NewSize) << SmallHiDataBits) |
+               (Hi & HiDataMask);
+  }
+
+  void switchToLarge(NBitVector *BV) {
+    Words[0] = uintptr_t(BV);
+    Words[1] = 0;
+  }
+
+  unsigned getSmallSize() const {
+    return unsigned(Words[1] >> SmallHiDataBits) & ((1u << SmallNumSizeBits) - 1);
+  }
+
+  /// The I-th (0 or 1) data word of a small vector.
+  BitWord getSmallWord(unsigned I) const {
+    return I == 0 ? Words[0] : Words[1] & HiDataMask;
+  }
+
+  /// Mask of the bits of word I (0 or 1) in [Begin, End).
+  static BitWord rangeMask(unsigned Begin, unsigned End, unsigned I) {
+    unsigned Lo = std::clamp<int>(int(Begin) - int(I * BITWORD_SIZE), 0, BITWORD_SIZE);
+    unsigned Hi = std::clamp<int>(int(End) - int(I * BITWORD_SIZE), 0, BITWORD_SIZE);
+    return Lo < Hi ? maskTrailingOnes<BitWord>(Hi) & maskTrailingZeros<BitWord>(Lo)
+                   : 0;
+  }
+
+  /// Returns word I of either representation, 0 past the end.
+  BitWord getWord(unsigned I) const {
+    if (isSmall())
+      return I < 2 ? getSmallWord(I) : 0;
+    return I < getPointer()->getNumWords() ? getPointer()->getData()[I] : 0;
+  }
+
+  /// Overwrites word I, which must be in range. W must not have bits past
+  /// size().
+  void setWord(unsigned I, BitWord W) {
+    if (!isSmall())
+      getPointer()->getData()[I] = W;
+    else if (I == 0)
+      Words[0] = W;
+    else
+      Words[1] = (Words[1] & ~HiDataMask) | W;
+  }
+
+  /// Applies Op(Lo, Mask) to each small data word, with Mask selecting the
+  /// bits in [Begin, End).
+  template <typename OpFn>
+  void applySmall(unsigned Begin, unsigned End, OpFn Op) {
+    BitWord Lo = Op(getSmallWord(0), rangeMask(Begin, End, 0));
+    BitWord Hi = Op(getSmallWord(1), rangeMask(Begin, End, 1));
+    switchToSmall(Lo, Hi, getSmallSize());
+  }
+
+public:
+  /// Creates an empty bitvector.
+  SmallBitVector() = default;
+
+  /// Creates a bitvector of specified number of bits. All bits are initialized
+  /// to the specified value.
+  explicit SmallBitVector(unsigned s, bool t = false) {
+    if (s <= SmallNumDataBits)
+      switchToSmall(t ? rangeMask(0, s, 0) : 0, t ? rangeMask(0, s, 1) : 0, s);
+    else
+      switchToLarge(new NBitVector(s, t));
+  }
+
+  /// SmallBitVector copy ctor.
+  SmallBitVector(const SmallBitVector &RHS) {
+    if (RHS.isSmall()) {
+      Words[0] = RHS.Words[0];
+      Words[1] = RHS.Words[1];
+    } else {
+      switchToLarge(new NBitVector(*RHS.getPointer()));
+    }
+  }
+
+  /// Moves never allocate, so containers of SmallBitVectors move their
+  /// elements when they grow instead of copying the heap-backed ones.
+  SmallBitVector(SmallBitVector &&RHS) noexcept {
+    Words[0] = RHS.Words[0];
+    Words[1] = RHS.Words[1];
+    RHS.switchToSmall(0, 0, 0);
+  }
+
+  ~SmallBitVector() {
+    if (!isSmall())
+      delete getPointer();
+  }
+
+  SmallBitVector &operator=(const SmallBitVector &RHS) {
+    if (this == &RHS)
+      return *this;
+    if (RHS.isSmall()) {
+      if (!isSmall())
+        delete getPointer();
+      Words[0] = RHS.Words[0];
+      Words[1] = RHS.Words[1];
+    } else if (!isSmall()) {
+      *getPointer() = *RHS.getPointer();
+    } else {
+      switchToLarge(new NBitVector(*RHS.getPointer()));
+    }
+    return *this;
+  }
+
+  SmallBitVector &operator=(SmallBitVector &&RHS) noexcept {
+    if (this != &RHS) {
+      clear();
+      swap(RHS);
+    }
+    return *this;
+  }
+
+  void swap(SmallBitVector &RHS) noexcept {
+    std::swap(Words[0], RHS.Words[0]);
+    std::swap(Words[1], RHS.Words[1]);
+  }
+
+  /// isInline - Returns true if the bits are stored inline.
+  bool isInline() const { return isSmall(); }
+
+  bool empty() const { return size() == 0; }
+
+  size_type size() const {
+    return isSmall() ? getSmallSize() : getPointer()->size();
+  }
+
+  /// count - Returns the number of bits which are set.
+  size_type count() const {
+    if (isSmall())
+      return std::popcount(Words[0]) + std::popcount(getSmallWord(1));
+    return getPointer()->count();
+  }
+
+  /// count - Returns the number of set bits in the range [Begin, End).
+  size_type count(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= size() && "Invalid range");
+    if (isSmall())
+      return std::popcount(Words[0] & rangeMask(Begin, End, 0)) +
+             std::popcount(getSmallWord(1) & rangeMask(Begin, End, 1));
+    return getPointer()->count(Begin, End);
+  }
+
+  /// any - Returns true if any bit is set.
+  bool any() const {
+    if (isSmall())
+      return (Words[0] | getSmallWord(1)) != 0;
+    return getPointer()->any();
+  }
+
+  /// all - Returns true if all bits are set.
+  bool all() const {
+    if (isSmall())
+      return Words[0] == rangeMask(0, getSmallSize(), 0) &&
+             getSmallWord(1) == rangeMask(0, getSmallSize(), 1);
+    return getPointer()->all();
+  }
+
+  /// none - Returns true if none of the bits are set.
+  bool none() const { return !any(); }
+
+  /// find_first_in - Returns the index of the first set bit in the range
+  /// [Begin, End).  Returns -1 if all bits in the range are unset.
+  int find_first_in(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= size());
+    if (!isSmall())
+      return getPointer()->find_first_in(Begin, End);
+    if (BitWord W = Words[0] & rangeMask(Begin, End, 0))
+      return countTrailingZeros(W);
+    if (BitWord W = getSmallWord(1) & rangeMask(Begin, End, 1))
+      return BITWORD_SIZE + countTrailingZeros(W);
+    return -1;
+  }
+
+  /// find_last_in - Returns the index of the last set bit in the range
+  /// [Begin, End).  Returns -1 if all bits in the range are unset.
+  int find_last_in(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= size());
+    if (!isSmall())
+      return getPointer()->find_last_in(Begin, End);
+    if (BitWord W = getSmallWord(1) & rangeMask(Begin, End, 1))
+      return 2 * BITWORD_SIZE - 1 - countLeadingZeros(W);
+    if (BitWord W = Words[0] & rangeMask(Begin, End, 0))
+      return BITWORD_SIZE - 1 - countLeadingZeros(W);
+    return -1;
+  }
+
+  /// find_first_unset_in - Returns the index of the first unset bit in the
+  /// range [Begin, End).  Returns -1 if all bits in the range are set.
+  int find_first_unset_in(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= size());
+    if (!isSmall())
+      return getPointer()->find_first_unset_in(Begin, End);
+    if (BitWord W = ~Words[0] & rangeMask(Begin, End, 0))
+      return countTrailingZeros(W);
+    if (BitWord W = ~getSmallWord(1) & rangeMask(Begin, End, 1))
+      return BITWORD_SIZE + countTrailingZeros(W);
+    return -1;
+  }
+
+  /// find_last_unset_in - Returns the index of the last unset bit in the
+  /// range [Begin, End).  Returns -1 if all bits in the range are set.
+  int find_last_unset_in(unsigned Begin, unsigned End) const {
+    assert(Begin <= End && End <= size());
+    if (!isSmall())
+      return getPointer()->find_last_unset_in(Begin, End);
+    if (BitWord W = ~getSmallWord(1) & rangeMask(Begin, End, 1))
+      return 2 * BITWORD_SIZE - 1 - countLeadingZeros(W);
+    if (BitWord W = ~Words[0] & rangeMask(Begin, End, 0))
+      return BITWORD_SIZE - 1 - countLeadingZeros(W);
+    return -1;
+  }
+
+  int find_first() const { return find_first_in(0, size()); }
+  int find_last() const { return find_last_in(0, size()); }
+  int find_first_unset() const { return find_first_unset_in(0, size()); }
+  int find_last_unset() const { return find_last_unset_in(0, size()); }
+
+  /// find_next - Returns the index of the next set bit following the
+  /// "Prev" bit. Returns -1 if the next set bit is not found.
+  int find_next(unsigned Prev) const { return find_first_in(Prev + 1, size()); }
+
+  /// find_next_unset - Returns the index of the next unset bit following the
+  /// "Prev" bit.  Returns -1 if all remaining bits are set.
+  int find_next_unset(unsigned Prev) const {
+    return find_first_unset_in(Prev + 1, size());
+  }
+
+  /// find_prev - Returns the index of the first set bit that precedes the
+  /// bit at \p PriorTo.  Returns -1 if all previous bits are unset.
+  int find_prev(unsigned PriorTo) const { return find_last_in(0, PriorTo); }
+
+  /// find_prev_unset - Returns the index of the first unset bit that precedes
+  /// the bit at \p PriorTo.  Returns -1 if all previous bits are set.
+  int find_prev_unset(unsigned PriorTo) const {
+    return find_last_unset_in(0, PriorTo);
+  }
+
+  bool any_in(unsigned Begin, unsigned End) const {
+    return find_first_in(Begin, End) != -1;
+  }
+  bool all_in(unsigned Begin, unsigned End) const {
+    return find_first_unset_in(Begin, End) == -1;
+  }
+
+  /// for_each_set_bit - Calls F(Idx) for every set bit, in increasing order.
+  template <typename Fn> void for_each_set_bit(Fn &&F) const {
+    // The size and tag bits of Words[1] lie past size(), so they are masked.
+    if (isSmall())
+      forEachSetBitInWords(Words, getSmallSize(), F);
+    else
+      getPointer()->for_each_set_bit(F);
+  }
+
+  typedef SetBitIterator<BitWord> const_set_bits_iterator;
+  typedef const_set_bits_iterator set_iterator;
+
+  const_set_bits_iterator set_bits_begin() const {
+    return isSmall() ? const_set_bits_iterator(Words, getSmallSize())
+                     : getPointer()->set_bits_begin();
+  }
+  const_set_bits_iterator set_bits_end() const {
+    return const_set_bits_iterator();
+  }
+  SetBitRange<BitWord> set_bits() const {
+    return isSmall() ? SetBitRange<BitWord>(Words, getSmallSize())
+                     : getPointer()->set_bits();
+  }
+
+  /// clear - Clear all bits.
+  void clear() {
+    if (!isSmall())
+      delete getPointer();
+    switchToSmall(0, 0, 0);
+  }
+
+  /// resize - Grow or shrink the bitvector.
+  void resize(unsigned N, bool t = false) {
+    if (!isSmall()) {
+      getPointer()->resize(N, t);
+      return;
+    }
+    unsigned OldSize = getSmallSize();
+    if (N <= SmallNumDataBits) {
+      BitWord Fill[2] = {0, 0};
+      if (t && N > OldSize) {
+        Fill[0] = rangeMask(OldSize, N, 0);
+        Fill[1] = rangeMask(OldSize, N, 1);
+      }
+      // Shrinking clears the bits past N, growing sets the new bits to t.
+      BitWord Keep[2] = {rangeMask(0, std::min(N, OldSize), 0),
+                         rangeMask(0, std::min(N, OldSize), 1)};
+      switchToSmall((Words[0] & Keep[0]) | Fill[0],
+                    (getSmallWord(1) & Keep[1]) | Fill[1], N);
+      return;
+    }
+    // BV holds t everywhere, so only the old bits need to be copied over.
+    NBitVector *BV = new NBitVector(N, t);
+    BitWord *Data = BV->getData();
+    for (unsigned i = 0; i < 2; ++i)
+      Data[i] = (Data[i] & ~rangeMask(0, OldSize, i)) | getSmallWord(i);
+    switchToLarge(BV);
+  }
+
+  void reserve(unsigned N) {
+    if (isSmall()) {
+      if (N > SmallNumDataBits) {
+        unsigned SmallSize = getSmallSize();
+        NBitVector *BV = new NBitVector(SmallSize);
+        BV->reserve(N);
+        if (SmallSize) {
+          BV->getData()[0] = Words[0];
+          if (SmallSize > BITWORD_SIZE)
+            BV->getData()[1] = getSmallWord(1);
+        }
+        switchToLarge(BV);
+      }
+    } else {
+      getPointer()->reserve(N);
+    }
+  }
+
+  /// push_back - Append one bit.
+  void push_back(bool Val) { resize(size() + 1, Val); }
+
+  // Set, reset, flip
+  SmallBitVector &set() {
+    if (isSmall())
+      applySmall(0, getSmallSize(), [](BitWord, BitWord Mask) { return Mask; });
+    else
+      getPointer()->set();
+    return *this;
+  }
+
+  SmallBitVector &set(unsigned Idx) {
+    assert(Idx < size() && "Out-of-bounds Bit access.");
+    if (isSmall())
+      Words[Idx / BITWORD_SIZE] |= BitWord(1) << (Idx % BITWORD_SIZE);
+    else
+      getPointer()->set(Idx);
+    return *this;
+  }
+
+  /// set - Efficiently set a range of bits in [Begin, End).
+  SmallBitVector &set(unsigned Begin, unsigned End) {
+    assert(Begin <= End && "Attempted to set backwards range!");
+    assert(End <= size() && "Attempted to set out-of-bounds range!");
+    if (isSmall())
+      applySmall(Begin, End, [](BitWord W, BitWord Mask) { return W | Mask; });
+    else
+      getPointer()->set(Begin, End);
+    return *this;
+  }
+
+  SmallBitVector &reset() {
+    if (isSmall())
+      switchToSmall(0, 0, getSmallSize());
+    else
+      getPointer()->reset();
+    return *this;
+  }
+
+  SmallBitVector &reset(unsigned Idx) {
+    assert(Idx < size() && "Out-of-bounds Bit access.");
+    if (isSmall())
+      Words[Idx / BITWORD_SIZE] &= ~(BitWord(1) << (Idx % BITWORD_SIZE));
+    else
+      getPointer()->reset(Idx);
+    return *this;
+  }
+
+  /// reset - Efficiently reset a range of bits in [Begin, End).
+  SmallBitVector &reset(unsigned Begin, unsigned End) {
+    assert(Begin <= End && "Attempted to reset backwards range!");
+    assert(End <= size() && "Attempted to reset out-of-bounds range!");
+    if (isSmall())
+      applySmall(Begin, End, [](BitWord W, BitWord Mask) { return W & ~Mask; });
+    else
+      getPointer()->reset(Begin, End);
+    return *this;
+  }
+
+  SmallBitVector &flip() { return flip(0, size()); }
+
+  SmallBitVector &flip(unsigned Idx) {
+    assert(Idx < size() && "Out-of-bounds Bit access.");
+    if (isSmall())
+      Words[Idx / BITWORD_SIZE] ^= BitWord(1) << (Idx % BITWORD_SIZE);
+    else
+      getPointer()->flip(Idx);
+    return *this;
+  }
+
+  /// flip - Flip a range of bits in [Begin, End).
+  SmallBitVector &flip(unsigned Begin, unsigned End) {
+    assert(Begin <= End && "Attempted to flip backwards range!");
+    assert(End <= size() && "Attempted to flip out-of-bounds range!");
+    if (isSmall())
+      applySmall(Begin, End, [](BitWord W, BitWord Mask) { return W ^ Mask; });
+    else
+      getPointer()->flip(Begin, End);
+    return *this;
+  }
+
+  // Indexing.
+  reference operator[](unsigned Idx) {
+    assert(Idx < size() && "Out-of-bounds Bit access.");
+    return reference(*this, Idx);
+  }
+
+  bool operator[](unsigned Idx) const {
+    assert(Idx < size() && "Out-of-bounds Bit access.");
+    if (isSmall())
+      return (Words[Idx / BITWORD_SIZE] >> (Idx % BITWORD_SIZE)) & 1;
+    return getPointer()->operator[](Idx);
+  }
+
+  bool test(unsigned Idx) const { return (*this)[Idx]; }
+
+  bool at(uint32_t Idx) const { return (*this)[Idx]; }
+
+  /// anyCommon - Test if any common bits are set.
+  bool anyCommon(const SmallBitVector &RHS) const {
+    if (isSmall() && RHS.isSmall())
+      return ((Words[0] & RHS.Words[0]) |
+              (getSmallWord(1) & RHS.getSmallWord(1))) != 0;
+    unsigned NumWords = std::min(getNumWords(), RHS.getNumWords());
+    for (unsigned i = 0; i < NumWords; ++i)
+      if (getWord(i) & RHS.getWord(i))
+        return true;
+    return false;
+  }
+
+  // Comparison operators.
+  bool operator==(const SmallBitVector &RHS) const {
+    if (size() != RHS.size())
+      return false;
+    if (isSmall() && RHS.isSmall())
+      return Words[0] == RHS.Words[0] && Words[1] == RHS.Words[1];
+    if (!isSmall() && !RHS.isSmall())
+      return *getPointer() == *RHS.getPointer();
+    for (unsigned i = 0, e = getNumWords(); i != e; ++i)
+      if (getWord(i) != RHS.getWord(i))
+        return false;
+    return true;
+  }
+
+  bool operator!=(const SmallBitVector &RHS) const {
+    return !(*this == RHS);
+  }
+
+  // Intersection, union, disjoint union.
+  SmallBitVector &operator&=(const SmallBitVector &RHS) {
+    if (isSmall() && RHS.isSmall()) {
+      // Bits of RHS past its size are zero, so bits past it get cleared.
+      Words[0] &= RHS.Words[0];
+      Words[1] &= RHS.Words[1] | ~HiDataMask;
+    } else if (!isSmall() && !RHS.isSmall()) {
+      *getPointer() &= *RHS.getPointer();
+    } else {
+      for (unsigned i = 0, e = getNumWords(); i != e; ++i)
+        setWord(i, getWord(i) & RHS.getWord(i));
+    }
+    return *this;
+  }
+
+  /// reset - Reset bits that are set in RHS. Same as *this &= ~RHS.
+  SmallBitVector &reset(const SmallBitVector &RHS) {
+    if (isSmall() && RHS.isSmall()) {
+      Words[0] &= ~RHS.Words[0];
+      Words[1] &= ~(RHS.Words[1] & HiDataMask);
+    } else if (!isSmall() && !RHS.isSmall()) {
+      getPointer()->reset(*RHS.getPointer());
+    } else {
+      for (unsigned i = 0, e = getNumWords(); i != e; ++i)
+        setWord(i, getWord(i) & ~RHS.getWord(i));
+    }
+    return *this;
+  }
+
+  SmallBitVector &operator|=(const SmallBitVector &RHS) {
+    if (size() < RHS.size())
+      resize(RHS.size());
+    if (isSmall() && RHS.isSmall()) {
+      Words[0] |= RHS.Words[0];
+      Words[1] |= RHS.Words[1] & HiDataMask;
+    } else if (!isSmall() && !RHS.isSmall()) {
+      *getPointer() |= *RHS.getPointer();
+    } else {
+      for (unsigned i = 0, e = RHS.getNumWords(); i != e; ++i)
+        setWord(i, getWord(i) | RHS.getWord(i));
+    }
+    return *this;
+  }
+
+  SmallBitVector &operator^=(const SmallBitVector &RHS) {
+    if (size() < RHS.size())
+      resize(RHS.size());
+    if (isSmall() && RHS.isSmall()) {
+      Words[0] ^= RHS.Words[0];
+      Words[1] ^= RHS.Words[1] & HiDataMask;
+    } else if (!isSmall() && !RHS.isSmall()) {
+      *getPointer() ^= *RHS.getPointer();
+    } else {
+      for (unsigned i = 0, e = RHS.getNumWords(); i != e; ++i)
+        setWord(i, getWord(i) ^ RHS.getWord(i));
+    }
+    return *this;
+  }
+
+  /// Returns the number of words in use.
+  unsigned getNumWords() const {
+    return (size() + BITWORD_SIZE - 1) / BITWORD_SIZE;
+  }
+
+  /// Return the size (in bytes) of the bit vector, heap storage included.
+  size_t getMemorySize() const {
+    if (isSmall())
+      return sizeof(*this);
+    return sizeof(*this) + sizeof(NBitVector) + getPointer()->getMemorySize();
+  }
+};
+
+inline void swap(SmallBitVector &LHS, SmallBitVector &RHS) { LHS.swap(RHS); }
+
+#endif /* SmallBitVector_hpp */
@@ -10,35 +10,64 @@
 
 // https://github.com/pkubaj/tesseract/blob/fa29bb48660fd4883a1427e803d1feb6f61efb72/src/ccutil/bitvector.h#L45
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cstdint> // for uint8_t
 #include <cstdio>
+#include <cstring>
+#include <memory>
 #include <vector>  // for std::vector
 
+#include "AlignedAllocator.hpp"
+#include "BitVectorKernels.hpp"
+#include "SetBitIterator.hpp"
+
 namespace tesseract {
 
+// The BitVectorFile.hpp glue of Serialize and DeSerialize, defined in
+// BitVectorFile.cpp so that this header does not pull in the file format.
+// Writes the bit_size bits of words to fp.
+bool SerializeBitVector(FILE *fp, const uint32_t *words, int bit_size);
+// Reads a vector from fp. Once the header checks out, calls
+// alloc(ctx, bit_size) for storage of the words, which are all overwritten.
+bool DeSerializeBitVector(FILE *fp, uint32_t *(*alloc)(void *ctx, int bit_size),
+                          void *ctx);
+
 // Trivial class to encapsulate a fixed-length array of bits, with
 // Serialize/DeSerialize. Replaces the old macros.
-class BitVector {
+// The words are allocated by AllocatorT (rebound to uint32_t), cache-line
+// aligned by default; BitVector is the default instantiation, compiled once
+// in TBitVector.cpp.
+template <typename AllocatorT = AlignedAllocator<uint32_t>>
+class BasicBitVector {
 public:
-  // Fast lookup table to get the first least significant set bit in a byte.
-  // For zero, the table has 255, but since it is a special case, most code
-  // that uses this table will check for zero before looking up lsb_index_.
-  static const uint8_t lsb_index_[256];
-  // Fast lookup table to get the residual bits after zeroing the least
-  // significant set bit in a byte.
-  static const uint8_t lsb_eroded_[256];
-  // Fast lookup table to give the number of set bits in a byte.
-  static const int hamming_table_[256];
-
-  BitVector() = default;
+  using allocator_type =
+      typename std::allocator_traits<AllocatorT>::template rebind_alloc<uint32_t>;
+
+  BasicBitVector() = default;
+  explicit BasicBitVector(const allocator_type &alloc) : array_(alloc) {
+  }
   // Initializes the array to length * false.
-  explicit BitVector(int length) : bit_size_(length), array_(WordLength()) {
+  explicit BasicBitVector(int length, const allocator_type &alloc = allocator_type())
+      : bit_size_(length), array_(WordLength(), alloc) {
+  }
+  BasicBitVector(const BasicBitVector &src) : bit_size_(src.bit_size_), array_(src.array_) {
   }
-  BitVector(const BitVector &src) : bit_size_(src.bit_size_), array_(src.array_) {
+  // Takes the words of src without allocating, and leaves it empty.
+  BasicBitVector(BasicBitVector &&src) noexcept
+      : bit_size_(src.bit_size_), array_(std::move(src.array_)) {
+    src.bit_size_ = 0;
+  }
+  BasicBitVector &operator=(const BasicBitVector &src);
+  BasicBitVector &operator=(BasicBitVector &&src) noexcept(
+      std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
+      std::allocator_traits<allocator_type>::is_always_equal::value);
+  ~BasicBitVector() = default;
+
+  allocator_type get_allocator() const {
+    return array_.get_allocator();
   }
-  BitVector &operator=(const BitVector &src);
-  ~BitVector() = default;
 
   // Initializes the array to length * false.
   void Init(int length);
@@ -52,6 +81,13 @@ public:
     return bit_size_;
   }
 
+  // Writes to the given file in the BitVectorFile.hpp format, so the result
+  // can also be memory mapped. Returns false on error.
+  bool Serialize(FILE *fp) const;
+  // Reads from the given file. Returns false in case of error, leaving the
+  // vector unchanged.
+  bool DeSerialize(FILE *fp);
+
   void SetAllFalse();
   void SetAllTrue();
 
@@ -85,13 +121,32 @@ public:
   // Returns the number of set bits in the vector.
   int NumSetBits() const;
 
+  // Iterates the indices of the set bits in increasing order, either with a
+  // range-based for loop or by calling fn(index) for each of them.
+  SetBitRange<uint32_t> SetBits() const {
+    return SetBitRange<uint32_t>(array_.data(), bit_size_);
+  }
+  template <typename Fn>
+  void ForEachSetBit(Fn &&fn) const {
+    forEachSetBitInWords(array_.data(), bit_size_, fn);
+  }
+
+  // Raw words, little-endian by uint32_t, for the word-level kernels layered
+  // on top (BitExpr.hpp). Bits past size() must be kept zero.
+  const uint32_t *data() const {
+    return array_.data();
+  }
+  uint32_t *data() {
+    return array_.data();
+  }
+
   // Logical in-place operations on whole bit vectors. Tries to do something
   // sensible if they aren't the same size, but they should be really.
-  void operator|=(const BitVector &other);
-  void operator&=(const BitVector &other);
-  void operator^=(const BitVector &other);
+  void operator|=(const BasicBitVector &other);
+  void operator&=(const BasicBitVector &other);
+  void operator^=(const BasicBitVector &other);
   // Set subtraction *this = v1 - v2.
-  void SetSubtract(const BitVector &v1, const BitVector &v2);
+  void SetSubtract(const BasicBitVector &v1, const BasicBitVector &v2);
 
 private:
   // Allocates memory for a vector of the given length.
@@ -112,6 +167,23 @@ private:
   int WordLength() const {
     return (bit_size_ + kBitFactor - 1) / kBitFactor;
   }
+  // Clears the bits of the last word past bit_size_, which NumSetBits, the
+  // fused counts and NextSetBit read as part of whole words.
+  void ClearPadding() {
+    if (bit_size_ % kBitFactor != 0) {
+      array_[WordLength() - 1] &= BitMask(bit_size_) - 1;
+    }
+  }
+  // Returns the 64 bits starting at array_[2 * index], ie the index-th
+  // 64-bit word of the little-endian bit order. Reads past the end are zero.
+  uint64_t Word64(int index) const {
+    int w = 2 * index;
+    uint64_t word = array_[w];
+    if (w + 1 < WordLength()) {
+      word |= static_cast<uint64_t>(array_[w + 1]) << 32;
+    }
+    return word;
+  }
   // Returns the number of bytes consumed by the array_.
   int ByteLength() const {
     return WordLength() * sizeof(array_[0]);
@@ -122,11 +194,156 @@ private:
   // Array of words used to pack the bits.
   // Bits are stored little-endian by uint32_t word, ie by word first and then
   // starting with the least significant bit in each word.
-  std::vector<uint32_t> array_;
+  std::vector<uint32_t, allocator_type> array_;
   // Number of bits in an array_ element.
   static const int kBitFactor = sizeof(array_[0]) * 8;
 };
 
+template <typename AllocatorT>
+BasicBitVector<AllocatorT> &BasicBitVector<AllocatorT>::operator=(const BasicBitVector &src) {
+  array_ = src.array_;
+  bit_size_ = src.bit_size_;
+  return *this;
+}
+
+template <typename AllocatorT>
+BasicBitVector<AllocatorT> &BasicBitVector<AllocatorT>::operator=(BasicBitVector &&src) noexcept(
+    std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
+    std::allocator_traits<allocator_type>::is_always_equal::value) {
+  if (this != &src) {
+    array_ = std::move(src.array_);
+    bit_size_ = src.bit_size_;
+    src.array_.clear();
+    src.bit_size_ = 0;
+  }
+  return *this;
+}
+
+// Initializes the array to length * false.
+template <typename AllocatorT>
+void BasicBitVector<AllocatorT>::Init(int length) {
+  Alloc(length);
+  SetAllFalse();
+}
+
+// Writes to the given file. Returns false in case of error.
+template <typename AllocatorT>
+bool BasicBitVector<AllocatorT>::Serialize(FILE *fp) const {
+  return SerializeBitVector(fp, array_.data(), bit_size_);
+}
+
+// Reads from the given file. Returns false in case of error.
+template <typename AllocatorT>
+bool BasicBitVector<AllocatorT>::DeSerialize(FILE *fp) {
+  BasicBitVector result(array_.get_allocator());
+  auto alloc = [](void *ctx, int bit_size) {
+    auto *v = static_cast<BasicBitVector *>(ctx);
+    v->Alloc(bit_size);
+    return v->array_.data();
+  };
+  if (!DeSerializeBitVector(fp, alloc, &result)) {
+    return false;
+  }
+  *this = std::move(result);
+  return true;
+}
+
+template <typename AllocatorT>
+void BasicBitVector<AllocatorT>::SetAllFalse() {
+  memset(&array_[0], 0, ByteLength());
+}
+template <typename AllocatorT>
+void BasicBitVector<AllocatorT>::SetAllTrue() {
+  memset(&array_[0], ~0, ByteLength());
+  ClearPadding();
+}
+
+// Returns the index of the next set bit after the given index.
+// Useful for quickly iterating through the set bits in a sparse vector.
+// Scans 64 bits at a time, so the cost is one count-trailing-zeros for the
+// bit found plus one test per zero 64-bit word skipped.
+template <typename AllocatorT>
+int BasicBitVector<AllocatorT>::NextSetBit(int prev_bit) const {
+  // Move on to the next bit.
+  int next_bit = prev_bit + 1;
+  if (next_bit >= bit_size_) {
+    return -1;
+  }
+  // Mask off the bits below next_bit in the 64-bit word containing it.
+  int next_word = next_bit / 64;
+  uint64_t word = Word64(next_word) & (~uint64_t(0) << (next_bit % 64));
+  int wordlen = (WordLength() + 1) / 2;
+  while (word == 0) {
+    if (++next_word >= wordlen) {
+      return -1;
+    }
+    word = Word64(next_word);
+  }
+  return next_word * 64 + std::countr_zero(word);
+}
+
+// Returns the number of set bits in the vector.
+template <typename AllocatorT>
+int BasicBitVector<AllocatorT>::NumSetBits() const {
+  return static_cast<int>(
+      PopCount.load(std::memory_order_acquire)(array_.data(), WordLength()));
+}
+
+// Logical in-place operations on whole bit vectors. Tries to do something
+// sensible if they aren't the same size, but they should be really.
+// The word loops are delegated to the kernels selected by SIMDDetect.
+template <typename AllocatorT>
+void BasicBitVector<AllocatorT>::operator|=(const BasicBitVector &other) {
+  int length = std::min(WordLength(), other.WordLength());
+  BitOps.load(std::memory_order_acquire)
+      ->Or(array_.data(), array_.data(), other.array_.data(), length);
+  // A longer other may have bits in our last word past the end.
+  ClearPadding();
+}
+template <typename AllocatorT>
+void BasicBitVector<AllocatorT>::operator&=(const BasicBitVector &other) {
+  int length = std::min(WordLength(), other.WordLength());
+  BitOps.load(std::memory_order_acquire)
+      ->And(array_.data(), array_.data(), other.array_.data(), length);
+  for (int w = WordLength() - 1; w >= length; --w) {
+    array_[w] = 0;
+  }
+}
+template <typename AllocatorT>
+void BasicBitVector<AllocatorT>::operator^=(const BasicBitVector &other) {
+  int length = std::min(WordLength(), other.WordLength());
+  BitOps.load(std::memory_order_acquire)
+      ->Xor(array_.data(), array_.data(), other.array_.data(), length);
+  ClearPadding();
+}
+// Set subtraction *this = v1 - v2.
+template <typename AllocatorT>
+void BasicBitVector<AllocatorT>::SetSubtract(const BasicBitVector &v1, const BasicBitVector &v2) {
+  Alloc(v1.size());
+  int length = std::min(v1.WordLength(), v2.WordLength());
+  BitOps.load(std::memory_order_acquire)
+      ->AndNot(array_.data(), v1.array_.data(), v2.array_.data(), length);
+  for (int w = WordLength() - 1; w >= length; --w) {
+    array_[w] = v1.array_[w];
+  }
+}
+
+// Allocates memory for a vector of the given length.
+// Reallocates if the array is a different size, larger or smaller.
+template <typename AllocatorT>
+void BasicBitVector<AllocatorT>::Alloc(int length) {
+  int initial_wordlength = WordLength();
+  bit_size_ = length;
+  int new_wordlength = WordLength();
+  if (new_wordlength != initial_wordlength) {
+    array_.resize(new_wordlength);
+  }
+}
+
+using BitVector = BasicBitVector<>;
+
+extern template class BasicBitVector<>;
+
 } // namespace tesseract.
 
 #endif /* TBitVector_hpp */
@@ -0,0 +1,72 @@
+//
+//  ThreadPool.cpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned NumThreads) {
+  if (NumThreads == 0)
+    NumThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned i = 1; i < NumThreads; ++i)
+    Workers.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Stopping = true;
+  }
+  WorkReady.notify_all();
+  for (std::thread &W : Workers)
+    W.join();
+}
+
+ThreadPool &ThreadPool::getGlobal() {
+  static ThreadPool Pool;
+  return Pool;
+}
+
+void ThreadPool::run(size_t NumTasks, const std::function<void(size_t)> &Task) {
+  std::lock_guard<std::mutex> RunLock(RunMutex);
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    CurrentTask = &Task;
+    TaskCount = NumTasks;
+    NextTask.store(0, std::memory_order_relaxed);
+    Pending = unsigned(Workers.size());
+    ++Generation;
+  }
+  WorkReady.notify_all();
+  drain();
+
+  // Task lives on the caller's stack, so wait until no worker can touch it.
+  std::unique_lock<std::mutex> Lock(Mutex);
+  WorkDone.wait(Lock, [this] { return Pending == 0; });
+  CurrentTask = nullptr;
+}
+
+void ThreadPool::workerLoop() {
+  uint64_t Seen = 0;
+  for (;;) {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    WorkReady.wait(Lock, [&] { return Stopping || Generation != Seen; });
+    if (Stopping)
+      return;
+    Seen = Generation;
+    Lock.unlock();
+    drain();
+    Lock.lock();
+    if (--Pending == 0)
+      WorkDone.notify_one();
+  }
+}
+
+void ThreadPool::drain() {
+  for (size_t I; (I = NextTask.fetch_add(1, std::memory_order_relaxed)) < TaskCount;)
+    (*CurrentTask)(I);
+}
@@ -0,0 +1,75 @@
+//
+//  ThreadPool.hpp
+//  位运算
+//
+//  Created by Roy Cao on 2026/10/16.
+//
+
+#ifndef ThreadPool_hpp
+#define ThreadPool_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// ThreadPool - A fixed set of worker threads for fork-join loops.
+///
+/// parallelFor() hands out task indices through one atomic counter, so
+/// uneven tasks balance themselves, and the calling thread works too. The
+/// threads are started once and sleep on a condition variable between loops,
+/// so a loop costs one wake-up instead of thread creation.
+class ThreadPool {
+public:
+  /// Creates a pool running loops on NumThreads threads, the caller
+  /// included. 0 means one per hardware thread.
+  explicit ThreadPool(unsigned NumThreads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// Number of threads a loop runs on, the caller included.
+  unsigned getNumThreads() const { return unsigned(Workers.size()) + 1; }
+
+  /// parallelFor - Calls F(I) for every I in [0, NumTasks) and returns when
+  /// all calls have returned. Calls run concurrently in any order. Loops
+  /// from different threads are serialized; F must not start another loop
+  /// on the same pool.
+  template <typename Fn> void parallelFor(size_t NumTasks, Fn &&F) {
+    if (NumTasks <= 1 || Workers.empty()) {
+      for (size_t I = 0; I < NumTasks; ++I)
+        F(I);
+      return;
+    }
+    run(NumTasks, std::function<void(size_t)>(std::ref(F)));
+  }
+
+  /// The process-wide pool with one thread per hardware thread.
+  static ThreadPool &getGlobal();
+
+private:
+  void run(size_t NumTasks, const std::function<void(size_t)> &Task);
+  void workerLoop();
+  void drain();
+
+  std::vector<std::thread> Workers;
+  /// Serializes loops started from different threads.
+  std::mutex RunMutex;
+  std::mutex Mutex;
+  std::condition_variable WorkReady;
+  std::condition_variable WorkDone;
+  const std::function<void(size_t)> *CurrentTask = nullptr;
+  size_t TaskCount = 0;
+  std::atomic<size_t> NextTask{0};
+  /// Workers that have not finished the current loop yet.
+  unsigned Pending = 0;
+  uint64_t Generation = 0;
+  bool Stopping = false;
+};
+
+#endif /* ThreadPool_hpp */
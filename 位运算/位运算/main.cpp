@@ -15,6 +15,7 @@
 #include "BitSet.hpp"
 #include "MBitArray.hpp"
 #include "NBitVector.hpp"
+#include "Benchmark.hpp"
 #include <algorithm>
 #include <cassert>
 #include <climits>
@@ -76,6 +77,29 @@ constexpr auto slice(T&& container)
 }
 
 int main(int argc, const char * argv[]) {
+  if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+    RunBitOpsBenchmark();
+    RunBitExprBenchmark();
+    RunParallelBitOpsBenchmark();
+    RunGCBitsetMarkBenchmark();
+    RunGCBitsetSweepBenchmark();
+    RunBloomFilterBenchmark();
+    RunAtomicBitVectorBenchmark();
+    RunBitMatrixBenchmark();
+    RunEWAHBenchmark();
+    RunChunkedBitVectorBenchmark();
+    RunBitVectorStorageBenchmark();
+    RunBitSimilarityBenchmark();
+    RunEliasFanoBenchmark();
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "parallel") == 0) {
+    RunParallelBitOpsBenchmark(argc > 2 ? unsigned(atoi(argv[2])) : 0);
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "suite") == 0)
+    return RunBenchmarkSuite(argc - 2, argv + 2);
+
 //  bool boolean[8]; // 8个字节
   
   // 最开始没有选课